@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <cstdint>
+
+// .maa archive: 16 kHz mono audio quantized to 16 bits, stored in independently decodable blocks
+// followed by a block index. Codecs: raw PCM16, or fixed linear prediction (order 0-4) with
+// partitioned Rice-coded residuals (lossless w.r.t. the 16-bit samples, FLAC-style).
+//
+//   header  "MAA1" u32 sample_rate, u8 codec, u8 reserved[3], u32 block_samples
+//   block   u32 n_samples, u32 payload_bytes, payload
+//   index   n_blocks x (u64 file_offset, u64 first_sample)
+//   trailer "MAAI" u64 index_offset, u32 n_blocks, "MAAE"
+//
+// A file without a trailer (crash before close) is still readable by scanning the block headers.
+enum class ArchiveCodec : uint8_t { PCM16 = 0, LPC = 1 };
+
+class AudioArchiveWriter {
+public:
+    struct Stats { uint64_t samples = 0, bytes = 0, blocks = 0, dropped = 0; };
+
+    AudioArchiveWriter() = default;
+    ~AudioArchiveWriter();
+    bool open(const std::string& path, ArchiveCodec codec = ArchiveCodec::LPC);
+    // Real-time safe: copies into a lock-free ring buffer, never blocks or allocates. Samples that do
+    // not fit (encoder thread stalled for longer than the ring) are dropped and counted.
+    void push(const float* samples, size_t n);
+    void close();
+    Stats stats() const { return {encoded.load(), bytesWritten.load(), blocksWritten.load(), dropped.load()}; }
+    bool isOpen() const { return running; }
+private:
+    void encodeLoop();
+    void drain(std::vector<int16_t>& block, bool final);
+    void writeBlock(const int16_t* s, size_t n);
+
+    std::ofstream file; ArchiveCodec codec = ArchiveCodec::LPC;
+    std::vector<float> ring; std::atomic<size_t> head{0}, tail{0};
+    std::vector<std::pair<uint64_t, uint64_t>> index;
+    std::atomic<uint64_t> encoded{0}, bytesWritten{0}, blocksWritten{0}, dropped{0};
+    std::atomic<bool> running{false}; std::thread encoder;
+};
+
+class AudioArchiveReader {
+public:
+    bool open(const std::string& path);
+    uint64_t totalSamples() const { return total; }
+    int sampleRate() const { return rate; }
+    // Decodes [start, start + count) using the block index to seek to the first needed block.
+    bool read(uint64_t start, uint64_t count, std::vector<float>& out);
+    // Decodes everything, spreading blocks across threads.
+    bool readAll(std::vector<float>& out);
+private:
+    struct Block { uint64_t offset, first; uint32_t n; };
+    bool decodeBlock(std::ifstream& f, const Block& b, float* out);
+
+    std::string path; std::vector<Block> blocks; uint64_t total = 0; int rate = 0; ArchiveCodec codec = ArchiveCodec::LPC;
+};
+
+bool is_audio_archive(const std::string& path);
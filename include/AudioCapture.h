@@ -1,20 +1,30 @@
 #pragma once
-#include <vector>
-#include <string>
-#include <portaudio.h>
-#include <mutex>
-#include <condition_variable>
-const int SAMPLE_RATE = 16000;
-const int FRAMES_PER_BUFFER = 512;
-const int NUM_CHANNELS = 1;
-class AudioCapture {
+#include "AudioSource.h"
+#include <thread>
+
+// PortAudio input device: the default one, or the first input whose name contains `device` (case-insensitive)
+// or whose index it is, e.g. a loopback/monitor device carrying the remote side of a call. Devices that cannot
+// record 16 kHz mono are opened at their native rate (and in stereo if need be) and converted.
+// The PortAudio callback neither allocates nor locks: it converts straight into a lock-free ring sized when
+// the stream opens, and a forwarding thread push()es from there every few milliseconds.
+// Only built when PortAudio is available (HAVE_PORTAUDIO).
+class AudioCapture : public AudioSource {
 public:
-    AudioCapture();
-    ~AudioCapture();
-    bool startCapture();
-    bool stopCapture();
-    bool getAudioChunk(std::vector<float>& chunk, int max_samples);
+    explicit AudioCapture(const std::string& device = "");
+    ~AudioCapture() override;
+    bool startCapture() override;
+    bool stopCapture() override;
+    std::string describe() const override { return deviceName.empty() ? "default microphone" : "'" + deviceName + "'"; }
+
+    static void listDevices();
 private:
-    PaStream* stream; std::vector<float> audioBuffer; std::mutex audioMutex; std::condition_variable audioCv; bool capturing;
-    static int paCallback(const void* inputBuffer, void* outputBuffer, unsigned long framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags, void* userData);
+    std::string request, deviceName;
+    void* stream = nullptr; // PaStream
+    size_t capture(const float* in, size_t frames); // callback side: converts into the ring, returns samples lost
+    void forwardLoop();
+
+    int rate = SAMPLE_RATE, channels = 1; double pos = 0; float prev = 0; bool primed = false; // conversion state
+    std::vector<float> ring; std::atomic<size_t> head{0}, tail{0}, overrun{0};
+    std::thread forwarder; std::atomic<bool> forwarding{false};
+    friend struct AudioCaptureCallback;
 };
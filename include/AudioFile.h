@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Decodes a RIFF/WAVE buffer (16-bit PCM or 32-bit float, any channel count/rate) into 16 kHz mono float samples.
+bool decode_wav(const char* data, size_t size, std::vector<float>& out);
+// Loads a WAV file or a .maa archive written by AudioArchiveWriter.
+bool load_audio_file(const std::string& path, std::vector<float>& out);
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+class AudioArchiveWriter;
+const int SAMPLE_RATE = 16000;
+const int FRAMES_PER_BUFFER = 512;
+const int NUM_CHANNELS = 1;
+
+// Live input for the transcription loop. Backends produce 16 kHz mono float samples on their own thread
+// (an audio callback or a reader) and push() them; the loop takes them with getAudioChunk().
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+    virtual bool startCapture() = 0;
+    virtual bool stopCapture() = 0;
+    // True once the input has ended for good (e.g. EOF on stdin); devices and servers never finish.
+    virtual bool finished() { return false; }
+    virtual std::string describe() const = 0;
+    // Multi-source inputs (MultiSource): one label per source, and which source dominated samples [from, to)
+    // of the stream read through getAudioChunk(), counted from the start of capture; -1 when unknown.
+    virtual std::vector<std::string> sourceLabels() const { return {}; }
+    virtual int dominantSource(size_t from, size_t to) const { return -1; }
+
+    // Waits up to 100 ms for max_samples (or the end of capture); false when nothing was taken.
+    bool getAudioChunk(std::vector<float>& chunk, int max_samples);
+    size_t pendingSamples();
+    // Bounds the samples waiting for getAudioChunk(); beyond it the oldest are dropped (0 = unbounded).
+    void setMaxPending(size_t samples) { std::lock_guard<std::mutex> lock(audioMutex); maxPending = samples; }
+    size_t droppedSamples() { std::lock_guard<std::mutex> lock(audioMutex); return dropped; }
+    // Optional tap fed as samples arrive; the writer must be real-time safe.
+    void setArchive(AudioArchiveWriter* writer) { archive = writer; }
+protected:
+    void push(const float* samples, size_t n);
+    void setCapturing(bool on);
+    std::vector<float> audioBuffer; std::mutex audioMutex; std::condition_variable audioCv; bool capturing = false;
+    size_t maxPending = 0, dropped = 0;
+    std::atomic<AudioArchiveWriter*> archive{nullptr};
+};
+
+// "" or "mic": the default PortAudio input; "mic:<name or index>" another input device. Otherwise a PCM stream:
+// "-" (stdin), "fifo:<path>" or "unix:<path>", optionally followed by ",fmt=s16le|f32le,rate=<hz>,ch=<n>"
+// for raw input (WAV headers are detected). Several inputs joined with '+', each optionally prefixed with
+// "<label>=", are captured together by a MultiSource (labels default to local, remote, source3, ...).
+// "replay:<file>[,speed=<factor>|max]" feeds a recording through the live path (ReplaySource).
+// Returns nullptr, after printing why, when the input cannot be used.
+std::unique_ptr<AudioSource> create_audio_source(const std::string& spec);
+void list_audio_devices();
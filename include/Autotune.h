@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "Config.h"
+
+// performance: Apple Silicon P-cores (0 when the machine has no hybrid layout or it is unknown).
+struct HardwareInfo { int logical = 1, physical = 1, performance = 0; };
+HardwareInfo detect_hardware();
+
+// Calibrated config.n_threads if set, otherwise one thread per physical (performance) core, capped at 8
+// because whisper's encoder stops scaling around there.
+int default_threads(const Config::Data& config);
+
+// Adapts live inference threads to the measured real-time factor (processing time / audio time) and the
+// capture backlog: it scales up quickly when transcription falls behind and back down slowly once there
+// is headroom, so it does not hog cores that other work (and battery) need.
+class ThreadTuner {
+public:
+    ThreadTuner(int initial, int maxThreads, double seedRtf = 0);
+    int threads() const { return n; }
+    double rtf() const { return ewma; }
+    bool saturated() const { return n >= maxThreads && ewma > HIGH_RTF; }
+    void record(double audio_sec, double proc_sec, double backlog_sec);
+private:
+    static constexpr double HIGH_RTF = 0.8, LOW_RTF = 0.25, MAX_BACKLOG_SEC = 3.0;
+    int n, minThreads, maxThreads, settle = 0; double ewma;
+};
+
+struct CalibrationResult { std::string model; size_t model_bytes; int threads; double rtf; };
+
+// Benchmarks each model over a sweep of thread counts on `audio` and returns the best setting per model.
+std::vector<CalibrationResult> calibrate(const std::vector<std::string>& models, const std::vector<float>& audio, int maxThreads);
+// Quantized siblings of a model in the same directory (ggml-small.en.bin -> ggml-small.en-q5_1.bin, ...), itself included.
+std::vector<std::string> find_model_variants(const std::string& modelPath);
+// Largest model that still leaves live headroom (RTF <= LIVE_RTF_TARGET), otherwise the fastest one.
+const CalibrationResult* pick_calibration(const std::vector<CalibrationResult>& results);
+const double LIVE_RTF_TARGET = 0.5;
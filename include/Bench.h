@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Accuracy and speed regression harness ("meeting_assistant bench <corpus>"). Every recording in the corpus
+// directory (*.wav or *.maa) with a reference transcript next to it (same stem, .txt) is run through the
+// file path (silence elision + one decode) and a simulated live path (100 ms chunks through WindowCutter
+// with the prompt carried between windows, as fast as the CPU allows). It reports WER/CER, real-time factor,
+// peak RSS and, for live, emission latency, writes the results as JSON and compares them with a baseline.
+// Runs offline and on the CPU only.
+int run_bench(int argc, char** argv);
+
+// Lowercased words with punctuation and bracketed annotations ("[BLANK_AUDIO]", "(laughs)") removed.
+std::vector<std::string> normalize_words(const std::string& text);
+// Levenshtein distance (substitutions + insertions + deletions).
+size_t word_errors(const std::vector<std::string>& ref, const std::vector<std::string>& hyp);
+size_t char_errors(const std::string& ref, const std::string& hyp); // over UTF-8 code points
+size_t code_point_count(const std::string& s);
@@ -9,6 +9,7 @@ public:
         std::string provider;
         std::string api_key;
         std::string llm_model;
+        std::string llm_base_url;    // API root replacing the provider default (gateway, proxy, mock-server); "" = default
         std::string output_dir = "output";
         std::string mode = "standard";
         std::string obsidian_vault_path;
@@ -18,8 +19,38 @@ public:
         std::string github_repo;
         std::string gitlab_token;
         std::string gitlab_repo;
+        std::string github_api_url = "https://api.github.com"; // GitHub Enterprise: https://<host>/api/v3
+        std::string gitlab_url = "https://gitlab.com";          // self-managed GitLab instance
         float vad_threshold = 0.01f;
         int vad_silence_ms = 1000;
+        bool journal = true;
+        int journal_flush_ms = 1000;
+        bool archive_audio = false;
+        std::string archive_codec = "lpc";
+        std::string diarize = "auto"; // "auto" (only with tinydiarize models), "on", "off"
+        int n_threads = 0;            // 0: derive from the hardware; written by 'calibrate'
+        float calibrated_rtf = 0.0f;
+        std::string vocabulary;       // custom terms primed into every live window
+        int prompt_tokens = 64;       // token budget for vocabulary + carried-over context
+        int prompt_reset_ms = 15000;  // drop carried-over context after this much silence
+        std::string report_mode = "single"; // "single" (one completion) or "parallel" (one per section group)
+        int llm_concurrency = 3;
+        std::string export_formats = "md,html,email"; // any of md, html, email, json
+        std::string decoding = "greedy"; // "greedy", "adaptive" (beam re-decode of low-confidence segments), "beam"
+        float min_confidence = 0.4f;
+        std::string refine_model;    // live cascade: larger model that re-transcribes finalized windows ("" = off)
+        int refine_queue_sec = 600;  // cascade: audio waiting for the second pass; older windows beyond it stay unrefined
+        bool elide_silence = true;   // skip non-speech stretches of recorded files before decoding
+        std::string cpu_profile = "auto"; // live inference: "auto", "background" or "realtime"
+        float cpu_share = 0.5f;      // share of cores inference may use in the background profile
+        bool pin_audio_core = false;
+        std::string audio_mix = "mix"; // several inputs: "mix" or "channels" (segments labelled by input)
+        std::string audio_input;     // live input: "" / "mic", "-", "fifo:<path>" or "unix:<path>" (+ ",fmt=..,rate=..,ch=..")
+        std::string watch_dir;       // ingest recordings dropped here (--watch)
+        int watch_settle_ms = 5000;  // a file is queued once its size and mtime have been stable this long
+        std::string serve_path_root; // --serve: JSON "path" jobs must lie under this directory ("" = loopback/unix listeners only)
+        std::string stream;          // NDJSON segment events: "-", "fifo:<path>" or "unix:<path>"; empty: off
+        int memory_budget_mb = 0;    // peak memory to plan for (models, decoder states, audio queues); 0 = unlimited
     };
 
     static Data load();
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "Transcriber.h"
+#include "Config.h"
+
+// Assigns stable speaker IDs to segments without a second model pass. Turn boundaries come from
+// tinydiarize ([SPEAKER_TURN] tokens, TranscriptionSegment::speaker_turn); each turn is described by a
+// cheap voice profile computed from the same PCM window (log-mel band shape + median pitch) and
+// matched against running per-speaker centroids. State persists across calls so IDs stay stable
+// over a whole live session.
+//
+// With models that do not emit turns, every segment boundary is a candidate and a stricter distance
+// threshold is used instead.
+class Diarizer {
+public:
+    explicit Diarizer(bool modelEmitsTurns, int maxSpeakers = 8);
+
+    // pcm is the buffer the segments were transcribed from (segment times in 10 ms units, relative to it).
+    void assign(std::vector<TranscriptionSegment>& segments, const std::vector<float>& pcm);
+    int speakerCount() const { return (int)centroids.size(); }
+
+    static bool modelSupportsTurns(const std::string& modelPath);
+    static bool enabledFor(const Config::Data& config);
+private:
+    static const int N_BANDS = 12;
+    struct Profile { std::vector<float> v; float weight = 0; };
+    Profile profile(const float* pcm, size_t n) const;
+    static float distance(const std::vector<float>& a, const std::vector<float>& b);
+
+    bool emitsTurns; int maxSpeakers;
+    std::vector<Profile> centroids;
+    int current = -1; bool pendingTurn = true;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "Config.h"
+
+// Parsed analysis of one meeting, shared read-only by all writers.
+struct MeetingReport {
+    std::string title, date, persona, baseName, transcription, research;
+    std::string outputDir, fileBase; // outputs are <outputDir>/<fileBase><suffix>
+    std::map<std::string, std::string> sections; // REPORT_SECTIONS name -> content
+    const std::string& get(const std::string& name) const;
+    std::string path(const std::string& suffix) const;
+};
+
+// One export format. Writers run concurrently on the same report, so write() must not mutate shared state.
+class ReportWriter {
+public:
+    virtual ~ReportWriter() = default;
+    virtual const char* name() const = 0;
+    virtual bool write(const MeetingReport& report) = 0;
+};
+
+class MarkdownWriter : public ReportWriter { public: const char* name() const override { return "md"; } bool write(const MeetingReport& r) override; };
+class HtmlWriter : public ReportWriter { public: const char* name() const override { return "html"; } bool write(const MeetingReport& r) override; };
+class EmailWriter : public ReportWriter { public: const char* name() const override { return "email"; } bool write(const MeetingReport& r) override; };
+class JsonWriter : public ReportWriter { public: const char* name() const override { return "json"; } bool write(const MeetingReport& r) override; };
+// Creates GitHub/GitLab issues for the action items.
+class IssueSyncWriter : public ReportWriter {
+public:
+    explicit IssueSyncWriter(const Config::Data& config) : config(config) {}
+    const char* name() const override { return "issues"; }
+    bool write(const MeetingReport& r) override;
+private:
+    Config::Data config;
+};
+
+struct ExportTiming { std::string writer; double ms; bool ok; };
+
+// Writers for config.export_formats ("md,html,email,json"), plus issue sync when a tracker is configured.
+std::vector<std::unique_ptr<ReportWriter>> create_writers(const Config::Data& config);
+// Runs every writer on its own thread and returns per-writer wall time.
+std::vector<ExportTiming> run_exports(const MeetingReport& report, const std::vector<std::unique_ptr<ReportWriter>>& writers);
+// Writes to a temp file in the same directory, fsyncs it and renames it over path, so readers (and an
+// Obsidian vault) never see a half-written file.
+bool write_file_atomic(const std::string& path, const std::string& data);
@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+#include "Config.h"
+
+// Keeps live inference from starving whatever else runs on the machine (typically the call client).
+// Each window is decoded on a short-lived thread whose scheduling is set for the current profile before
+// whisper spawns its workers, which inherit it:
+//   background: thread count capped at cpu_share of the cores (halved on battery), SCHED_IDLE on Linux,
+//               utility/background QoS on macOS, optionally kept off the core the audio callback is pinned to;
+//   realtime:   normal priority and the tuner's full thread count.
+// In "auto" the governor stays in background while transcription keeps up and switches to realtime when the
+// capture backlog grows, then drops back once it has caught up. The capture loop and the PortAudio callback
+// threads get elevated priority where the OS allows it without privileges.
+class ResourceGovernor {
+public:
+    enum class Profile { Realtime, Background };
+    struct ProfileStats { int windows = 0; double audio_sec = 0, proc_sec = 0; };
+    struct Jitter { double p50_ms = 0, p99_ms = 0, max_ms = 0; long samples = 0; };
+
+    // measureJitter starts a probe thread at normal priority that wakes every 5 ms and records how late it
+    // runs, split by whether inference is active: a stand-in for the frame pacing of a call client.
+    ResourceGovernor(const Config::Data& config, int logicalCores, bool measureJitter = false);
+    ~ResourceGovernor();
+
+    Profile profile() const { return current; }
+    const char* profileName() const { return current == Profile::Realtime ? "realtime" : "background"; }
+    bool onBattery() const { return battery; }
+    // Thread count for the next window: the tuner's suggestion, capped by the current profile.
+    int threads(int suggested) const;
+    // Cores the live decode left free at its last threads() call, for lower-priority work beside it.
+    int spareThreads() const { return std::max(1, logical - lastThreads - (audioCore >= 0 ? 1 : 0)); }
+    // Runs fn on a thread scheduled for the current profile (or the given one) and waits for it. The decode's
+    // threads are reserved in the shared Scheduler meanwhile, so pool work below Live uses only the rest.
+    void run(const std::function<void()>& fn, int threads);
+    void run(const std::function<void()>& fn, int threads, Profile p);
+    // Feeds one window's timing and the capture backlog into the profile switch.
+    void record(double audio_sec, double proc_sec, double backlog_sec);
+
+    ProfileStats stats(Profile p) const { return p == Profile::Realtime ? realtimeStats : backgroundStats; }
+    Jitter jitter(bool duringInference) const;
+    std::string summary() const;
+
+    // Called once from the capture loop thread; prepareAudioThread() once from the first PortAudio callback
+    // (which also pins it when pin_audio_core is set).
+    static void elevateCurrentThread();
+    static void prepareAudioThread();
+    static bool detectBattery();
+private:
+    static const int JITTER_BUCKETS = 1000; // 0.1 ms each, last one collects everything above 100 ms
+    void applyProfile(Profile p) const;
+    void probeLoop();
+
+    static std::atomic<int> audioCore; // -1: not pinned
+    std::string mode; double share; bool pinAudio; int logical; bool battery;
+    Profile current; int calmWindows = 0;
+    ProfileStats realtimeStats, backgroundStats;
+    mutable std::atomic<int> lastThreads{0};
+    std::atomic<int> inferring{0}; std::atomic<bool> probing{false}; std::thread probe;
+    mutable std::mutex jitterMutex; std::vector<long> jitterIdle, jitterBusy;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <map>
+#include <mutex>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
@@ -11,6 +12,13 @@ public:
     struct Response { long status_code; std::string body; std::string error; };
     Response post(const std::string& url, const json& payload, const std::map<std::string, std::string>& headers = {});
     Response get(const std::string& url, const std::map<std::string, std::string>& headers = {});
+    // Requests repeated after a 429, process-wide (load testing).
+    static long retryCount();
 private:
+    // Each client keeps one easy handle; all clients share a process-wide connection/DNS/TLS-session cache
+    // so keep-alive connections stay warm across requests and across clients.
+    CURL* acquireHandle();
+    static CURLSH* sharedPool();
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
+    CURL* handle = nullptr; std::mutex handleMutex;
 };
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+
+// Blocking HTTP/1.1 plumbing shared by the job server and the mock API server: one request per read_request(),
+// header names lowercased, query parameters decoded, bodies read in full up to MAX_UPLOAD_BYTES.
+struct HttpRequest {
+    std::string method, path;
+    std::map<std::string, std::string> query, headers;
+    std::vector<char> body;
+};
+
+std::string url_decode(const std::string& s);
+bool send_all(int fd, const std::string& data);
+// keepAlive leaves the connection open for another request instead of announcing "Connection: close".
+bool send_response(int fd, int code, const std::string& body, const std::string& type = "application/json", const std::string& extra = "", bool keepAlive = false);
+bool send_chunk(int fd, const std::string& data); // one chunk of a Transfer-Encoding: chunked body
+// Returns 0 on success, otherwise the HTTP status to reply with.
+int read_request(int fd, HttpRequest& req);
+// Binds and listens on "host:port", "port" or "unix:/path" (unixPath is set for the latter). -1 on failure.
+int listen_socket(const std::string& address, std::string& unixPath);
+
+// Open connections of a server, each served on its own detached thread. admit() gives an accepted socket
+// send/receive timeouts (IO_TIMEOUT_MS of silence fails the read or write) and registers it, or answers 503
+// and closes it once `limit` are open. drain() lets handlers finish for up to grace_ms, then shuts the
+// remaining sockets down so blocked reads and writes return, and waits for their threads to let go.
+class ConnectionSet {
+public:
+    static const int IO_TIMEOUT_MS = 30000;
+    explicit ConnectionSet(size_t limit = 64) : limit(limit) {}
+    bool admit(int fd);
+    void release(int fd); // closes fd
+    void drain(int grace_ms);
+private:
+    size_t limit; std::set<int> fds; std::mutex mutex; std::condition_variable cv;
+};
@@ -13,21 +13,23 @@ public:
 
 class GitHubTracker : public IssueTracker {
 public:
-    GitHubTracker(const std::string& token, const std::string& repo);
+    GitHubTracker(const std::string& token, const std::string& repo, const std::string& apiUrl = "https://api.github.com");
     bool createIssue(const std::string& title, const std::string& body) override;
 private:
     std::string token;
     std::string repo;
+    std::string apiUrl;
     HttpClient httpClient;
 };
 
 class GitLabTracker : public IssueTracker {
 public:
-    GitLabTracker(const std::string& token, const std::string& repo);
+    GitLabTracker(const std::string& token, const std::string& repo, const std::string& baseUrl = "https://gitlab.com");
     bool createIssue(const std::string& title, const std::string& body) override;
 private:
     std::string token;
     std::string repo;
+    std::string baseUrl;
     HttpClient httpClient;
 };
 
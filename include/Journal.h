@@ -0,0 +1,41 @@
+#pragma once
+#include <memory>
+#include "TranscriptStore.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+// Append-only NDJSON journal of finalized live segments. append() only formats the record into an
+// in-memory batch; a background thread writes and fsyncs batches every flush interval (or sooner once
+// a batch fills up), so a crash loses at most one interval of transcript.
+class TranscriptJournal {
+public:
+    struct Stats { uint64_t records = 0, bytes = 0, fsyncs = 0; double append_avg_us = 0, append_max_us = 0, fsync_avg_ms = 0, fsync_max_ms = 0; };
+    struct Session { std::string path, baseName; std::shared_ptr<TranscriptStore> transcript; int64_t last_ms = 0; size_t segments = 0; bool completed = false; };
+
+    TranscriptJournal() = default;
+    ~TranscriptJournal();
+
+    bool open(const std::string& path, const std::string& baseName, int flushMs = 1000);
+    void append(const std::string& timestamp, const std::string& text, int64_t t0_ms, int64_t t1_ms, int speaker = -1);
+    // Flushes outstanding records; marks the session complete so --resume skips it.
+    void close(bool completed);
+    Stats stats();
+    bool isOpen() const { return fd >= 0; }
+
+    static std::string journalDir();
+    static bool load(const std::string& path, Session& session);
+    static std::string findLatestUnfinished();
+    static bool markCompleted(const std::string& path);
+private:
+    void flushLoop();
+    void writeBatch(std::string& batch);
+
+    int fd = -1; int flushMs = 1000; bool stopping = false;
+    std::string pending; size_t pendingRecords = 0;
+    Stats st; double appendTotalUs = 0, fsyncTotalMs = 0;
+    std::mutex mutex; std::condition_variable cv; std::thread flusher;
+};
@@ -4,44 +4,70 @@
 #include <memory>
 #include "HttpClient.h"
 
+// Token accounting for the last call. cached_tokens is what the provider served from its prompt cache
+// (OpenAI cached_tokens, Gemini cachedContentTokenCount); Ollama reports only the tokens it actually had to
+// evaluate, so there cached_tokens is -1 and a warm KV cache shows up as a small prompt_tokens.
+struct LLMUsage { int prompt_tokens = 0, cached_tokens = -1, output_tokens = 0; double ms = 0; };
+std::string format_usage(const LLMUsage& usage);
+
 class LLMClient {
 public:
     virtual ~LLMClient() = default;
     virtual std::string generateSummary(const std::string& transcription) = 0;
+    // prefix must be byte-identical across calls (instructions, persona); input is the per-call part. Keeping
+    // them apart lets providers reuse the cached prefix (system message / system instruction placed first).
+    virtual std::string generate(const std::string& prefix, const std::string& input) { return generateSummary(prefix + input); }
     virtual std::string researchTopics(const std::string& transcription) { return ""; }
+    LLMUsage lastUsage() const { return usage; }
+protected:
+    LLMUsage usage;
 };
 
 class OllamaClient : public LLMClient {
 public:
     OllamaClient(const std::string& model, const std::string& baseUrl = "http://localhost:11434");
     std::string generateSummary(const std::string& transcription) override;
+    std::string generate(const std::string& prefix, const std::string& input) override;
 private:
+    std::string chat(const std::string& system, const std::string& user);
     std::string model; std::string baseUrl; HttpClient httpClient;
 };
 
 class GeminiClient : public LLMClient {
 public:
-    GeminiClient(const std::string& apiKey, const std::string& model = "gemini-2.0-flash");
+    GeminiClient(const std::string& apiKey, const std::string& model = "gemini-2.0-flash", const std::string& baseUrl = "https://generativelanguage.googleapis.com/v1beta");
     std::string generateSummary(const std::string& transcription) override;
+    std::string generate(const std::string& prefix, const std::string& input) override;
     std::string researchTopics(const std::string& transcription) override;
 private:
-    std::string apiKey; std::string model; HttpClient httpClient;
+    std::string call(const json& payload);
+    std::string apiKey; std::string model; std::string baseUrl; HttpClient httpClient;
 };
 
 class OpenAIClient : public LLMClient {
 public:
-    OpenAIClient(const std::string& apiKey, const std::string& model = "gpt-3.5-turbo");
+    OpenAIClient(const std::string& apiKey, const std::string& model = "gpt-3.5-turbo", const std::string& baseUrl = "https://api.openai.com/v1");
     std::string generateSummary(const std::string& transcription) override;
+    std::string generate(const std::string& prefix, const std::string& input) override;
     std::string researchTopics(const std::string& transcription) override;
 private:
-    std::string apiKey; std::string model; HttpClient httpClient;
+    std::string chat(const std::string& system, const std::string& user);
+    std::string apiKey; std::string model; std::string baseUrl; HttpClient httpClient;
 };
 
 class ClientFactory {
 public:
-    static std::unique_ptr<LLMClient> createClient(const std::string& provider, const std::string& apiKeyOrUrl, const std::string& model);
+    // baseUrl replaces the provider's API root (an OpenAI-compatible gateway, a proxy, the mock server); empty: default.
+    static std::unique_ptr<LLMClient> createClient(const std::string& provider, const std::string& apiKeyOrUrl, const std::string& model, const std::string& baseUrl = "");
 };
 
 extern const std::string SUMMARY_PROMPT;
 extern const std::string TITLE_PROMPT;
-std::string get_obsidian_prompt(const std::string& persona);
+extern const std::string COPILOT_PROMPT;
+
+// One ---NAME--- block of the structured analysis reply, with the instruction describing its content.
+struct ReportSection { const char* name; const char* spec; };
+extern const std::vector<ReportSection> REPORT_SECTIONS;
+// Stable analysis prefix: the fixed output format comes first so it caches across personas.
+// The transcript goes in the input part of generate(). sections limits the format to a subset (all if empty).
+std::string get_obsidian_prompt(const std::string& persona, bool speakerLabels = false, const std::vector<std::string>& sections = {});
@@ -0,0 +1,7 @@
+#pragma once
+
+// Client-side load generator ("meeting_assistant loadgen"): drives the real LLM clients or issue trackers,
+// one instance per concurrent worker, against a server root (the mock server by default) and reports
+// throughput, latency percentiles and 429 retries. Against the mock server it also reads /mock/stats and
+// subtracts the scripted server time, which leaves our own per-request overhead.
+int run_loadgen(int argc, char** argv);
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include "Config.h"
+
+// Memory footprint of one whisper model, estimated before it is loaded. Weights cost their file size (whisper
+// copies every tensor into its own buffer). Each whisper_state adds the self- and cross-attention KV caches,
+// sized from the hyperparameters in the file header (the self cache once per beam decoder), plus compute
+// buffers taken from whisper.cpp's reported sizes for each model width.
+struct ModelFootprint { size_t weight_bytes = 0, state_bytes = 0; bool known = false; };
+ModelFootprint estimate_model(const std::string& path, const Config::Data& config);
+
+// Planned peak memory for a session and the pool sizes and queue bounds chosen to keep under
+// config.memory_budget_mb. Without a budget the plan is still made (for the report) but bounds nothing.
+struct MemoryPlan {
+    size_t budget = 0;                  // bytes, 0 = none
+    size_t weights = 0, per_state = 0;  // all models' weights; one state of each model
+    int states = 1;                     // concurrent decodes: server workers, 1 for a live or file session
+    size_t audio_queue_samples = 0;     // live capture backlog bound (oldest audio dropped beyond), 0 = unbounded
+    size_t refine_queue_samples = 0;    // live cascade: windows waiting for the second pass (config.refine_queue_sec)
+    size_t job_audio = 0;               // server: decoded audio held by one running job (recording + speech copy)
+    size_t upload_bytes = 0;            // server: queued uploads bound, 0 = unbounded
+    size_t base = 0;                    // runtime, libraries, transcript and reports
+
+    size_t planned() const;
+    std::string describe() const;
+};
+
+// Live (-l) or file (-f) session: the model plus, for live, the refine model and the capture queue.
+// Returns false, after printing why, when even the smallest setup exceeds the budget.
+bool plan_session(const Config::Data& config, bool live, MemoryPlan& plan);
+// --serve / --watch: as many of the requested workers as fit, then the upload bound from what is left.
+bool plan_server(const Config::Data& config, int workers, MemoryPlan& plan);
+
+size_t current_rss();  // resident set size in bytes, 0 when unknown
+size_t peak_rss();
+// "Memory: peak RSS .. vs planned .. (budget ..)" for the end-of-session summary; "" without a budget.
+std::string memory_report(const MemoryPlan& plan);
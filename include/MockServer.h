@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <atomic>
+#include "HttpServer.h"
+
+struct HttpRequest;
+
+// Local stand-in for the LLM and issue-tracker APIs ("meeting_assistant mock-server"), so our own overhead,
+// retries and concurrency can be measured offline. Routes match on the path suffix, so any llm_base_url /
+// github_api_url / gitlab_url prefix pointing here works:
+//   POST .../api/chat                              Ollama (NDJSON stream with "stream": true)
+//   POST .../chat/completions                      OpenAI (SSE with "stream": true)
+//   POST .../models/{m}:generateContent            Gemini (:streamGenerateContent streams, SSE with alt=sse)
+//   POST .../repos/{owner}/{repo}/issues           GitHub
+//   POST .../api/v4/projects/{id}/issues           GitLab
+//   GET  /mock/stats                               requests, injected 429s, server-side time
+// A completion waits latency_ms (+ up to jitter_ms) for its first chunk and chunk_ms for each further one,
+// streamed or not, so a plain call costs what reading the whole stream would. The reply echoes the
+// ---SECTION--- blocks the prompt asks for with canned content, unless response_file replaces it.
+class MockServer {
+public:
+    struct Options {
+        int latency_ms = 200, jitter_ms = 0;
+        int chunk_ms = 20, chunks = 16;
+        int issue_ms = 50;          // tracker calls
+        double rate_limit = 0;      // share of requests answered 429
+        int retry_after = 1;        // Retry-After seconds sent with them (0: no header)
+        std::string response_file;  // fixed completion text
+        unsigned seed = 1;
+    };
+    explicit MockServer(const Options& opt);
+    ~MockServer();
+    bool listen(const std::string& address);
+    void start();
+    void stop();
+    std::string summary() const;
+private:
+    struct Counters { long requests = 0, rate_limited = 0, streamed = 0; double served_ms = 0; long served = 0; };
+
+    void acceptLoop();
+    void handleConnection(int fd);
+    // False when the connection must be closed after this request.
+    bool handleRequest(int fd, const HttpRequest& req);
+    std::string completion(const std::string& prompt) const;
+    int firstChunkDelayMs();
+    bool injectRateLimit();
+    void record(const std::string& api, bool limited, bool streamed, double ms);
+
+    Options opt; std::string fixedReply;
+    mutable std::mutex mutex; std::mt19937 rng; std::map<std::string, Counters> counters; long nextIssue = 1;
+    std::atomic<int> inFlight{0}, maxInFlight{0}; ConnectionSet connections;
+    std::thread acceptor; std::atomic<bool> running{false};
+    int listenFd = -1; std::string unixPath;
+};
+
+int run_mock_server(int argc, char** argv);
@@ -0,0 +1,51 @@
+#pragma once
+#include "AudioSource.h"
+#include <thread>
+#include <deque>
+#include <chrono>
+
+// Several live inputs recorded together, e.g. the local mic plus a loopback/monitor device that carries the
+// remote side of a call. A mixer thread paces the output on the host clock. Each source is played out of
+// its own FIFO through a resampler whose ratio a PI controller trims to hold that FIFO at TARGET_MS. This
+// absorbs the drift between independent device clocks and keeps all sources at the same delay, so they line
+// up to within a few milliseconds. A source that stalls is padded with silence and re-primed, and one that
+// runs far ahead (e.g. after a system sleep) is trimmed back.
+//
+// Each source has its own VAD with an adaptive noise floor. Inactive sources are ducked in the mix so their
+// noise does not add up. Per-source levels are kept for every 10 ms of output for the last HISTORY_SEC,
+// so dominantSource() can say whose channel a transcribed segment came from without any extra inference.
+class MultiSource : public AudioSource {
+public:
+    struct Input { std::string label; std::unique_ptr<AudioSource> source; };
+    struct SourceStats { std::string label; double drift_ppm = 0; long underruns = 0, overruns = 0; double active_sec = 0; };
+
+    explicit MultiSource(std::vector<Input> inputs);
+    ~MultiSource() override;
+    bool startCapture() override;
+    bool stopCapture() override;
+    bool finished() override { return ended; }
+    std::string describe() const override;
+    std::vector<std::string> sourceLabels() const override;
+    int dominantSource(size_t from, size_t to) const override;
+
+    std::vector<SourceStats> stats() const;
+private:
+    static constexpr int TARGET_MS = 120, TICK_MS = 10, FRAME = SAMPLE_RATE / 100, HISTORY_SEC = 600;
+    static constexpr double MAX_CORRECTION = 0.005; // 5000 ppm, far beyond any real clock drift
+    struct Channel {
+        Input in; std::vector<float> fifo; double pos = 0, ratio = 1, integral = 0, level = 0; bool primed = false, done = false;
+        float floor = 0.001f, gain = 1; int hangover = 0; float frameSq = 0; int frameFill = 0;
+        long underruns = 0, overruns = 0;
+        SourceStats stats; // copied out under levelMutex
+    };
+
+    void loop();
+    void render(Channel& c, float* out, size_t n);
+    void trackLevels(Channel& c, size_t idx, const float* s, size_t n);
+
+    std::vector<Channel> channels;
+    std::thread mixer; std::atomic<bool> running{false}, ended{false};
+    size_t emitted = 0;
+    // levels[i] holds one RMS value per 10 ms frame of output for source i, starting at frame levelBase.
+    mutable std::mutex levelMutex; std::vector<std::deque<float>> levels; size_t levelBase = 0;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include "AudioSource.h"
+#include <thread>
+#include <cstdint>
+
+// Incremental decoder for a byte stream of PCM audio: parses an optional WAV header, converts s16le/f32le
+// frames of any channel count to mono and resamples to SAMPLE_RATE (linear, continuous across feeds).
+class PcmDecoder {
+public:
+    enum class Encoding { S16LE, F32LE };
+    struct Format { Encoding enc = Encoding::S16LE; int rate = SAMPLE_RATE; int channels = 1; };
+    explicit PcmDecoder(Format raw) : fmt(raw) {}
+    void feed(const char* data, size_t n, std::vector<float>& out);
+    const Format& format() const { return fmt; }
+private:
+    bool parseHeader(); // consumes a complete WAV header from carry; false while more bytes are needed
+    Format fmt; std::string carry; bool headerChecked = false;
+    double pos = 0; float prev = 0; bool primed = false;
+};
+
+// Headless live input from stdin, a named pipe or a Unix socket, for audio bridged in from SIP or recording
+// infrastructure. A FIFO stays open across writers; a socket accepts any number of concurrent clients, each
+// with its own format and decoder, and their streams are mixed into the one live pipeline.
+class PcmStreamSource : public AudioSource {
+public:
+    PcmStreamSource(const std::string& target, PcmDecoder::Format raw);
+    ~PcmStreamSource() override;
+    bool startCapture() override;
+    bool stopCapture() override;
+    bool finished() override { return ended; }
+    std::string describe() const override { return target; }
+private:
+    struct Stream { int fd; PcmDecoder dec; std::vector<float> pending; };
+    void readerLoop();
+    void mix(bool flushAll);
+
+    std::string target, path; PcmDecoder::Format raw;
+    int fd = -1, listenFd = -1, keepaliveFd = -1, wakePipe[2] = {-1, -1}, stdinFlags = -1; // stdinFlags: as found, restored on stop
+    std::vector<Stream> streams;
+    std::thread reader; std::atomic<bool> running{false}, ended{false};
+};
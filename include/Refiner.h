@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include "Config.h"
+#include "Transcriber.h"
+#include "TranscriptStore.h"
+#include "Governor.h"
+
+// Second pass of the two-pass cascade (config.refine_model). The live model captions each window as usual.
+// Each finalized window is then queued here, re-transcribed in order by the larger model and swapped into
+// the transcript in place of the live segments. Speaker labels carry over from the live segments they
+// overlap most.
+//
+// Windows are decoded one at a time as tasks on the scheduler's Refine lane. While recording they run at
+// background priority on the cores the live decode leaves free (ResourceGovernor::spareThreads), and no
+// task is posted while the governor is in its realtime profile, i.e. while live captions are falling
+// behind; the next submit() after it drops back resumes. finish() then decodes whatever is left with all
+// cores, so the report waits only on that backlog. The queue holds at most config.refine_queue_sec of audio;
+// beyond it the oldest windows are dropped and keep their live text.
+class Refiner {
+public:
+    using RevisedCallback = std::function<void(int64_t from_ms, int64_t to_ms, const std::vector<TranscriptionSegment>& segments)>;
+    struct Stats { int windows = 0, changed = 0, pending = 0, dropped = 0; double audio_sec = 0, proc_sec = 0, drain_sec = 0, dropped_sec = 0; };
+
+    Refiner(Transcriber& model, const Config::Data& config, std::shared_ptr<TranscriptStore> transcript, ResourceGovernor& governor,
+            RevisedCallback onRevised = nullptr);
+    ~Refiner();  // drops whatever is still queued, waits for the window in progress
+
+    void submit(const std::vector<float>& pcm, int64_t off_ms);
+    void finish();
+    Stats stats();
+private:
+    struct Window { std::vector<float> pcm; int64_t off_ms; };
+
+    void kick();  // with mutex held
+    void step();
+    void refine(const Window& w, bool draining);
+
+    Transcriber& model; const Config::Data& config;
+    std::shared_ptr<TranscriptStore> transcript; ResourceGovernor& governor; RevisedCallback onRevised;
+    Transcriber::PromptState prompt; bool vocabTokenized = false; int64_t lastSpeechMs = 0;
+    std::deque<Window> queue; size_t queuedSamples = 0, maxQueuedSamples; std::mutex mutex; std::condition_variable cv;
+    bool draining = false, stopping = false, active = false; Stats counters;
+};
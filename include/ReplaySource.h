@@ -0,0 +1,41 @@
+#pragma once
+#include "AudioSource.h"
+#include <thread>
+#include <chrono>
+#include <mutex>
+
+// Feeds a recording (WAV or .maa) into the live pipeline as if it were being captured, for profiling and
+// regression-testing live mode without an audio device. speed 1 is real time and N is N times faster.
+// speed 0 ("max") hands over the next 100 ms as soon as the previous one has been taken, so the capture
+// loop never waits and never builds a backlog.
+//
+// Latency is measured on a virtual capture clock: seconds of the recording that have "happened" when a
+// segment is emitted. At a fixed speed it advances with wall time. At max speed it is the capture loop's own
+// position in the recording, so latencies are the windowing delay alone and identical on every machine.
+class ReplaySource : public AudioSource {
+public:
+    ReplaySource(const std::string& path, double speed) : path(path), speed(speed) {}
+    ~ReplaySource() override { stopCapture(); }
+    bool startCapture() override;
+    bool stopCapture() override;
+    bool finished() override { return ended; }
+    std::string describe() const override;
+
+    double clock() const;
+    double durationSec() const { return pcm.size() / (double)SAMPLE_RATE; }
+    // Fed by the capture loop: each emitted segment's end time in the recording (with the loop's position in it),
+    // and each window's timing.
+    void recordSegment(double end_sec, double consumed_sec);
+    void recordWindow(double audio_sec, double proc_sec, double backlog_sec);
+    std::string summary() const;
+private:
+    void feedLoop();
+
+    mutable std::mutex statsMutex; std::vector<double> latencies; std::vector<double> backlogs;
+    int windows = 0; double audioSec = 0, procSec = 0;
+
+    std::string path; double speed;
+    std::vector<float> pcm; std::atomic<size_t> delivered{0};
+    std::chrono::steady_clock::time_point started;
+    std::thread feeder; std::atomic<bool> running{false}, ended{false};
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <string_view>
+#include "Config.h"
+#include "SearchIndex.h"
+
+void trim(std::string& s);
+std::string format_timestamp(int64_t t_ms);
+// One transcript line: "HH:MM:SS: text", or "HH:MM:SS [Speaker N]: text" once diarized (N is 1-based).
+std::string format_segment_line(int64_t t_ms, int speaker, std::string_view text);
+std::string md_to_html(const std::string& md);
+void sync_action_items(const std::string& acts, const Config::Data& config, const std::string& meeting_title);
+
+// Writes the transcript and, when an LLM provider is configured, the Markdown/HTML/email reports.
+// `segments` is the same transcript for the search index, with millisecond times and 0-based speakers.
+// Returns the path of the main note, or of the transcript if no analysis was produced.
+std::string save_meeting_reports(const std::string& transcription, const std::vector<SearchIndex::Segment>& segments,
+                                 const Config::Data& config, const std::string& baseName);
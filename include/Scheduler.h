@@ -0,0 +1,147 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <exception>
+#include <type_traits>
+
+// Process-wide work-stealing pool, one worker per logical core, for everything that used to get an ad hoc
+// thread or block the capture loop. Work is submitted to a lane; workers always take the highest lane that
+// has work, looking first at their own deque (newest first, for tasks spawned from a task), then at the
+// lane's shared queue, then stealing the oldest task of another worker.
+//   Live     model loading for the live path
+//   Copilot  copilot questions from the dashboard
+//   Refine   cascade re-transcription (Refiner)
+//   Render   report sections, export writers, archive decoding
+//   Sync     issue tracker calls
+// Whisper keeps its own threads. While a live decode runs it holds a Reservation for its thread count, and
+// the lanes below Live get only the cores left over (at least one worker), so nothing oversubscribes them.
+// Blocking I/O loops with timing needs (capture, mixer, journal, stream writer, UI) keep their threads.
+//
+// submit() returns a Future with then() continuations. Waiting on a Future from a worker runs other queued
+// tasks meanwhile, so a task may wait for tasks it spawned. Queue time (submit to start) is kept per lane.
+class Scheduler {
+public:
+    enum class Lane { Live, Copilot, Refine, Render, Sync };
+    static constexpr int LANES = 5;
+    struct LaneStats { long tasks = 0; int queued = 0, running = 0; double queue_ms_mean = 0, queue_ms_p95 = 0, queue_ms_max = 0, run_ms = 0; };
+
+    // Marks cores as busy outside the pool for its lifetime.
+    class Reservation {
+    public:
+        Reservation(Reservation&& o) noexcept : owner(o.owner), cores(o.cores) { o.owner = nullptr; }
+        Reservation(const Reservation&) = delete;
+        ~Reservation();
+    private:
+        friend class Scheduler;
+        Reservation(Scheduler* owner, int cores) : owner(owner), cores(cores) {}
+        Scheduler* owner; int cores;
+    };
+
+    template <typename T> class Future;
+
+    static Scheduler& shared();
+    template <typename F> auto submit(Lane lane, F&& fn) -> Future<std::invoke_result_t<std::decay_t<F>&>>;
+    void post(Lane lane, std::function<void()> fn);
+    Reservation reserve(int cores);
+
+    int workers() const { return (int)pool.size(); }
+    LaneStats stats(Lane lane) const;
+    std::string summary() const; // lanes that ran anything, for the end-of-session report
+    static const char* laneName(Lane lane);
+
+    // Completion state shared by a Future and the task producing it.
+    struct StateBase {
+        std::mutex m; std::condition_variable cv; bool done = false; std::exception_ptr error;
+        std::vector<std::function<void()>> continuations;
+        void finish();
+        void onDone(std::function<void()> fn);
+    };
+    // Waits until s is done, running queued tasks meanwhile when called on a worker.
+    void wait(StateBase& s);
+private:
+    struct Task { std::function<void()> fn; Lane lane; std::chrono::steady_clock::time_point queued; };
+    struct Worker { std::mutex m; std::deque<Task> q[LANES]; };
+    struct Counters { long tasks = 0; int running = 0; double queue_ms = 0, queue_ms_max = 0, run_ms = 0; long hist[32] = {}; };
+
+    explicit Scheduler(int n);
+    void loop(int self);
+    bool take(int self, Task& out, bool inline_);
+    void run(Task& t);
+
+    std::vector<std::unique_ptr<Worker>> pool; std::vector<std::thread> threads;
+    std::mutex globalMutex; std::deque<Task> global[LANES];
+    std::mutex sleepMutex; std::condition_variable wake; uint64_t signal = 0; // bumped on every post and release
+    std::atomic<int> reserved{0}, belowLive{0};
+    mutable std::mutex statsMutex; Counters counters[LANES]; int queuedCount[LANES] = {};
+};
+
+template <typename T>
+class Scheduler::Future {
+public:
+    struct State : StateBase { std::optional<std::conditional_t<std::is_void_v<T>, char, T>> value; };
+
+    Future() = default;
+    explicit Future(std::shared_ptr<State> st) : st(std::move(st)) {}
+    bool valid() const { return (bool)st; }
+    bool ready() const { std::lock_guard<std::mutex> lock(st->m); return st->done; }
+    void wait() const { Scheduler::shared().wait(*st); }
+    // Waits and moves the result out (rethrowing the task's exception). A Future is consumed by get() or then(),
+    // after which valid() is false.
+    T get() {
+        wait();
+        auto s = std::move(st);
+        if (s->error) std::rethrow_exception(s->error);
+        if constexpr (!std::is_void_v<T>) return std::move(*s->value);
+    }
+    // Runs fn(result) on lane once this completes; an exception skips fn and passes on to the returned Future.
+    template <typename F> auto then(Lane lane, F&& fn);
+private:
+    std::shared_ptr<State> st;
+};
+
+namespace scheduler_detail {
+template <typename T, typename F> struct then_result { using type = std::invoke_result_t<F&, T&&>; };
+template <typename F> struct then_result<void, F> { using type = std::invoke_result_t<F&>; };
+
+template <typename T, typename F, typename... A> void fulfil(T& st, F& fn, A&&... args) {
+    try {
+        if constexpr (std::is_void_v<std::invoke_result_t<F&, A...>>) fn(std::forward<A>(args)...);
+        else st.value.emplace(fn(std::forward<A>(args)...));
+    } catch (...) { st.error = std::current_exception(); }
+    st.finish();
+}
+}
+
+template <typename F>
+auto Scheduler::submit(Lane lane, F&& fn) -> Future<std::invoke_result_t<std::decay_t<F>&>> {
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+    auto st = std::make_shared<typename Future<R>::State>();
+    auto f = std::make_shared<std::decay_t<F>>(std::forward<F>(fn)); // std::function needs a copyable target
+    post(lane, [st, f]{ scheduler_detail::fulfil(*st, *f); });
+    return Future<R>(st);
+}
+
+template <typename T> template <typename F>
+auto Scheduler::Future<T>::then(Lane lane, F&& fn) {
+    using Next = Future<typename scheduler_detail::then_result<T, std::decay_t<F>>::type>;
+    auto next = std::make_shared<typename Next::State>();
+    auto f = std::make_shared<std::decay_t<F>>(std::forward<F>(fn));
+    auto prev = std::move(st);
+    prev->onDone([lane, prev, next, f] {
+        Scheduler::shared().post(lane, [prev, next, f] {
+            if (prev->error) { next->error = prev->error; next->finish(); return; }
+            if constexpr (std::is_void_v<T>) scheduler_detail::fulfil(*next, *f);
+            else scheduler_detail::fulfil(*next, *f, std::move(*prev->value));
+        });
+    });
+    return Next(next);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Inverted index over transcript segments, stored as immutable segment files under
+// ~/.meeting_assistant/index. Each saved meeting adds one segment file (written to a temp name and
+// renamed into place); once there are too many, they are compacted into one. Files are mmap'd at
+// query time and laid out as fixed-size tables plus a string blob:
+//
+//   header    "MAIX" u32 version, u32 n_meetings, u32 n_docs, u32 n_terms, u64 off[5], u64 total_tokens
+//   meetings  {u32 name_off, name_len, path_off, path_len; i64 date_unix}
+//   docs      {u32 meeting; i32 speaker; i64 t_ms; u32 text_off, text_len, n_tokens, pad}
+//   terms     sorted by bytes: {u32 str_off, str_len, df, post_len; u64 post_off}
+//   postings  per term: varint(doc delta), varint(tf) pairs
+//   strings
+class SearchIndex {
+public:
+    // t_ms: segment start in milliseconds; speaker: 0-based as in the journal, stream and /jobs (-1 = none).
+    struct Segment { int64_t t_ms; int speaker = -1; std::string text; };
+    struct Hit { double score; std::string meeting, path, text; int64_t date_unix, t_ms; int speaker; };
+    struct Query { std::string text; size_t limit = 10; std::string meeting; int speaker = -1; int64_t since_unix = 0; };
+
+    explicit SearchIndex(const std::string& dir = defaultDir());
+
+    bool addMeeting(const std::string& name, const std::string& path, int64_t date_unix, const std::vector<Segment>& segments);
+    std::vector<Hit> search(const Query& q) const;
+    bool compact();
+
+    static std::string defaultDir();
+    // Parses "HH:MM:SS[.mmm][ [Speaker N]]: text" transcript lines (backfill; N is 1-based, so speaker = N - 1).
+    static std::vector<Segment> parseTranscript(const std::string& transcript);
+    static std::vector<std::string> tokenize(const std::string& text);
+private:
+    std::vector<std::string> segmentFiles() const;
+    std::string dir;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+// Machine-readable feed of transcript events, one JSON object per line, for caption and indexing services:
+//   {"type":"segment","t0_ms":..,"t1_ms":..,"text":..,"speaker":..,"confidence":..,"final":true}
+//   {"type":"start"|"end", ...}
+// Targets: "-" (stdout), "fifo:<path>" (created if missing; events wait, bounded, until a reader opens it)
+// or "unix:<path>" (a listening socket; every connected client gets the stream from the moment it connects).
+//
+// publishing never blocks: each consumer has its own bounded buffer drained by a writer thread with
+// non-blocking writes, and events that do not fit are dropped and counted, so a slow consumer cannot stall
+// transcription. Lag is the time from publishing an event to its last byte being written.
+class SegmentStream {
+public:
+    struct Stats { long published = 0, written = 0, dropped = 0; int consumers = 0; double max_lag_ms = 0; };
+
+    explicit SegmentStream(size_t maxBufferBytes = 1 << 20) : maxBuffer(maxBufferBytes) {}
+    ~SegmentStream() { close(); }
+    SegmentStream(const SegmentStream&) = delete;
+    SegmentStream& operator=(const SegmentStream&) = delete;
+
+    bool open(const std::string& target);
+    bool isOpen() const { return running; }
+    // Callers that stream to stdout must move their own console output elsewhere (see main).
+    bool usesStdout() const { return kind == Kind::Stdout; }
+
+    void segment(int64_t t0_ms, int64_t t1_ms, const std::string& text, int speaker, float confidence, bool final);
+    void event(const nlohmann::json& j);
+    // Stops accepting events and gives consumers up to timeoutMs to take what is buffered.
+    void close(int timeoutMs = 1000);
+    Stats stats();
+
+private:
+    enum class Kind { None, Stdout, Fifo, Socket };
+    using Clock = std::chrono::steady_clock;
+    struct Sink { int fd; bool socket; std::string buf; size_t head = 0; std::deque<std::pair<size_t, Clock::time_point>> marks; };
+
+    void publish(const std::string& line);
+    void writerLoop();
+    bool flush(Sink& s);                  // false when the consumer has gone away
+    void wake();
+
+    Kind kind = Kind::None; std::string path;
+    int listenFd = -1, wakePipe[2] = {-1, -1};
+    size_t maxBuffer; int drainMs = 1000;
+    std::vector<Sink> sinks; std::mutex mutex; Stats counters;
+    std::atomic<bool> running{false}, draining{false}; std::thread writer;
+    Clock::time_point lastFifoAttempt{};
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "Config.h"
+#include "Transcriber.h"
+#include "MemoryBudget.h"
+#include "HttpServer.h"
+
+struct Job {
+    enum class State { Queued, Running, Done, Failed };
+    uint64_t id = 0;
+    int priority = 0;
+    std::string name;
+    std::string path;           // audio file on disk, or empty when uploaded
+    std::vector<char> upload;   // raw WAV bytes for uploaded jobs (released once decoded)
+    bool report = true;
+
+    State state = State::Queued;
+    std::string error;
+    std::string output;
+    std::vector<TranscriptionSegment> segments;
+    double audio_sec = 0;
+    std::chrono::steady_clock::time_point submitted, started, finished;
+    std::mutex mutex; std::condition_variable cv;
+};
+
+// Bounded priority queue: higher priority first, FIFO within a priority. push() fails instead of blocking when full.
+class JobQueue {
+public:
+    explicit JobQueue(size_t capacity);
+    bool push(std::shared_ptr<Job> job);
+    std::shared_ptr<Job> pop();
+    void close();
+    size_t size();
+    size_t capacity() const { return cap; }
+private:
+    struct Entry { int priority; uint64_t seq; std::shared_ptr<Job> job; };
+    struct Cmp { bool operator()(const Entry& a, const Entry& b) const { return a.priority != b.priority ? a.priority < b.priority : a.seq > b.seq; } };
+    std::priority_queue<Entry, std::vector<Entry>, Cmp> queue; size_t cap; uint64_t seq = 0; bool closed = false;
+    std::mutex mutex; std::condition_variable cv;
+};
+
+// Local HTTP/1.1 API over TCP ("host:port") or a Unix socket ("unix:/path"), backed by a fixed worker pool
+// that shares a single Transcriber (one copy of the weights, one whisper_state per worker).
+//   POST /jobs                    WAV body (upload) or JSON {"path", "priority", "name", "report"}; a path must lie
+//                                 under config.serve_path_root, or without one the listener must be loopback/unix
+//   GET  /jobs, /jobs/{id}        job status
+//   GET  /jobs/{id}/segments      NDJSON stream of segments until the job finishes
+//   GET  /health                  queue, worker, scheduler and memory statistics
+class MeetingServer {
+public:
+    MeetingServer(const Config::Data& config, Transcriber& transcriber, int workers, size_t queueCapacity);
+    ~MeetingServer();
+    bool listen(const std::string& address);
+    void start();   // without listen() only the worker pool runs, fed through submit()
+    void stop();
+    // Queues a job as POST /jobs does. False when the queue is full.
+    bool submit(const std::shared_ptr<Job>& job);
+    // Runs on the worker thread after a job reaches Done or Failed. Set before start().
+    void setOnFinished(std::function<void(const Job&)> fn) { onFinished = std::move(fn); }
+    // Reported by /health; its upload_bytes bounds the WAV bodies held by queued jobs (503 beyond). Set before start().
+    void setMemoryPlan(const MemoryPlan& plan) { memPlan = plan; }
+private:
+    void acceptLoop();
+    void workerLoop();
+    void handleConnection(int fd);
+    void processJob(const std::shared_ptr<Job>& job);
+    std::shared_ptr<Job> findJob(uint64_t id);
+    bool pathAllowed(const std::string& path) const;
+
+    Config::Data config;
+    Transcriber& transcriber;
+    int n_workers; int threads_per_worker;
+    JobQueue queue;
+    std::map<uint64_t, std::shared_ptr<Job>> jobs; std::mutex jobsMutex; uint64_t nextId = 1;
+    std::vector<std::thread> workers; std::thread acceptor;
+    std::atomic<bool> running{false}; std::atomic<int> busy{0}; ConnectionSet connections;
+    std::atomic<uint64_t> completed{0}, failed{0}, rejected{0};
+    MemoryPlan memPlan; std::atomic<size_t> uploadBytes{0};
+    int listenFd = -1; std::string unixPath; bool localOnly = false;
+    std::function<void(const Job&)> onFinished;
+};
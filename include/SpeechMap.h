@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Transcriber.h"
+
+// Speech-only view of a recording. build() drops non-speech stretches (silence, breaks, long pauses) and
+// concatenates the remaining spans, each padded with a little of the surrounding audio, into the buffer
+// that is sent to Whisper. The span table maps every sample of that buffer back to the original recording,
+// so segment times can be translated exactly. Spans start and end on 10 ms boundaries.
+class SpeechMap {
+public:
+    struct Options { float max_threshold = 0.01f; int frame_ms = 20, pad_ms = 300, min_gap_ms = 1000; };
+    struct Span { size_t src, dst, len; }; // in samples
+
+    // Fills speech with the kept audio. When little or nothing would be skipped, speech is left empty, the
+    // map is the identity and pcm should be decoded as is.
+    static SpeechMap build(const std::vector<float>& pcm, std::vector<float>& speech, const Options& opt);
+
+    // t in 10 ms units of the speech buffer -> 10 ms units of the original. End times stay inside the span
+    // they close instead of jumping to the start of the next one.
+    int64_t toSource(int64_t t, bool isEnd = false) const;
+    void remap(TranscriptionSegment& seg) const;
+    void remap(std::vector<TranscriptionSegment>& segments) const;
+
+    size_t sourceSamples() const { return total; }
+    size_t keptSamples() const { return spans.empty() ? 0 : spans.back().dst + spans.back().len; }
+    double skippedFraction() const { return total ? 1.0 - (double)keptSamples() / total : 0.0; }
+    const std::vector<Span>& table() const { return spans; }
+private:
+    std::vector<Span> spans; size_t total = 0;
+};
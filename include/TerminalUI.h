@@ -2,6 +2,8 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <chrono>
+class TranscriptStore;
 
 class TerminalUI {
 public:
@@ -9,8 +11,8 @@ public:
     static void setStatus(const std::string& status);
     static void updateLevel(float rms, float threshold);
     static void updateProgress(int progress);
-    static void addSegment(const std::string& timestamp, const std::string& text);
-    static void clearSegments();
+    // The dashboard renders the tail of this store in place; pass nullptr before the store goes away.
+    static void setTranscript(const TranscriptStore* store);
     static void loop(); 
     static bool isEnabled();
     static void setEnabled(bool enabled);
@@ -44,7 +46,7 @@ private:
     static float current_rms;
     static float current_threshold;
     static int current_progress;
-    static std::vector<std::pair<std::string, std::string>> segments;
+    static const TranscriptStore* transcript;
     static std::mutex data_mutex;
     static std::chrono::steady_clock::time_point start_proc_time;
 };
@@ -3,20 +3,74 @@
 #include <vector>
 #include <whisper.h>
 #include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 
-struct TranscriptionSegment { int64_t t0; int64_t t1; std::string text; int speaker_id = -1; };
+#include "Config.h"
+#include "Scheduler.h"
+
+// speaker_turn: tinydiarize predicted a speaker change right after this segment.
+// confidence: geometric mean of the text token probabilities (0..1).
+struct TranscriptionSegment { int64_t t0; int64_t t1; std::string text; int speaker_id = -1; bool speaker_turn = false; float confidence = 1.0f; };
 
 class Transcriber {
 public:
-    Transcriber(const std::string& modelPath);
+    // The weights are loaded once; each concurrent transcribe() call borrows one of up to maxStates decoder states.
+    // With background=true the model is read and warmed up on the scheduler's Live lane so the caller can open devices
+    // and decode input meanwhile; transcribe() waits until it is ready. useGpu=false keeps everything on the CPU.
+    Transcriber(const std::string& modelPath, int maxStates = 1, bool background = false, bool useGpu = true);
     ~Transcriber();
+
+    struct LoadStats { double load_ms = 0, warmup_ms = 0; };
+
+    // Greedy (default): whisper's own (the whole 30 s window is re-run at higher temperature when it fails).
+    // Beam: beam search everywhere. Adaptive: one greedy pass, then only segments below min_confidence (or
+    // that look like a repetition loop) are re-decoded with beam search; the re-decode is kept only when it
+    // passes both checks itself.
+    struct DecodePolicy { enum Mode { Greedy, Adaptive, Beam } mode = Greedy; float min_confidence = 0.4f; float max_compression = 2.4f; int beam_size = 5; };
+    static DecodePolicy decodePolicyFor(const Config::Data& config);
+    // Totals over every transcribe() call so far.
+    struct DecodeStats { double audio_sec = 0, redecoded_sec = 0; int segments = 0, redecoded = 0, improved = 0; };
     
     using ProgressCallback = std::function<void(int progress)>;
+    using SegmentCallback = std::function<void(const TranscriptionSegment& segment)>;
     
+    bool isLoaded();                          // waits for a background load
+    bool isReady() const { return ready; }    // never blocks
+    LoadStats loadStats() const { return stats; }
+    void setMaxStates(int n);
+    void setDecodePolicy(const DecodePolicy& p) { policy = p; }
+    DecodeStats decodeStats();
+
     std::vector<TranscriptionSegment> transcribe(const std::vector<float>& pcmf32, 
                                                 int n_threads = 4, 
                                                 const std::string& initial_prompt = "",
-                                                ProgressCallback callback = nullptr);
+                                                ProgressCallback callback = nullptr,
+                                                SegmentCallback onSegment = nullptr);
+
+    // Token-level context carried between consecutive windows of one stream. Each call is prompted with the
+    // vocabulary prefix followed by the most recent decoded text tokens (up to budget in total), and its
+    // own output tokens are appended to history, so nothing is re-tokenized or cut mid-word.
+    struct PromptState { std::vector<whisper_token> vocabulary, history; int budget = 64; };
+    std::vector<TranscriptionSegment> transcribe(const std::vector<float>& pcmf32, int n_threads, PromptState& prompt,
+                                                ProgressCallback callback = nullptr, SegmentCallback onSegment = nullptr);
+    std::vector<whisper_token> tokenize(const std::string& text); // waits for a background load
 private:
-    struct whisper_context* ctx = nullptr;
+    static const int WARMUP_SAMPLES = 8000; // 0.5 s at 16 kHz
+    void load(const std::string& modelPath);
+    struct whisper_state* acquireState();
+    void releaseState(struct whisper_state* state);
+    std::vector<TranscriptionSegment> run(const std::vector<float>& pcmf32, whisper_full_params& wparams, ProgressCallback& callback,
+                                          SegmentCallback& onSegment, std::vector<whisper_token>* outTokens);
+    bool redecode(struct whisper_state* state, const std::vector<float>& pcmf32, const whisper_full_params& greedy,
+                  const std::vector<whisper_token>& context, TranscriptionSegment& seg, std::vector<whisper_token>& tokens);
+    bool needsRedecode(const TranscriptionSegment& seg) const;
+
+    struct whisper_context* ctx = nullptr; bool useGpu;
+    std::vector<struct whisper_state*> states, idleStates; int maxStates;
+    std::mutex stateMutex; std::condition_variable stateCv;
+    Scheduler::Future<void> loader; std::atomic<bool> ready{false}; std::mutex readyMutex; std::condition_variable readyCv; LoadStats stats;
+    DecodePolicy policy; std::mutex decodeMutex; DecodeStats decodeTotals;
 };
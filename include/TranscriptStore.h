@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// Transcript of one session. Segment text is copied once into 64 KB arena chunks that are never moved or freed
+// while the store lives, so the string_views handed out stay valid and consumers (dashboard, copilot, report
+// rendering) read the text in place instead of keeping their own copies. Entry IDs are indices, stable as
+// long as nothing is replaced. Appends and reads may come from different threads.
+class TranscriptStore {
+public:
+    using Id = uint32_t;
+    struct Entry { int64_t t0_ms, t1_ms; int speaker; std::string_view text; };
+    struct MemoryStats { size_t entries, text_bytes, arena_bytes, index_bytes; int64_t audio_ms; };
+
+    TranscriptStore() = default;
+    TranscriptStore(const TranscriptStore&) = delete;
+    TranscriptStore& operator=(const TranscriptStore&) = delete;
+
+    Id append(int64_t t0_ms, int64_t t1_ms, int speaker, std::string_view text);
+    // Swaps the entries starting in [from_ms, to_ms) for `with` (the cascade's second pass) and returns how many
+    // were removed. Later IDs shift; the old text stays in the arena, so views already handed out remain valid.
+    size_t replace(int64_t from_ms, int64_t to_ms, const std::vector<Entry>& with);
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    Entry at(Id id) const;
+
+    // Calls f(id, entry) for every entry from `from` on, holding the lock for the whole walk.
+    template <typename F> void forEach(F&& f, Id from = 0) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = from; i < entries.size(); ++i) f((Id)i, entries[i]);
+    }
+
+    // Transcript lines ("HH:MM:SS [Speaker N]: text"), built in one pre-sized allocation. This is the only
+    // full copy, made once per report for the LLM payload and the writers.
+    std::string render() const;
+    // The most recent text, at most maxChars and starting on a word boundary (copilot context).
+    std::string tail(size_t maxChars) const;
+    MemoryStats memory() const;
+
+private:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+    struct Chunk { std::unique_ptr<char[]> data; size_t cap, used; };
+    std::string_view store(std::string_view text); // copies text into the arena; caller holds the lock
+    std::vector<Chunk> chunks;
+    std::deque<Entry> entries; // deque: growing never relocates existing entries
+    size_t textBytes = 0, arenaBytes = 0; int64_t lastMs = 0;
+    mutable std::mutex mutex;
+};
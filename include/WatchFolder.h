@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "Config.h"
+#include "Server.h"
+
+// Ingests recordings dropped into a directory (e.g. by conference-room recorders) through a MeetingServer's
+// worker pool. New files are picked up via inotify on Linux, plus a periodic rescan that also covers network
+// shares and other platforms. A file is queued only once its size and mtime have not changed for
+// config.watch_settle_ms.
+//
+// Job state is an append-only, fsynced NDJSON log in <config dir>/watch/. Files are identified by path, size
+// and mtime, so completed files are never processed again after a restart, files that were queued or
+// running when the daemon stopped are queued again, and a file replaced under the same name counts as new.
+// Failed files are retried up to MAX_ATTEMPTS times.
+class WatchFolder {
+public:
+    WatchFolder(const Config::Data& config, MeetingServer& server, const std::string& dir);
+    ~WatchFolder() { stop(); }
+
+    bool start();  // replays the state log and starts watching
+    void stop();
+    // Must be wired to MeetingServer::setOnFinished (it ignores jobs it did not submit).
+    void jobFinished(const Job& job);
+    std::string summary();
+
+    static std::string stateDir();
+private:
+    static const int MAX_ATTEMPTS = 3;
+    enum class State { Settling, Pending, Queued, Done, Failed };
+    using Clock = std::chrono::steady_clock;
+    struct Entry {
+        uintmax_t size = 0; int64_t mtime = 0; State state = State::Settling; int attempts = 0;
+        Clock::time_point lastChange, readyAt;
+    };
+
+    void loop();
+    void scan();
+    void observe(const std::string& path);
+    void promote();
+    void log(const std::string& path, const Entry& e, const char* event);
+
+    std::string dir, statePath; int settleMs;
+    MeetingServer& server;
+    std::map<std::string, Entry> files; std::mutex mutex;
+    std::thread watcher; std::atomic<bool> running{false};
+    int notifyFd = -1, logFd = -1;
+
+    // Metrics: queue latency is from a file being ready (settled) to its job starting.
+    Clock::time_point started;
+    long done = 0, failedCount = 0; double audioSec = 0, procSec = 0;
+    std::vector<double> queueWaits;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "Config.h"
+
+float calculate_rms(const std::vector<float>& samples);
+
+// Cuts live audio into transcription windows: a window is due after config.vad_silence_ms of silence once it
+// holds more than MIN_WINDOW_SEC, or when it reaches MAX_WINDOW_SEC. Live capture and the bench harness
+// both cut through this, so benchmark numbers reflect the real windowing.
+class WindowCutter {
+public:
+    static constexpr float MIN_WINDOW_SEC = 2.0f, MAX_WINDOW_SEC = 30.0f;
+
+    explicit WindowCutter(const Config::Data& config) : threshold(config.vad_threshold), silenceLimitMs(config.vad_silence_ms) {}
+
+    float add(const std::vector<float>& chunk); // returns the chunk's RMS level
+    bool due() const;
+    bool hasSpeech() const;                     // mean level above half the VAD threshold
+    const std::vector<float>& samples() const { return pcm; }
+    double seconds() const;
+    void clear();
+private:
+    float threshold; int silenceLimitMs;
+    float silenceMs = 0, totalRms = 0; int rmsCount = 0;
+    std::vector<float> pcm;
+};
@@ -0,0 +1,284 @@
+#include "AudioArchive.h"
+#include "AudioSource.h"
+#include "Scheduler.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+const uint32_t BLOCK_SAMPLES = 4096;
+const uint32_t PARTITION = 256;
+const size_t RING_SAMPLES = SAMPLE_RATE * 30;
+const int MAX_ORDER = 4;
+const int RAW_ORDER = 7;       // block stored as raw PCM16 when prediction does not pay off
+const uint32_t ESCAPE_Q = 24;  // quotients >= this are written as escape + 24 raw bits
+
+template <typename T> void put(std::vector<uint8_t>& b, T v) { uint8_t tmp[sizeof(T)]; std::memcpy(tmp, &v, sizeof(T)); b.insert(b.end(), tmp, tmp + sizeof(T)); }
+template <typename T> bool get(std::istream& f, T& v) { return (bool)f.read(reinterpret_cast<char*>(&v), sizeof(T)); }
+
+struct BitWriter {
+    std::vector<uint8_t>& out; uint64_t acc = 0; int n = 0;
+    explicit BitWriter(std::vector<uint8_t>& o) : out(o) {}
+    void bits(uint32_t v, int count) {
+        acc = (acc << count) | (v & ((1ull << count) - 1)); n += count;
+        while (n >= 8) { n -= 8; out.push_back((uint8_t)(acc >> n)); }
+    }
+    void rice(uint32_t u, int k) {
+        uint32_t q = u >> k;
+        if (q >= ESCAPE_Q) { bits(0, ESCAPE_Q); bits(u, 24); return; }
+        bits(1, q + 1);
+        if (k) bits(u & ((1u << k) - 1), k);
+    }
+    void flush() { if (n) out.push_back((uint8_t)(acc << (8 - n))); n = 0; acc = 0; }
+};
+
+struct BitReader {
+    const uint8_t* p; const uint8_t* end; uint64_t acc = 0; int n = 0;
+    BitReader(const uint8_t* b, const uint8_t* e) : p(b), end(e) {}
+    uint32_t bits(int count) {
+        while (n < count) { acc = (acc << 8) | (p < end ? *p++ : 0); n += 8; }
+        n -= count;
+        return (uint32_t)((acc >> n) & ((1ull << count) - 1));
+    }
+    uint32_t rice(int k) {
+        uint32_t q = 0;
+        while (q < ESCAPE_Q && bits(1) == 0) q++;
+        if (q == ESCAPE_Q) return bits(24);
+        return (q << k) | (k ? bits(k) : 0);
+    }
+};
+
+inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag(uint32_t u) { return (int32_t)(u >> 1) ^ -(int32_t)(u & 1); }
+
+inline int32_t predict(const int32_t* x, int order) {
+    switch (order) {
+        case 1: return x[-1];
+        case 2: return 2 * x[-1] - x[-2];
+        case 3: return 3 * x[-1] - 3 * x[-2] + x[-3];
+        case 4: return 4 * x[-1] - 6 * x[-2] + 4 * x[-3] - x[-4];
+        default: return 0;
+    }
+}
+
+inline int16_t to_pcm16(float f) { return (int16_t)std::lrint(std::max(-1.0f, std::min(1.0f, f)) * 32767.0f); }
+
+void encode_lpc(const int16_t* s, size_t n, std::vector<uint8_t>& out) {
+    std::vector<int32_t> x(s, s + n);
+    int best = 0; uint64_t best_sum = UINT64_MAX;
+    for (int o = 0; o <= MAX_ORDER && (size_t)o < n; ++o) {
+        uint64_t sum = 0;
+        for (size_t i = o; i < n; ++i) sum += std::abs(x[i] - predict(&x[i], o));
+        if (sum < best_sum) { best_sum = sum; best = o; }
+    }
+    std::vector<uint32_t> res;
+    res.reserve(n);
+    for (size_t i = best; i < n; ++i) res.push_back(zigzag(x[i] - predict(&x[i], best)));
+
+    out.push_back((uint8_t)best);
+    for (int i = 0; i < best; ++i) put<int16_t>(out, s[i]);
+    BitWriter bw(out);
+    for (size_t p = 0; p < res.size(); p += PARTITION) {
+        size_t e = std::min(res.size(), p + PARTITION);
+        int best_k = 0; uint64_t best_cost = UINT64_MAX;
+        for (int k = 0; k < 16; ++k) {
+            uint64_t cost = 0;
+            for (size_t i = p; i < e; ++i) { uint32_t q = res[i] >> k; cost += q >= ESCAPE_Q ? ESCAPE_Q + 24 : q + 1 + k; }
+            if (cost < best_cost) { best_cost = cost; best_k = k; }
+        }
+        bw.bits(best_k, 4);
+        for (size_t i = p; i < e; ++i) bw.rice(res[i], best_k);
+    }
+    bw.flush();
+}
+
+bool decode_lpc(const uint8_t* b, const uint8_t* end, uint32_t n, float* out) {
+    if (b >= end) return false;
+    int order = *b++;
+    std::vector<int32_t> x(n);
+    if (order == RAW_ORDER) {
+        if ((size_t)(end - b) < n * 2) return false;
+        for (uint32_t i = 0; i < n; ++i) { int16_t v; std::memcpy(&v, b + i * 2, 2); out[i] = v / 32768.0f; }
+        return true;
+    }
+    if (order > MAX_ORDER || (size_t)(end - b) < (size_t)order * 2) return false;
+    for (int i = 0; i < order && (uint32_t)i < n; ++i) { int16_t v; std::memcpy(&v, b, 2); b += 2; x[i] = v; }
+    BitReader br(b, end);
+    for (uint32_t p = order; p < n; p += PARTITION) {
+        int k = br.bits(4);
+        for (uint32_t i = p; i < std::min(n, p + PARTITION); ++i) x[i] = predict(&x[i], order) + unzigzag(br.rice(k));
+    }
+    for (uint32_t i = 0; i < n; ++i) out[i] = x[i] / 32768.0f;
+    return true;
+}
+}
+
+AudioArchiveWriter::~AudioArchiveWriter() { close(); }
+
+bool AudioArchiveWriter::open(const std::string& path, ArchiveCodec c) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    codec = c;
+    std::vector<uint8_t> hdr = {'M', 'A', 'A', '1'};
+    put<uint32_t>(hdr, SAMPLE_RATE); hdr.push_back((uint8_t)codec); hdr.insert(hdr.end(), 3, 0); put<uint32_t>(hdr, BLOCK_SAMPLES);
+    file.write((const char*)hdr.data(), hdr.size());
+    bytesWritten = hdr.size();
+    ring.assign(RING_SAMPLES, 0.0f); head = tail = 0; index.clear();
+    running = true;
+    encoder = std::thread([this]{ encodeLoop(); });
+    return true;
+}
+
+void AudioArchiveWriter::push(const float* samples, size_t n) {
+    if (!running) return;
+    size_t h = head.load(std::memory_order_relaxed), t = tail.load(std::memory_order_acquire);
+    size_t space = ring.size() - (h - t);
+    if (n > space) { dropped += n - space; n = space; }
+    for (size_t i = 0; i < n; ++i) ring[(h + i) % ring.size()] = samples[i];
+    head.store(h + n, std::memory_order_release);
+}
+
+void AudioArchiveWriter::drain(std::vector<int16_t>& block, bool final) {
+    size_t t = tail.load(std::memory_order_relaxed), h = head.load(std::memory_order_acquire);
+    for (; t != h; ++t) {
+        block.push_back(to_pcm16(ring[t % ring.size()]));
+        if (block.size() == BLOCK_SAMPLES) { writeBlock(block.data(), block.size()); block.clear(); }
+    }
+    tail.store(t, std::memory_order_release);
+    if (final && !block.empty()) { writeBlock(block.data(), block.size()); block.clear(); }
+}
+
+void AudioArchiveWriter::encodeLoop() {
+    std::vector<int16_t> block; block.reserve(BLOCK_SAMPLES);
+    while (running) {
+        drain(block, false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    drain(block, true);
+}
+
+void AudioArchiveWriter::writeBlock(const int16_t* s, size_t n) {
+    std::vector<uint8_t> payload;
+    if (codec == ArchiveCodec::LPC) encode_lpc(s, n, payload);
+    if (codec == ArchiveCodec::PCM16 || payload.size() >= n * 2 + 1) {
+        payload.clear();
+        if (codec == ArchiveCodec::LPC) payload.push_back((uint8_t)RAW_ORDER);
+        for (size_t i = 0; i < n; ++i) put<int16_t>(payload, s[i]);
+    }
+    std::vector<uint8_t> hdr; put<uint32_t>(hdr, (uint32_t)n); put<uint32_t>(hdr, (uint32_t)payload.size());
+    index.push_back({bytesWritten.load(), encoded.load()});
+    file.write((const char*)hdr.data(), hdr.size());
+    file.write((const char*)payload.data(), payload.size());
+    bytesWritten += hdr.size() + payload.size(); encoded += n; blocksWritten++;
+}
+
+void AudioArchiveWriter::close() {
+    if (!running.exchange(false)) return;
+    if (encoder.joinable()) encoder.join();
+    std::vector<uint8_t> tail_buf;
+    uint64_t index_offset = bytesWritten;
+    for (const auto& e : index) { put<uint64_t>(tail_buf, e.first); put<uint64_t>(tail_buf, e.second); }
+    tail_buf.insert(tail_buf.end(), {'M', 'A', 'A', 'I'});
+    put<uint64_t>(tail_buf, index_offset); put<uint32_t>(tail_buf, (uint32_t)index.size());
+    tail_buf.insert(tail_buf.end(), {'M', 'A', 'A', 'E'});
+    file.write((const char*)tail_buf.data(), tail_buf.size());
+    bytesWritten += tail_buf.size();
+    file.close();
+}
+
+bool AudioArchiveReader::open(const std::string& p) {
+    path = p; blocks.clear(); total = 0;
+    std::ifstream f(path, std::ios::binary); if (!f.is_open()) return false;
+    char magic[4]; uint32_t sr, block_samples; uint8_t c, reserved[3];
+    if (!f.read(magic, 4) || std::memcmp(magic, "MAA1", 4) != 0) return false;
+    if (!get(f, sr) || !get(f, c) || !f.read((char*)reserved, 3) || !get(f, block_samples)) return false;
+    rate = (int)sr; codec = (ArchiveCodec)c;
+    const uint64_t data_start = f.tellg();
+
+    f.seekg(0, std::ios::end); const uint64_t size = f.tellg();
+    const uint64_t trailer_size = 4 + 8 + 4 + 4;
+    if (size >= data_start + trailer_size) {
+        char tm[4], te[4]; uint64_t index_offset; uint32_t n_blocks;
+        f.seekg(size - trailer_size);
+        if (f.read(tm, 4) && get(f, index_offset) && get(f, n_blocks) && f.read(te, 4) &&
+            std::memcmp(tm, "MAAI", 4) == 0 && std::memcmp(te, "MAAE", 4) == 0 && index_offset + n_blocks * 16ull + trailer_size == size) {
+            f.seekg(index_offset);
+            std::vector<std::pair<uint64_t, uint64_t>> idx(n_blocks);
+            for (auto& e : idx) if (!get(f, e.first) || !get(f, e.second)) return false;
+            for (size_t i = 0; i < idx.size(); ++i) {
+                uint64_t next = (i + 1 < idx.size()) ? idx[i + 1].second : 0;
+                blocks.push_back({idx[i].first, idx[i].second, 0});
+                if (i + 1 < idx.size()) blocks.back().n = (uint32_t)(next - idx[i].second);
+            }
+            if (!blocks.empty()) {
+                f.seekg(blocks.back().offset); uint32_t n; if (!get(f, n)) return false;
+                blocks.back().n = n;
+                total = blocks.back().first + n;
+            }
+            return true;
+        }
+    }
+
+    // No valid index: the writer did not close cleanly, walk the blocks.
+    f.clear(); f.seekg(data_start);
+    uint64_t off = data_start;
+    while (off + 8 <= size) {
+        uint32_t n, bytes;
+        f.seekg(off);
+        if (!get(f, n) || !get(f, bytes) || n == 0 || n > block_samples || bytes == 0 || off + 8 + bytes > size) break;
+        blocks.push_back({off, total, n});
+        total += n; off += 8 + bytes;
+    }
+    return true;
+}
+
+bool AudioArchiveReader::decodeBlock(std::ifstream& f, const Block& b, float* out) {
+    uint32_t n, bytes;
+    f.seekg(b.offset);
+    if (!get(f, n) || !get(f, bytes) || n != b.n) return false;
+    std::vector<uint8_t> payload(bytes);
+    if (!f.read((char*)payload.data(), bytes)) return false;
+    if (codec == ArchiveCodec::LPC) return decode_lpc(payload.data(), payload.data() + bytes, n, out);
+    if (bytes < n * 2) return false;
+    for (uint32_t i = 0; i < n; ++i) { int16_t v; std::memcpy(&v, payload.data() + i * 2, 2); out[i] = v / 32768.0f; }
+    return true;
+}
+
+bool AudioArchiveReader::read(uint64_t start, uint64_t count, std::vector<float>& out) {
+    out.clear();
+    if (start >= total) return true;
+    count = std::min(count, total - start);
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), start, [](uint64_t s, const Block& b) { return s < b.first; });
+    if (it != blocks.begin()) --it;
+    std::ifstream f(path, std::ios::binary); if (!f.is_open()) return false;
+    std::vector<float> buf;
+    out.reserve(count);
+    for (; it != blocks.end() && out.size() < count; ++it) {
+        buf.resize(it->n);
+        if (!decodeBlock(f, *it, buf.data())) return false;
+        uint64_t from = start + out.size() > it->first ? start + out.size() - it->first : 0;
+        uint64_t take = std::min<uint64_t>(it->n - from, count - out.size());
+        out.insert(out.end(), buf.begin() + from, buf.begin() + from + take);
+    }
+    return true;
+}
+
+bool AudioArchiveReader::readAll(std::vector<float>& out) {
+    out.assign(total, 0.0f);
+    int n_tasks = std::max(1, std::min(8, Scheduler::shared().workers()));
+    std::atomic<size_t> next{0}; std::atomic<bool> ok{true};
+    std::vector<Scheduler::Future<void>> pool;
+    for (int t = 0; t < n_tasks; ++t) pool.push_back(Scheduler::shared().submit(Scheduler::Lane::Render, [&] {
+        std::ifstream f(path, std::ios::binary);
+        if (!f.is_open()) { ok = false; return; }
+        for (size_t i; (i = next++) < blocks.size();) if (!decodeBlock(f, blocks[i], out.data() + blocks[i].first)) ok = false;
+    }));
+    for (auto& f : pool) f.get();
+    return ok;
+}
+
+bool is_audio_archive(const std::string& path) {
+    std::ifstream f(path, std::ios::binary); char magic[4];
+    return f.read(magic, 4) && std::memcmp(magic, "MAA1", 4) == 0;
+}
@@ -1,26 +1,112 @@
 #include "AudioCapture.h"
+#ifdef HAVE_PORTAUDIO
+#include "Governor.h"
+#include <portaudio.h>
 #include <iostream>
-AudioCapture::AudioCapture() : stream(nullptr), capturing(false) { Pa_Initialize(); }
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+struct AudioCaptureCallback {
+    static int run(const void* in, void* out, unsigned long f, const PaStreamCallbackTimeInfo* t, PaStreamCallbackFlags s, void* u) {
+        AudioCapture* This = (AudioCapture*)u; if (!in) return paContinue;
+        static thread_local bool prepared = false; if (!prepared) { prepared = true; ResourceGovernor::prepareAudioThread(); }
+        if (size_t lost = This->capture((const float*)in, f)) This->overrun.fetch_add(lost, std::memory_order_relaxed);
+        return paContinue;
+    }
+};
+namespace {
+const int RING_SEC = 2, FORWARD_MS = 10;
+
+std::string lower(std::string s) { std::transform(s.begin(), s.end(), s.begin(), ::tolower); return s; }
+
+PaDeviceIndex find_device(const std::string& request) {
+    if (request.empty()) return Pa_GetDefaultInputDevice();
+    if (std::all_of(request.begin(), request.end(), ::isdigit)) {
+        int i = std::stoi(request);
+        return i < Pa_GetDeviceCount() && Pa_GetDeviceInfo(i)->maxInputChannels > 0 ? i : paNoDevice;
+    }
+    for (int i = 0; i < Pa_GetDeviceCount(); ++i) {
+        const PaDeviceInfo* d = Pa_GetDeviceInfo(i);
+        if (d->maxInputChannels > 0 && lower(d->name).find(lower(request)) != std::string::npos) return i;
+    }
+    return paNoDevice;
+}
+}
+AudioCapture::AudioCapture(const std::string& device) : request(device) { Pa_Initialize(); }
 AudioCapture::~AudioCapture() { if (capturing) stopCapture(); Pa_Terminate(); }
-int AudioCapture::paCallback(const void* in, void* out, unsigned long f, const PaStreamCallbackTimeInfo* t, PaStreamCallbackFlags s, void* u) {
-    AudioCapture* This = (AudioCapture*)u; if (!in) return paContinue;
-    std::lock_guard<std::mutex> lock(This->audioMutex);
-    This->audioBuffer.insert(This->audioBuffer.end(), (float*)in, (float*)in + f);
-    This->audioCv.notify_one(); return paContinue;
+
+size_t AudioCapture::capture(const float* in, size_t frames) {
+    size_t h = head.load(std::memory_order_relaxed), space = ring.size() - (h - tail.load(std::memory_order_acquire)), n = 0, lost = 0;
+    auto put = [&](float v) { if (n < space) ring[(h + n++) % ring.size()] = v; else ++lost; };
+    if (rate == SAMPLE_RATE && channels == 1) for (size_t i = 0; i < frames; ++i) put(in[i]);
+    else if (frames) {
+        // Downmix and linear interpolation as in PcmDecoder, sample by sample; prev is the last frame of the
+        // previous callback (index -1), so the output is continuous across callbacks.
+        auto mono = [&](long i) { if (i < 0) return prev; float s = 0; for (int c = 0; c < channels; ++c) s += in[i * channels + c]; return s / channels; };
+        const double step = (double)rate / SAMPLE_RATE;
+        if (!primed) { prev = mono(0); primed = true; }
+        while (pos <= (double)(frames - 1)) {
+            long i = (long)std::floor(pos); double fr = pos - i;
+            float a = mono(i), b = i + 1 < (long)frames ? mono(i + 1) : a;
+            put(a + (float)((b - a) * fr));
+            pos += step;
+        }
+        pos -= frames; prev = mono((long)frames - 1);
+    }
+    head.store(h + n, std::memory_order_release);
+    return lost;
+}
+
+void AudioCapture::forwardLoop() {
+    std::vector<float> chunk; chunk.reserve(ring.size());
+    for (bool more = true; more; ) {
+        more = forwarding.load();
+        if (more) std::this_thread::sleep_for(std::chrono::milliseconds(FORWARD_MS));
+        size_t t = tail.load(std::memory_order_relaxed), h = head.load(std::memory_order_acquire);
+        chunk.clear();
+        for (; t != h; ++t) chunk.push_back(ring[t % ring.size()]);
+        tail.store(t, std::memory_order_release);
+        if (!chunk.empty()) push(chunk.data(), chunk.size());
+        if (size_t lost = overrun.exchange(0)) { std::lock_guard<std::mutex> lock(audioMutex); dropped += lost; }
+    }
 }
 bool AudioCapture::startCapture() {
-    PaStreamParameters params; params.device = Pa_GetDefaultInputDevice(); if (params.device == paNoDevice) return false;
-    params.channelCount = 1; params.sampleFormat = paFloat32; params.suggestedLatency = Pa_GetDeviceInfo(params.device)->defaultLowInputLatency; params.hostApiSpecificStreamInfo = nullptr;
-    if (Pa_OpenStream(&stream, &params, nullptr, SAMPLE_RATE, FRAMES_PER_BUFFER, paClipOff, paCallback, this) != paNoError) return false;
-    if (Pa_StartStream(stream) != paNoError) return false;
-    capturing = true; return true;
+    PaStreamParameters params; params.device = find_device(request);
+    if (params.device == paNoDevice) { if (!request.empty()) std::cerr << "No input device matches '" << request << "' (see --list-devices)" << std::endl; return false; }
+    const PaDeviceInfo* info = Pa_GetDeviceInfo(params.device);
+    if (!request.empty()) deviceName = info->name;
+    params.channelCount = 1; params.sampleFormat = paFloat32; params.suggestedLatency = info->defaultLowInputLatency; params.hostApiSpecificStreamInfo = nullptr;
+    rate = SAMPLE_RATE; channels = 1;
+    // Loopback and monitor devices often run only at 44.1/48 kHz, sometimes stereo only.
+    if (Pa_IsFormatSupported(&params, nullptr, rate) != paFormatIsSupported) {
+        rate = (int)info->defaultSampleRate;
+        if (Pa_IsFormatSupported(&params, nullptr, rate) != paFormatIsSupported) params.channelCount = std::min(2, info->maxInputChannels);
+        channels = params.channelCount;
+    }
+    // Everything the callback writes is allocated here: the ring holds RING_SEC of converted audio.
+    ring.assign((size_t)RING_SEC * SAMPLE_RATE, 0.0f); head = 0; tail = 0; overrun = 0; pos = 0; primed = false;
+    PaStream* s = nullptr;
+    if (Pa_OpenStream(&s, &params, nullptr, rate, FRAMES_PER_BUFFER, paClipOff, AudioCaptureCallback::run, this) != paNoError) return false;
+    stream = s;
+    forwarding = true; forwarder = std::thread(&AudioCapture::forwardLoop, this);
+    if (Pa_StartStream(s) != paNoError) { forwarding = false; forwarder.join(); Pa_CloseStream(s); return false; }
+    setCapturing(true); return true;
+}
+bool AudioCapture::stopCapture() {
+    if (!capturing) return false;
+    Pa_StopStream((PaStream*)stream); Pa_CloseStream((PaStream*)stream);
+    forwarding = false; if (forwarder.joinable()) forwarder.join(); // forwards what the last callbacks wrote
+    setCapturing(false); return true;
 }
-bool AudioCapture::stopCapture() { if (!capturing) return false; Pa_StopStream(stream); Pa_CloseStream(stream); capturing = false; return true; }
-bool AudioCapture::getAudioChunk(std::vector<float>& chunk, int max) {
-    std::unique_lock<std::mutex> lock(audioMutex);
-    audioCv.wait(lock, [this, max]{ return !capturing || audioBuffer.size() >= max; });
-    if (audioBuffer.empty()) return false;
-    int n = std::min((int)audioBuffer.size(), max);
-    chunk.assign(audioBuffer.begin(), audioBuffer.begin() + n); audioBuffer.erase(audioBuffer.begin(), audioBuffer.begin() + n);
-    return true;
+void AudioCapture::listDevices() {
+    Pa_Initialize();
+    PaDeviceIndex def = Pa_GetDefaultInputDevice();
+    for (int i = 0; i < Pa_GetDeviceCount(); ++i) {
+        const PaDeviceInfo* d = Pa_GetDeviceInfo(i); if (d->maxInputChannels <= 0) continue;
+        std::cout << (i == def ? "* " : "  ") << i << ": " << d->name << " (" << Pa_GetHostApiInfo(d->hostApi)->name << ", " << d->maxInputChannels
+                  << " ch, " << (int)d->defaultSampleRate << " Hz)" << std::endl;
+    }
+    Pa_Terminate();
 }
+#endif
@@ -0,0 +1,57 @@
+#include "AudioFile.h"
+#include "AudioSource.h"
+#include "AudioArchive.h"
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+bool decode_wav(const char* data, size_t size, std::vector<float>& out) {
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) return false;
+    uint16_t af = 0, nc = 0, bps = 0; uint32_t sr = 0; const char* pcm = nullptr; size_t ds = 0;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        std::string id(data + pos, 4); uint32_t chunk_sz; std::memcpy(&chunk_sz, data + pos + 4, 4); pos += 8;
+        if (id == "fmt " && chunk_sz >= 16 && pos + 16 <= size) {
+            std::memcpy(&af, data + pos, 2); std::memcpy(&nc, data + pos + 2, 2); std::memcpy(&sr, data + pos + 4, 4); std::memcpy(&bps, data + pos + 14, 2);
+        } else if (id == "data") {
+            pcm = data + pos; ds = std::min<size_t>(chunk_sz, size - pos); break;
+        }
+        pos += chunk_sz + (chunk_sz & 1);
+    }
+    if (sr == 0 || !pcm) return false;
+
+    std::vector<float> p_raw; size_t ns = ds / (std::max((int)nc, 1) * std::max((int)bps / 8, 1));
+    p_raw.reserve(ns);
+    for (size_t i = 0; i < ns; ++i) {
+        float s = 0; for (int c = 0; c < nc; ++c) {
+            size_t o = (i * nc + c) * (bps / 8);
+            if (bps == 16) { int16_t v; std::memcpy(&v, pcm + o, 2); s += v / 32768.0f; }
+            else if (bps == 32 && af == 3) { float v; std::memcpy(&v, pcm + o, 4); s += v; }
+        }
+        p_raw.push_back(s / std::max((int)nc, 1));
+    }
+
+    out.clear();
+    if (sr != SAMPLE_RATE) {
+        double r = (double)SAMPLE_RATE / sr; size_t n_new = p_raw.size() * r;
+        out.reserve(n_new);
+        for (size_t i = 0; i < n_new; ++i) {
+            double idx = i / r; size_t x1 = (size_t)idx, x2 = x1 + 1;
+            if (x2 >= p_raw.size()) out.push_back(p_raw[x1]);
+            else out.push_back(p_raw[x1] * (1.0 - (idx - x1)) + p_raw[x2] * (idx - x1));
+        }
+    } else out = std::move(p_raw);
+    return true;
+}
+
+bool load_audio_file(const std::string& path, std::vector<float>& out) {
+    if (is_audio_archive(path)) {
+        AudioArchiveReader reader;
+        return reader.open(path) && reader.sampleRate() == SAMPLE_RATE && reader.readAll(out);
+    }
+    std::ifstream file(path, std::ios::binary | std::ios::ate); if (!file.is_open()) return false;
+    std::vector<char> raw((size_t)file.tellg()); file.seekg(0);
+    if (!file.read(raw.data(), raw.size())) return false;
+    return decode_wav(raw.data(), raw.size(), out);
+}
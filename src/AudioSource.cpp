@@ -0,0 +1,98 @@
+#include "AudioSource.h"
+#include "AudioCapture.h"
+#include "PcmStreamSource.h"
+#include "MultiSource.h"
+#include "ReplaySource.h"
+#include "AudioArchive.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+bool AudioSource::getAudioChunk(std::vector<float>& chunk, int max) {
+    std::unique_lock<std::mutex> lock(audioMutex);
+    // Bounded, so a stalled writer (a paused bridge, an idle FIFO) cannot keep the caller from its stop checks.
+    if (!audioCv.wait_for(lock, std::chrono::milliseconds(100), [this, max]{ return !capturing || audioBuffer.size() >= (size_t)max; })) return false;
+    if (audioBuffer.empty()) return false;
+    int n = std::min((int)audioBuffer.size(), max);
+    chunk.assign(audioBuffer.begin(), audioBuffer.begin() + n); audioBuffer.erase(audioBuffer.begin(), audioBuffer.begin() + n);
+    return true;
+}
+
+size_t AudioSource::pendingSamples() { std::lock_guard<std::mutex> lock(audioMutex); return audioBuffer.size(); }
+
+void AudioSource::push(const float* samples, size_t n) {
+    if (auto* a = archive.load(std::memory_order_acquire)) a->push(samples, n);
+    std::lock_guard<std::mutex> lock(audioMutex);
+    audioBuffer.insert(audioBuffer.end(), samples, samples + n);
+    if (maxPending && audioBuffer.size() > maxPending) {
+        // Drop an extra eighth so a lagging consumer does not pay for a move of the whole queue on every push.
+        size_t drop = std::min(audioBuffer.size(), audioBuffer.size() - maxPending + maxPending / 8);
+        audioBuffer.erase(audioBuffer.begin(), audioBuffer.begin() + drop); dropped += drop;
+    }
+    audioCv.notify_one();
+}
+
+void AudioSource::setCapturing(bool on) {
+    std::lock_guard<std::mutex> lock(audioMutex);
+    capturing = on;
+    audioCv.notify_all();
+}
+
+std::unique_ptr<AudioSource> create_audio_source(const std::string& spec) {
+    if (spec.find('+') != std::string::npos) {
+        std::vector<MultiSource::Input> inputs; std::stringstream ss(spec); std::string part;
+        while (std::getline(ss, part, '+')) {
+            std::string label = inputs.empty() ? "local" : inputs.size() == 1 ? "remote" : "source" + std::to_string(inputs.size() + 1);
+            size_t eq = part.find('=');
+            if (eq != std::string::npos && eq < part.find_first_of(":,")) { label = part.substr(0, eq); part = part.substr(eq + 1); }
+            auto source = create_audio_source(part);
+            if (!source) return nullptr;
+            inputs.push_back({label, std::move(source)});
+        }
+        return std::make_unique<MultiSource>(std::move(inputs));
+    }
+    if (spec.rfind("replay:", 0) == 0) {
+        // replay:<file>[,speed=<factor>|max]
+        std::string file = spec.substr(7); double speed = 1;
+        size_t opt = file.rfind(",speed=");
+        if (opt != std::string::npos) {
+            std::string v = file.substr(opt + 7); file.erase(opt);
+            try { speed = v == "max" ? 0 : std::stod(v); } catch (const std::exception&) { speed = -1; }
+            if (speed < 0) { std::cerr << "Bad replay speed '" << v << "' (use a factor such as 1 or 8, or max)" << std::endl; return nullptr; }
+        }
+        return std::make_unique<ReplaySource>(file, speed);
+    }
+    if (spec.empty() || spec == "mic" || spec.rfind("mic:", 0) == 0) {
+#ifdef HAVE_PORTAUDIO
+        return std::make_unique<AudioCapture>(spec.size() > 4 ? spec.substr(4) : "");
+#else
+        std::cerr << "Built without PortAudio: use --input -, fifo:<path> or unix:<path> for live audio" << std::endl;
+        return nullptr;
+#endif
+    }
+    // <target>[,fmt=s16le|f32le][,rate=<hz>][,ch=<n>]
+    std::stringstream ss(spec); std::string target, opt; std::getline(ss, target, ',');
+    PcmDecoder::Format raw;
+    while (std::getline(ss, opt, ',')) {
+        size_t eq = opt.find('='); std::string k = opt.substr(0, eq), v = eq == std::string::npos ? "" : opt.substr(eq + 1);
+        try {
+            if (k == "fmt" && (v == "s16le" || v == "f32le")) raw.enc = v == "f32le" ? PcmDecoder::Encoding::F32LE : PcmDecoder::Encoding::S16LE;
+            else if (k == "rate" && std::stoi(v) > 0) raw.rate = std::stoi(v);
+            else if (k == "ch" && std::stoi(v) > 0) raw.channels = std::stoi(v);
+            else { std::cerr << "Unknown input option '" << opt << "'" << std::endl; return nullptr; }
+        } catch (const std::exception&) { std::cerr << "Bad input option '" << opt << "'" << std::endl; return nullptr; }
+    }
+    if (target != "-" && target != "stdin" && target.rfind("fifo:", 0) != 0 && target.rfind("unix:", 0) != 0) {
+        std::cerr << "Unknown input '" << target << "' (use mic, mic:<device>, -, fifo:<path> or unix:<path>)" << std::endl;
+        return nullptr;
+    }
+    return std::make_unique<PcmStreamSource>(target, raw);
+}
+
+void list_audio_devices() {
+#ifdef HAVE_PORTAUDIO
+    AudioCapture::listDevices();
+#else
+    std::cout << "Built without PortAudio: no capture devices." << std::endl;
+#endif
+}
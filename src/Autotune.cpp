@@ -0,0 +1,120 @@
+#include "Autotune.h"
+#include "Transcriber.h"
+#include "AudioSource.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <set>
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+namespace fs = std::filesystem;
+
+HardwareInfo detect_hardware() {
+    HardwareInfo hw;
+    hw.logical = std::max(1, (int)std::thread::hardware_concurrency());
+    hw.physical = hw.logical;
+#ifdef __APPLE__
+    int v = 0; size_t len = sizeof(v);
+    if (sysctlbyname("hw.physicalcpu", &v, &len, nullptr, 0) == 0 && v > 0) hw.physical = v;
+    len = sizeof(v);
+    if (sysctlbyname("hw.perflevel0.physicalcpu", &v, &len, nullptr, 0) == 0 && v > 0 && v < hw.physical) hw.performance = v;
+#else
+    // Count distinct (physical id, core id) pairs so SMT siblings are not counted twice.
+    std::ifstream f("/proc/cpuinfo"); std::string line; int phys = 0;
+    std::set<std::pair<int, int>> cores;
+    while (std::getline(f, line)) {
+        auto colon = line.find(':'); if (colon == std::string::npos) continue;
+        int val = std::atoi(line.c_str() + colon + 1);
+        if (line.compare(0, 11, "physical id") == 0) phys = val;
+        else if (line.compare(0, 7, "core id") == 0) cores.insert({phys, val});
+    }
+    if (!cores.empty()) hw.physical = std::min(hw.logical, (int)cores.size());
+#endif
+    return hw;
+}
+
+int default_threads(const Config::Data& config) {
+    if (config.n_threads > 0) return config.n_threads;
+    HardwareInfo hw = detect_hardware();
+    return std::max(1, std::min(8, hw.performance ? hw.performance : hw.physical));
+}
+
+ThreadTuner::ThreadTuner(int initial, int maxThreads, double seedRtf)
+    : n(std::max(1, std::min(initial, maxThreads))), minThreads(std::max(1, initial / 2)), maxThreads(std::max(1, maxThreads)), ewma(seedRtf) {}
+
+void ThreadTuner::record(double audio_sec, double proc_sec, double backlog_sec) {
+    if (audio_sec <= 0) return;
+    double r = proc_sec / audio_sec;
+    ewma = ewma > 0 ? 0.5 * ewma + 0.5 * r : r;
+    if ((ewma > HIGH_RTF || backlog_sec > MAX_BACKLOG_SEC) && n < maxThreads) {
+        n = std::min(maxThreads, n + std::max(1, n / 2));
+        settle = 3;
+    } else if (settle > 0) {
+        settle--;
+    } else if (ewma < LOW_RTF && backlog_sec < 0.5 && n > minThreads) {
+        n--; settle = 3;
+    }
+}
+
+std::vector<std::string> find_model_variants(const std::string& modelPath) {
+    std::vector<std::string> out{modelPath};
+    fs::path p(modelPath);
+    std::string base = p.stem().string();
+    size_t q = base.find("-q"); if (q != std::string::npos) base = base.substr(0, q);
+    std::error_code ec;
+    for (const auto& e : fs::directory_iterator(p.has_parent_path() ? p.parent_path() : fs::path("."), ec)) {
+        std::string stem = e.path().stem().string();
+        if (e.path().extension() != ".bin" || fs::equivalent(e.path(), p, ec)) continue;
+        if (stem == base || stem.compare(0, base.size() + 2, base + "-q") == 0) out.push_back(e.path().string());
+    }
+    return out;
+}
+
+std::vector<CalibrationResult> calibrate(const std::vector<std::string>& models, const std::vector<float>& audio, int maxThreads) {
+    std::vector<CalibrationResult> results;
+    const double audio_sec = audio.size() / (double)SAMPLE_RATE;
+    std::vector<int> sweep;
+    for (int t : {1, 2, 3, 4, 6, 8, 10, 12, 16, 24, 32}) if (t <= maxThreads) sweep.push_back(t);
+    if (sweep.empty() || sweep.back() != maxThreads) sweep.push_back(maxThreads);
+
+    for (const auto& model : models) {
+        Transcriber transcriber(model); // loads and warms up before timing starts
+        if (!transcriber.isLoaded()) continue;
+        std::error_code ec;
+        CalibrationResult best{model, (size_t)fs::file_size(model, ec), 0, 1e9};
+        int worse = 0;
+        std::cout << fs::path(model).filename().string() << "\n";
+        for (int t : sweep) {
+            // Best of two runs, to keep page-cache and frequency-scaling noise out of the comparison.
+            double secs = 1e9;
+            for (int run = 0; run < 2; ++run) {
+                auto t0 = std::chrono::steady_clock::now();
+                transcriber.transcribe(audio, t);
+                secs = std::min(secs, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+            }
+            double rtf = secs / audio_sec;
+            std::cout << "  " << std::setw(2) << t << " threads  RTF " << std::fixed << std::setprecision(3) << rtf << "\n";
+            // 3% margin: prefer fewer threads when the gain is within noise.
+            if (rtf < best.rtf * 0.97) { best.threads = t; best.rtf = rtf; worse = 0; }
+            else if (++worse >= 2) break; // past the knee; more threads only add contention
+        }
+        if (best.threads > 0) results.push_back(best);
+    }
+    return results;
+}
+
+const CalibrationResult* pick_calibration(const std::vector<CalibrationResult>& results) {
+    const CalibrationResult* pick = nullptr;
+    for (const auto& r : results)
+        if (r.rtf <= LIVE_RTF_TARGET && (!pick || r.model_bytes > pick->model_bytes)) pick = &r;
+    if (pick) return pick;
+    for (const auto& r : results) if (!pick || r.rtf < pick->rtf) pick = &r;
+    return pick;
+}
@@ -0,0 +1,249 @@
+#include "Bench.h"
+#include "Transcriber.h"
+#include "AudioSource.h"
+#include "AudioFile.h"
+#include "SpeechMap.h"
+#include "WindowCutter.h"
+#include "Autotune.h"
+#include "Reports.h"
+#include "Config.h"
+#include "Export.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <ctime>
+#include <numeric>
+#include <sys/resource.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Absolute for error rates, relative (0.15 = 15% worse) for the rest.
+struct Tolerances { double wer = 0.01, cer = 0.01, rtf = 0.15, latency = 0.25, rss = 0.10; };
+
+struct Run {
+    std::string hypothesis; double audio_sec = 0, proc_sec = 0;
+    std::vector<double> latencies_ms; // live only: segment end -> emitted
+};
+
+double peak_rss_mb() {
+    struct rusage ru{}; getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+    return ru.ru_maxrss / 1024.0;            // KiB
+#endif
+}
+
+double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(v.size() * p))];
+}
+
+std::string join_words(const std::vector<std::string>& w) {
+    std::string s; for (const auto& x : w) s += (s.empty() ? "" : " ") + x;
+    return s;
+}
+
+std::string append_text(std::string acc, const std::vector<TranscriptionSegment>& segs) {
+    for (auto s : segs) { trim(s.text); if (s.text.length() >= 2) acc += (acc.empty() ? "" : " ") + s.text; }
+    return acc;
+}
+
+Run run_file(Transcriber& transcriber, const Config::Data& config, const std::vector<float>& pcm, int threads) {
+    Run r; r.audio_sec = pcm.size() / (double)SAMPLE_RATE;
+    auto t0 = Clock::now();
+    std::vector<float> speech; SpeechMap map;
+    if (config.elide_silence) { SpeechMap::Options opt; opt.max_threshold = config.vad_threshold; map = SpeechMap::build(pcm, speech, opt); }
+    auto segs = transcriber.transcribe(speech.empty() ? pcm : speech, threads, "");
+    r.proc_sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.hypothesis = append_text("", segs);
+    return r;
+}
+
+// Replays the recording through the live windowing at full speed. Latency is measured on a virtual clock:
+// a window can start decoding when its audio has arrived and the previous window is done, so a model slower
+// than real time shows up as growing latency, just as the capture backlog would grow live.
+Run run_live(Transcriber& transcriber, const Config::Data& config, const std::vector<float>& pcm, int threads) {
+    Run r; r.audio_sec = pcm.size() / (double)SAMPLE_RATE;
+    WindowCutter window(config);
+    Transcriber::PromptState prompt; prompt.budget = config.prompt_tokens;
+    if (!config.vocabulary.empty()) prompt.vocabulary = transcriber.tokenize(" " + config.vocabulary);
+    double busy_until = 0; int64_t last_speech_ms = 0;
+    auto cut = [&](double now) {
+        if (window.hasSpeech()) {
+            double off = now - window.seconds();
+            if ((int64_t)(off * 1000) - last_speech_ms > config.prompt_reset_ms) prompt.history.clear();
+            last_speech_ms = (int64_t)(now * 1000);
+            auto t0 = Clock::now();
+            auto segs = transcriber.transcribe(window.samples(), threads, prompt);
+            double proc = std::chrono::duration<double>(Clock::now() - t0).count();
+            r.proc_sec += proc; busy_until = std::max(now, busy_until) + proc;
+            for (const auto& s : segs) r.latencies_ms.push_back(std::max(0.0, busy_until - (off + s.t1 / 100.0)) * 1000.0);
+            r.hypothesis = append_text(r.hypothesis, segs);
+        }
+        window.clear();
+    };
+    const size_t chunk = SAMPLE_RATE / 10;
+    for (size_t pos = 0; pos < pcm.size(); pos += chunk) {
+        std::vector<float> c(pcm.begin() + pos, pcm.begin() + std::min(pcm.size(), pos + chunk));
+        window.add(c);
+        if (window.due()) cut(std::min(pcm.size(), pos + chunk) / (double)SAMPLE_RATE);
+    }
+    if (!window.samples().empty()) cut(r.audio_sec);
+    return r;
+}
+
+bool parse_tolerances(const std::string& spec, Tolerances& t) {
+    std::stringstream ss(spec); std::string kv;
+    while (std::getline(ss, kv, ',')) {
+        auto eq = kv.find('=');
+        if (eq == std::string::npos) return false;
+        std::string k = kv.substr(0, eq); double v = std::atof(kv.c_str() + eq + 1);
+        if (k == "wer") t.wer = v; else if (k == "cer") t.cer = v; else if (k == "rtf") t.rtf = v;
+        else if (k == "latency") t.latency = v; else if (k == "rss") t.rss = v; else return false;
+    }
+    return true;
+}
+
+// Prints one line per metric and returns the number of regressions beyond tolerance.
+int compare(const json& base, const json& cur, const Tolerances& tol) {
+    struct Metric { const char* key; double tol; bool relative; };
+    const Metric metrics[] = {{"wer", tol.wer, false}, {"cer", tol.cer, false}, {"rtf", tol.rtf, true},
+                              {"latency_p95_ms", tol.latency, true}, {"peak_rss_mb", tol.rss, true}};
+    for (const char* k : {"model", "threads", "decoding"})
+        if (base.value(k, json()) != cur.value(k, json()))
+            std::cout << "Note: baseline " << k << " was " << base.value(k, json()).dump() << ", now " << cur.value(k, json()).dump() << "\n";
+    int regressions = 0;
+    for (auto it = cur["summary"].begin(); it != cur["summary"].end(); ++it) {
+        if (!base.contains("summary") || !base["summary"].contains(it.key())) { std::cout << it.key() << ": not in baseline\n"; continue; }
+        const json& b = base["summary"][it.key()];
+        for (const auto& m : metrics) {
+            if (!it.value().contains(m.key) || !b.contains(m.key)) continue;
+            double was = b[m.key], now = it.value()[m.key];
+            double limit = m.relative ? was * (1 + m.tol) : was + m.tol;
+            bool bad = now > limit && now - was > 1e-9;
+            regressions += bad;
+            std::cout << std::left << std::setw(6) << it.key() << std::setw(16) << m.key << std::right << std::fixed << std::setprecision(4)
+                      << std::setw(12) << was << " -> " << std::setw(12) << now << "  (limit " << limit << ")  "
+                      << (bad ? "\033[1;31mREGRESSED\033[0m" : now < was ? "\033[1;32mbetter\033[0m" : "ok") << "\n";
+        }
+    }
+    return regressions;
+}
+}
+
+int run_bench(int argc, char** argv) {
+    Config::Data config = Config::load();
+    std::string corpus, outPath = "bench_results.json", baselinePath, mode = "both";
+    bool updateBaseline = false; int threads = 0; Tolerances tol;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-m" && i + 1 < argc) config.model_path = argv[++i];
+        else if (arg == "--mode" && i + 1 < argc) mode = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc) baselinePath = argv[++i];
+        else if (arg == "--update-baseline") updateBaseline = true;
+        else if (arg == "--threads" && i + 1 < argc) threads = std::stoi(argv[++i]);
+        else if (arg == "--decoding" && i + 1 < argc) config.decoding = argv[++i];
+        else if (arg == "--vad-threshold" && i + 1 < argc) config.vad_threshold = std::stof(argv[++i]);
+        else if (arg == "--vad-silence-ms" && i + 1 < argc) config.vad_silence_ms = std::stoi(argv[++i]);
+        else if (arg == "--no-elide") config.elide_silence = false;
+        else if (arg == "--tolerance" && i + 1 < argc) { if (!parse_tolerances(argv[++i], tol)) { std::cerr << "--tolerance expects wer=,cer=,rtf=,latency=,rss=\n"; return 1; } }
+        else if (corpus.empty() && arg[0] != '-') corpus = arg;
+        else { corpus.clear(); break; }
+    }
+    if (corpus.empty() || (mode != "file" && mode != "live" && mode != "both")) {
+        std::cerr << "Usage: " << argv[0] << " bench <corpus dir> [-m model] [--mode file|live|both] [--threads n] [--out results.json]\n"
+                  << "       [--baseline baseline.json [--update-baseline]] [--tolerance wer=0.01,cer=0.01,rtf=0.15,latency=0.25,rss=0.1]\n"
+                  << "       [--decoding greedy|adaptive|beam] [--vad-threshold f] [--vad-silence-ms n] [--no-elide]\n";
+        return 1;
+    }
+
+    std::vector<fs::path> files; std::error_code ec;
+    for (const auto& e : fs::directory_iterator(corpus, ec)) {
+        std::string ext = e.path().extension().string();
+        if ((ext == ".wav" || ext == ".maa") && fs::exists(fs::path(e.path()).replace_extension(".txt"))) files.push_back(e.path());
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) { std::cerr << "No recordings with reference transcripts (<name>.wav + <name>.txt) in " << corpus << "\n"; return 1; }
+
+    if (threads <= 0) threads = default_threads(config);
+    Transcriber transcriber(config.model_path, 1, false, false);
+    if (!transcriber.isLoaded()) return 1;
+    transcriber.setDecodePolicy(Transcriber::decodePolicyFor(config));
+    std::cout << "Benchmarking " << fs::path(config.model_path).filename().string() << " on " << files.size() << " file(s), "
+              << threads << " CPU threads, " << config.decoding << " decoding\n";
+
+    json results = {{"model", fs::path(config.model_path).filename().string()}, {"threads", threads}, {"decoding", config.decoding},
+                    {"vad_threshold", config.vad_threshold}, {"vad_silence_ms", config.vad_silence_ms}, {"elide_silence", config.elide_silence},
+                    {"created", (int64_t)std::time(nullptr)}, {"files", json::array()}, {"summary", json::object()}};
+    std::vector<std::string> modes;
+    if (mode != "live") modes.push_back("file");
+    if (mode != "file") modes.push_back("live");
+
+    for (const auto& m : modes) {
+        size_t refWords = 0, wordErr = 0, refChars = 0, charErr = 0; double audio = 0, proc = 0; std::vector<double> lat;
+        for (const auto& path : files) {
+            std::vector<float> pcm;
+            if (!load_audio_file(path.string(), pcm)) { std::cerr << "Could not read " << path << "\n"; return 1; }
+            std::ifstream rf(fs::path(path).replace_extension(".txt")); std::stringstream ref; ref << rf.rdbuf();
+            Run r = m == "file" ? run_file(transcriber, config, pcm, threads) : run_live(transcriber, config, pcm, threads);
+
+            auto rw = normalize_words(ref.str()), hw = normalize_words(r.hypothesis);
+            std::string rs = join_words(rw), hs = join_words(hw);
+            size_t we = word_errors(rw, hw), ce = char_errors(rs, hs), rc = code_point_count(rs);
+            refWords += rw.size(); wordErr += we; refChars += rc; charErr += ce; audio += r.audio_sec; proc += r.proc_sec;
+            lat.insert(lat.end(), r.latencies_ms.begin(), r.latencies_ms.end());
+
+            json f = {{"name", path.filename().string()}, {"mode", m}, {"audio_sec", r.audio_sec}, {"proc_sec", r.proc_sec},
+                      {"rtf", r.audio_sec > 0 ? r.proc_sec / r.audio_sec : 0.0}, {"ref_words", rw.size()}, {"word_errors", we},
+                      {"wer", rw.empty() ? 0.0 : (double)we / rw.size()}, {"ref_chars", rc}, {"char_errors", ce},
+                      {"cer", rc ? (double)ce / rc : 0.0}, {"hypothesis", r.hypothesis}};
+            if (m == "live") f["latency_ms"] = {{"mean", r.latencies_ms.empty() ? 0.0 : std::accumulate(r.latencies_ms.begin(), r.latencies_ms.end(), 0.0) / r.latencies_ms.size()},
+                                                {"p95", percentile(r.latencies_ms, 0.95)}, {"max", percentile(r.latencies_ms, 1.0)}};
+            std::cout << std::left << std::setw(5) << m << std::setw(32) << path.filename().string() << std::right << std::fixed << std::setprecision(3)
+                      << " WER " << f["wer"].get<double>() << "  CER " << f["cer"].get<double>() << "  RTF " << f["rtf"].get<double>();
+            if (m == "live") std::cout << std::setprecision(0) << "  latency p95 " << f["latency_ms"]["p95"].get<double>() << " ms";
+            std::cout << std::endl;
+            results["files"].push_back(f);
+        }
+        json s = {{"files", files.size()}, {"audio_sec", audio}, {"proc_sec", proc}, {"rtf", audio > 0 ? proc / audio : 0.0},
+                  {"wer", refWords ? (double)wordErr / refWords : 0.0}, {"cer", refChars ? (double)charErr / refChars : 0.0},
+                  {"peak_rss_mb", peak_rss_mb()}}; // process high-water mark: includes the model and earlier modes
+        if (m == "live") { s["latency_mean_ms"] = lat.empty() ? 0.0 : std::accumulate(lat.begin(), lat.end(), 0.0) / lat.size(); s["latency_p95_ms"] = percentile(lat, 0.95); }
+        std::cout << std::fixed << std::setprecision(3) << m << " total: WER " << s["wer"].get<double>() << ", CER " << s["cer"].get<double>()
+                  << ", RTF " << s["rtf"].get<double>() << std::setprecision(0) << ", peak RSS " << s["peak_rss_mb"].get<double>() << " MB";
+        if (m == "live") std::cout << ", latency p95 " << s["latency_p95_ms"].get<double>() << " ms";
+        std::cout << std::endl;
+        results["summary"][m] = s;
+    }
+
+    // Hypotheses can end inside a UTF-8 sequence; the strict default would throw after the whole run.
+    const std::string out = results.dump(2, ' ', false, json::error_handler_t::replace) + "\n";
+    if (!write_file_atomic(outPath, out)) return 1;
+    std::cout << "Results: " << outPath << "\n";
+    if (baselinePath.empty()) return 0;
+    if (updateBaseline) {
+        if (!write_file_atomic(baselinePath, out)) return 1;
+        std::cout << "Baseline updated: " << baselinePath << "\n";
+        return 0;
+    }
+    std::ifstream bf(baselinePath);
+    if (!bf) { std::cout << "No baseline at " << baselinePath << " (create one with --update-baseline)\n"; return 0; }
+    json base;
+    try { base = json::parse(bf); } catch (const std::exception& e) { std::cerr << "Invalid baseline " << baselinePath << ": " << e.what() << "\n"; return 1; }
+    int regressions = compare(base, results, tol);
+    std::cout << (regressions ? "\033[1;31m" + std::to_string(regressions) + " regression(s) against the baseline\033[0m" : std::string("No regressions against the baseline")) << std::endl;
+    return regressions ? 1 : 0;
+}
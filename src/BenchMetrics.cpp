@@ -0,0 +1,52 @@
+#include "Bench.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+// Scoring half of the regression harness, apart from Bench.cpp so it builds without the model.
+namespace {
+template <typename T>
+size_t edit_distance(const std::vector<T>& a, const std::vector<T>& b) {
+    std::vector<size_t> prev(b.size() + 1), cur(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) prev[j] = j;
+    for (size_t i = 1; i <= a.size(); ++i) {
+        cur[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j)
+            cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+        std::swap(prev, cur);
+    }
+    return prev[b.size()];
+}
+
+std::vector<uint32_t> code_points(const std::string& s) {
+    std::vector<uint32_t> out; uint32_t cp = 0;
+    for (unsigned char c : s) {
+        if ((c & 0xC0) == 0x80) { cp = (cp << 6) | (c & 0x3F); if (!out.empty()) out.back() = cp; continue; }
+        cp = c < 0x80 ? c : c < 0xE0 ? (c & 0x1F) : c < 0xF0 ? (c & 0x0F) : (c & 0x07);
+        out.push_back(cp);
+    }
+    return out;
+}
+}
+
+std::vector<std::string> normalize_words(const std::string& text) {
+    std::vector<std::string> words; std::string w; int depth = 0;
+    auto flush = [&]{ if (!w.empty()) { words.push_back(w); w.clear(); } };
+    for (unsigned char c : text) {
+        if (c == '[' || c == '(' || c == '<') { depth++; flush(); continue; }
+        if (c == ']' || c == ')' || c == '>') { depth = std::max(0, depth - 1); continue; }
+        if (depth) continue;
+        if (std::isalnum(c) || c == '\'' || c >= 0x80) w += (char)std::tolower(c);
+        else flush();
+    }
+    flush();
+    for (auto& x : words) { while (!x.empty() && x.front() == '\'') x.erase(0, 1); while (!x.empty() && x.back() == '\'') x.pop_back(); }
+    words.erase(std::remove(words.begin(), words.end(), std::string()), words.end());
+    return words;
+}
+
+size_t word_errors(const std::vector<std::string>& ref, const std::vector<std::string>& hyp) { return edit_distance(ref, hyp); }
+
+size_t char_errors(const std::string& ref, const std::string& hyp) { return edit_distance(code_points(ref), code_points(hyp)); }
+
+size_t code_point_count(const std::string& s) { return code_points(s).size(); }
@@ -29,6 +29,7 @@ Config::Data Config::load() {
             if (j.contains("provider")) data.provider = j["provider"];
             if (j.contains("api_key")) data.api_key = j["api_key"];
             if (j.contains("llm_model")) data.llm_model = j["llm_model"];
+            if (j.contains("llm_base_url")) data.llm_base_url = j["llm_base_url"];
             if (j.contains("output_dir")) data.output_dir = j["output_dir"];
             if (j.contains("mode")) data.mode = j["mode"];
             if (j.contains("obsidian_vault_path")) data.obsidian_vault_path = j["obsidian_vault_path"];
@@ -38,8 +39,38 @@ Config::Data Config::load() {
             if (j.contains("github_repo")) data.github_repo = j["github_repo"];
             if (j.contains("gitlab_token")) data.gitlab_token = j["gitlab_token"];
             if (j.contains("gitlab_repo")) data.gitlab_repo = j["gitlab_repo"];
+            if (j.contains("github_api_url")) data.github_api_url = j["github_api_url"];
+            if (j.contains("gitlab_url")) data.gitlab_url = j["gitlab_url"];
             if (j.contains("vad_threshold")) data.vad_threshold = j["vad_threshold"];
             if (j.contains("vad_silence_ms")) data.vad_silence_ms = j["vad_silence_ms"];
+            if (j.contains("journal")) data.journal = j["journal"];
+            if (j.contains("journal_flush_ms")) data.journal_flush_ms = j["journal_flush_ms"];
+            if (j.contains("archive_audio")) data.archive_audio = j["archive_audio"];
+            if (j.contains("archive_codec")) data.archive_codec = j["archive_codec"];
+            if (j.contains("diarize")) data.diarize = j["diarize"];
+            if (j.contains("n_threads")) data.n_threads = j["n_threads"];
+            if (j.contains("calibrated_rtf")) data.calibrated_rtf = j["calibrated_rtf"];
+            if (j.contains("vocabulary")) data.vocabulary = j["vocabulary"];
+            if (j.contains("prompt_tokens")) data.prompt_tokens = j["prompt_tokens"];
+            if (j.contains("prompt_reset_ms")) data.prompt_reset_ms = j["prompt_reset_ms"];
+            if (j.contains("report_mode")) data.report_mode = j["report_mode"];
+            if (j.contains("llm_concurrency")) data.llm_concurrency = j["llm_concurrency"];
+            if (j.contains("export_formats")) data.export_formats = j["export_formats"];
+            if (j.contains("decoding")) data.decoding = j["decoding"];
+            if (j.contains("refine_model")) data.refine_model = j["refine_model"];
+            if (j.contains("refine_queue_sec")) data.refine_queue_sec = j["refine_queue_sec"];
+            if (j.contains("min_confidence")) data.min_confidence = j["min_confidence"];
+            if (j.contains("elide_silence")) data.elide_silence = j["elide_silence"];
+            if (j.contains("cpu_profile")) data.cpu_profile = j["cpu_profile"];
+            if (j.contains("cpu_share")) data.cpu_share = j["cpu_share"];
+            if (j.contains("pin_audio_core")) data.pin_audio_core = j["pin_audio_core"];
+            if (j.contains("stream")) data.stream = j["stream"];
+            if (j.contains("audio_input")) data.audio_input = j["audio_input"];
+            if (j.contains("audio_mix")) data.audio_mix = j["audio_mix"];
+            if (j.contains("watch_dir")) data.watch_dir = j["watch_dir"];
+            if (j.contains("watch_settle_ms")) data.watch_settle_ms = j["watch_settle_ms"];
+            if (j.contains("serve_path_root")) data.serve_path_root = j["serve_path_root"];
+            if (j.contains("memory_budget_mb")) data.memory_budget_mb = j["memory_budget_mb"];
         } catch (const std::exception& e) {
             std::cerr << "Error reading config: " << e.what() << std::endl;
         }
@@ -53,6 +84,7 @@ void Config::save(const Data& data) {
     j["provider"] = data.provider;
     j["api_key"] = data.api_key;
     j["llm_model"] = data.llm_model;
+    j["llm_base_url"] = data.llm_base_url;
     j["output_dir"] = data.output_dir;
     j["mode"] = data.mode;
     j["obsidian_vault_path"] = data.obsidian_vault_path;
@@ -62,8 +94,38 @@ void Config::save(const Data& data) {
     j["github_repo"] = data.github_repo;
     j["gitlab_token"] = data.gitlab_token;
     j["gitlab_repo"] = data.gitlab_repo;
+    j["github_api_url"] = data.github_api_url;
+    j["gitlab_url"] = data.gitlab_url;
     j["vad_threshold"] = data.vad_threshold;
     j["vad_silence_ms"] = data.vad_silence_ms;
+    j["journal"] = data.journal;
+    j["journal_flush_ms"] = data.journal_flush_ms;
+    j["archive_audio"] = data.archive_audio;
+    j["archive_codec"] = data.archive_codec;
+    j["diarize"] = data.diarize;
+    j["n_threads"] = data.n_threads;
+    j["calibrated_rtf"] = data.calibrated_rtf;
+    j["vocabulary"] = data.vocabulary;
+    j["prompt_tokens"] = data.prompt_tokens;
+    j["prompt_reset_ms"] = data.prompt_reset_ms;
+    j["report_mode"] = data.report_mode;
+    j["llm_concurrency"] = data.llm_concurrency;
+    j["export_formats"] = data.export_formats;
+    j["decoding"] = data.decoding;
+    j["refine_model"] = data.refine_model;
+    j["refine_queue_sec"] = data.refine_queue_sec;
+    j["min_confidence"] = data.min_confidence;
+    j["elide_silence"] = data.elide_silence;
+    j["cpu_profile"] = data.cpu_profile;
+    j["cpu_share"] = data.cpu_share;
+    j["pin_audio_core"] = data.pin_audio_core;
+    j["stream"] = data.stream;
+    j["audio_input"] = data.audio_input;
+    j["audio_mix"] = data.audio_mix;
+    j["watch_dir"] = data.watch_dir;
+    j["watch_settle_ms"] = data.watch_settle_ms;
+    j["serve_path_root"] = data.serve_path_root;
+    j["memory_budget_mb"] = data.memory_budget_mb;
 
     std::string path = getConfigPath();
     std::ofstream f(path);
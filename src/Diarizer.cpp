@@ -0,0 +1,160 @@
+#include "Diarizer.h"
+#include "AudioSource.h"
+#include <cmath>
+#include <complex>
+#include <algorithm>
+
+namespace {
+const int FRAME = 512;        // 32 ms at 16 kHz
+const int HOP = 320;          // 20 ms
+const float TURN_THRESHOLD = 0.35f;
+const float NO_TURN_THRESHOLD = 0.6f;
+
+void fft(std::vector<std::complex<float>>& a) {
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        float ang = -2.0f * (float)M_PI / len;
+        std::complex<float> wl(std::cos(ang), std::sin(ang));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<float> w(1);
+            for (size_t k = 0; k < len / 2; ++k) {
+                auto u = a[i + k], v = a[i + k + len / 2] * w;
+                a[i + k] = u + v; a[i + k + len / 2] = u - v; w *= wl;
+            }
+        }
+    }
+}
+
+float hz_to_mel(float f) { return 2595.0f * std::log10(1.0f + f / 700.0f); }
+
+// Autocorrelation pitch estimate in 70-400 Hz; returns 0 for unvoiced frames.
+float frame_pitch(const float* x, int n) {
+    int lo = SAMPLE_RATE / 400, hi = SAMPLE_RATE / 70;
+    double e0 = 0; for (int i = 0; i < n; ++i) e0 += x[i] * x[i];
+    if (e0 <= 0) return 0;
+    double best = 0; int lag = 0;
+    for (int l = lo; l <= hi && l < n; ++l) {
+        double r = 0; for (int i = 0; i + l < n; ++i) r += x[i] * x[i + l];
+        if (r > best) { best = r; lag = l; }
+    }
+    return (lag && best / e0 > 0.3) ? (float)SAMPLE_RATE / lag : 0.0f;
+}
+}
+
+Diarizer::Diarizer(bool modelEmitsTurns, int maxSpeakers) : emitsTurns(modelEmitsTurns), maxSpeakers(std::max(1, maxSpeakers)) {}
+
+bool Diarizer::modelSupportsTurns(const std::string& modelPath) {
+    return modelPath.find("tdrz") != std::string::npos;
+}
+
+bool Diarizer::enabledFor(const Config::Data& config) {
+    return config.diarize == "on" || (config.diarize == "auto" && modelSupportsTurns(config.model_path));
+}
+
+Diarizer::Profile Diarizer::profile(const float* pcm, size_t n) const {
+    // Mel filterbank edges over 100-4000 Hz, where most speaker-specific spectral shape lives.
+    static const std::vector<int> edges = [] {
+        std::vector<int> e;
+        float lo = hz_to_mel(100), hi = hz_to_mel(4000);
+        for (int i = 0; i < N_BANDS + 2; ++i) {
+            float mel = lo + (hi - lo) * i / (N_BANDS + 1);
+            float hz = 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
+            e.push_back(std::min(FRAME / 2, (int)std::lround(hz * FRAME / SAMPLE_RATE)));
+        }
+        return e;
+    }();
+
+    Profile p; p.v.assign(N_BANDS + 1, 0.0f);
+    std::vector<std::complex<float>> buf(FRAME);
+    std::vector<float> pitches;
+    int frames = 0;
+    std::vector<float> energies;
+    for (size_t off = 0; off + FRAME <= n; off += HOP) {
+        double e = 0; for (int i = 0; i < FRAME; ++i) e += pcm[off + i] * pcm[off + i];
+        energies.push_back((float)e);
+    }
+    if (energies.empty()) return p;
+    // Only the louder half of the frames carries voice; skip pauses and breaths.
+    std::vector<float> sorted = energies;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    float gate = std::max(sorted[sorted.size() / 2], 1e-6f);
+
+    for (size_t f = 0; f < energies.size(); ++f) {
+        if (energies[f] < gate) continue;
+        const float* x = pcm + f * HOP;
+        for (int i = 0; i < FRAME; ++i) buf[i] = x[i] * (0.5f - 0.5f * std::cos(2.0f * (float)M_PI * i / (FRAME - 1)));
+        fft(buf);
+        for (int b = 0; b < N_BANDS; ++b) {
+            double s = 0;
+            for (int k = edges[b]; k < edges[b + 2]; ++k) s += std::norm(buf[k]);
+            p.v[b] += (float)std::log(s + 1e-9);
+        }
+        float f0 = frame_pitch(x, FRAME);
+        if (f0 > 0) pitches.push_back(f0);
+        frames++;
+    }
+    if (!frames) return p;
+    float mean = 0;
+    for (int b = 0; b < N_BANDS; ++b) { p.v[b] /= frames; mean += p.v[b]; }
+    mean /= N_BANDS;
+    for (int b = 0; b < N_BANDS; ++b) p.v[b] -= mean; // spectral shape only, independent of loudness
+    if (!pitches.empty()) {
+        std::nth_element(pitches.begin(), pitches.begin() + pitches.size() / 2, pitches.end());
+        p.v[N_BANDS] = 4.0f * std::log2(pitches[pitches.size() / 2] / 150.0f);
+    }
+    p.weight = (float)frames;
+    return p;
+}
+
+float Diarizer::distance(const std::vector<float>& a, const std::vector<float>& b) {
+    double dot = 0, na = 0, nb = 0;
+    for (size_t i = 0; i < a.size(); ++i) { dot += a[i] * b[i]; na += a[i] * a[i]; nb += b[i] * b[i]; }
+    if (na <= 0 || nb <= 0) return 1.0f;
+    return (float)(1.0 - dot / std::sqrt(na * nb));
+}
+
+void Diarizer::assign(std::vector<TranscriptionSegment>& segments, const std::vector<float>& pcm) {
+    const float threshold = emitsTurns ? TURN_THRESHOLD : NO_TURN_THRESHOLD;
+    size_t i = 0;
+    while (i < segments.size()) {
+        // A turn spans consecutive segments until one is flagged with a speaker change after it.
+        size_t j = i;
+        if (emitsTurns) while (j + 1 < segments.size() && !segments[j].speaker_turn) ++j;
+        size_t s0 = std::min(pcm.size(), (size_t)std::max<int64_t>(0, segments[i].t0) * SAMPLE_RATE / 100);
+        size_t s1 = std::min(pcm.size(), (size_t)std::max<int64_t>(0, segments[j].t1) * SAMPLE_RATE / 100);
+        Profile p = profile(pcm.data() + s0, s1 > s0 ? s1 - s0 : 0);
+
+        int speaker = current;
+        bool keepCurrent = current >= 0 && (emitsTurns ? !pendingTurn : distance(p.v, centroids[current].v) < threshold);
+        if (p.weight > 0 && !keepCurrent) {
+            int best = -1, second = -1; float bd = 2, sd = 2;
+            for (int c = 0; c < (int)centroids.size(); ++c) {
+                float d = distance(p.v, centroids[c].v);
+                if (d < bd) { second = best; sd = bd; best = c; bd = d; }
+                else if (d < sd) { second = c; sd = d; }
+            }
+            // tinydiarize says the speaker changed, so prefer anyone but the current speaker.
+            if (emitsTurns && best == current && current >= 0) { best = second; bd = sd; }
+            if (best >= 0 && (bd < threshold || (int)centroids.size() >= maxSpeakers)) speaker = best;
+            else { centroids.push_back(Profile{std::vector<float>(p.v.size(), 0.0f), 0}); speaker = (int)centroids.size() - 1; }
+        }
+        if (speaker < 0) { centroids.push_back(Profile{std::vector<float>(N_BANDS + 1, 0.0f), 0}); speaker = 0; }
+
+        if (p.weight > 0) {
+            auto& c = centroids[speaker];
+            float w = std::min(c.weight, 2000.0f); // cap so centroids keep adapting over long sessions
+            for (size_t k = 0; k < c.v.size(); ++k) c.v[k] = (c.v[k] * w + p.v[k] * p.weight) / (w + p.weight);
+            c.weight = w + p.weight;
+        }
+        for (size_t k = i; k <= j; ++k) segments[k].speaker_id = speaker;
+        current = speaker;
+        pendingTurn = emitsTurns && segments[j].speaker_turn;
+        i = j + 1;
+    }
+}
@@ -0,0 +1,145 @@
+#include "Export.h"
+#include "Reports.h"
+#include "Scheduler.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+const std::string& MeetingReport::get(const std::string& name) const {
+    static const std::string empty;
+    auto it = sections.find(name);
+    return it == sections.end() ? empty : it->second;
+}
+
+std::string MeetingReport::path(const std::string& suffix) const { return outputDir + "/" + fileBase + suffix; }
+
+bool write_file_atomic(const std::string& path, const std::string& data) {
+    std::string tmp = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { std::cerr << "Cannot write " << path << std::endl; return false; }
+    const char* p = data.data(); size_t left = data.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) { ::close(fd); ::unlink(tmp.c_str()); std::cerr << "Cannot write " << path << std::endl; return false; }
+        p += n; left -= (size_t)n;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) { ::unlink(tmp.c_str()); std::cerr << "Cannot write " << path << std::endl; return false; }
+    return true;
+}
+
+bool MarkdownWriter::write(const MeetingReport& r) {
+    const std::string& graph = r.get("MERMAID_GRAPH");
+    std::stringstream note;
+    note << "---\ndate: " << r.date << "\ntype: meeting\ntopic: " << r.get("TOPIC") << "\nparticipants: [" << r.get("PARTICIPANTS") << "]\ntags: [" << r.get("TAGS") << "]\nsummary: " << r.get("YAML_SUMMARY") << "\n---\n\n";
+    note << "Status:: #processed\n\n> [!ABSTRACT] Summary\n> " << r.get("OVERVIEW_SUMMARY") << "\n\n> [!IMPORTANT] Takeaways\n" << r.get("KEY_TAKEAWAYS") << "\n\n";
+    if (!r.research.empty()) note << "> [!INFO] Research\n" << r.research << "\n\n";
+    if (!graph.empty() && graph.length() > 10) note << "## Map\n```mermaid\n" << graph << "\n```\n\n";
+    note << "## Meeting Details\n\n### Agenda\n" << r.get("AGENDA_ITEMS") << "\n\n### Discussion\n" << r.get("DISCUSSION_POINTS") << "\n\n### Questions\n" << r.get("QUESTIONS_ARISEN")
+         << "\n\n## Outcomes\n\n### Decisions\n" << r.get("DECISIONS_MADE") << "\n\n### Action Items\n" << r.get("ACTION_ITEMS")
+         << "\n\n## Appendix\n<details><summary>Transcript</summary>\n\n```\n" << r.transcription << "\n```\n</details>\n";
+    return write_file_atomic(r.path(".md"), note.str());
+}
+
+bool HtmlWriter::write(const MeetingReport& r) {
+    const std::string &p = r.get("PARTICIPANTS"), &real_os = r.get("OVERVIEW_SUMMARY"), &kt = r.get("KEY_TAKEAWAYS"), &ai = r.get("AGENDA_ITEMS"), &dp = r.get("DISCUSSION_POINTS");
+    const std::string &qa = r.get("QUESTIONS_ARISEN"), &dm = r.get("DECISIONS_MADE"), &acts = r.get("ACTION_ITEMS");
+    std::stringstream html;
+    html << "<!DOCTYPE html><html lang='en'><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width, initial-scale=1.0'><title>" << r.title << "</title>"
+         << "<link rel='preconnect' href='https://fonts.googleapis.com'><link rel='preconnect' href='https://fonts.gstatic.com' crossorigin>"
+         << "<link href='https://fonts.googleapis.com/css2?family=Inter:wght@400;500;600&family=Plus+Jakarta+Sans:wght@700;800&display=swap' rel='stylesheet'><style>"
+         << ":root{--bg:#f8fafc;--sidebar:#ffffff;--primary:#0f172a;--accent:#6366f1;--text:#1e293b;--text-muted:#64748b;--border:#e2e8f0;--card-bg:#ffffff;--indigo-soft:#eef2ff;--emerald-soft:#ecfdf5;--amber-soft:#fffbeb}"
+         << "*{box-sizing:border-box} body{font-family:'Inter',sans-serif;background:var(--bg);color:var(--text);margin:0;display:flex;min-height:100vh;overflow-x:hidden}"
+         << "aside{width:260px;background:var(--sidebar);border-right:1px solid var(--border);padding:40px 24px;position:sticky;top:0;height:100vh;display:flex;flex-direction:column;flex-shrink:0}"
+         << "main{flex:1;padding:60px 80px;max-width:1100px;margin:0 auto} "
+         << ".logo{font-family:'Plus Jakarta Sans',sans-serif;font-weight:800;font-size:0.9rem;letter-spacing:0.1em;color:var(--primary);margin-bottom:48px;text-transform:uppercase}"
+         << ".nav-link{display:block;padding:10px 0;color:var(--text-muted);text-decoration:none;font-size:0.95rem;font-weight:500;transition:0.2s} .nav-link:hover{color:var(--accent)} .nav-link.active{color:var(--primary);font-weight:700}"
+         << ".section-header{font-family:'Plus Jakarta Sans',sans-serif;font-size:0.75rem;font-weight:700;color:var(--text-muted);text-transform:uppercase;letter-spacing:0.05em;margin:32px 0 12px 0}"
+         << "h1{font-family:'Plus Jakarta Sans',sans-serif;font-size:2.75rem;font-weight:800;letter-spacing:-0.03em;margin:0 0 16px 0;color:var(--primary)} "
+         << ".meta-bar{display:flex;flex-wrap:wrap;gap:24px;color:var(--text-muted);font-size:0.9rem;margin-bottom:48px;border-bottom:1px solid var(--border);padding-bottom:24px}"
+         << ".card{background:var(--card-bg);border-radius:12px;border:1px solid var(--border);padding:32px;margin-bottom:32px;transition:box-shadow 0.3s} .card:hover{box-shadow:0 10px 15px -3px rgba(0,0,0,0.05)}"
+         << ".callout{padding:24px;border-radius:8px;margin:24px 0;border-left:4px solid #dee2e6}"
+         << ".abstract{background:var(--indigo-soft);border-left-color:var(--accent)} .important{background:var(--amber-soft);border-left-color:#f59e0b} .info{background:var(--emerald-soft);border-left-color:#10b981}"
+         << "h2{font-family:'Plus Jakarta Sans',sans-serif;font-size:1.5rem;font-weight:700;margin:0 0 20px 0;color:var(--primary);display:flex;align-items:center;gap:12px} h3{font-family:'Plus Jakarta Sans',sans-serif;font-size:1.1rem;font-weight:700;margin:32px 0 12px 0;color:var(--text)}"
+         << "ul{padding-left:20px;margin:0} li{margin-bottom:10px} li::marker{color:var(--text-muted)}"
+         << "pre{background:#0f172a;color:#cbd5e1;padding:24px;border-radius:8px;overflow-x:auto;font-family:'JetBrains Mono','Fira Code',monospace;font-size:0.85rem;line-height:1.7}"
+         << "details{margin-top:24px} summary{cursor:pointer;color:var(--accent);font-weight:600;font-size:0.9rem;user-select:none;outline:none}"
+         << "@media(max-width:900px){body{flex-direction:column} aside{width:100%;height:auto;position:static;padding:24px;border-right:none;border-bottom:1px solid var(--border)} main{padding:40px 24px}}"
+         << "</style></head><body>"
+         << "<aside><div class='logo'>Meeting Assistant</div>"
+         << "<div class='section-header'>Analysis</div>"
+         << "<a href='#summary' class='nav-link active'>Overview</a><a href='#details' class='nav-link'>Key Details</a>"
+         << "<div class='section-header'>Output</div>"
+         << "<a href='#outcomes' class='nav-link'>Outcomes</a><a href='#transcript' class='nav-link'>Transcription</a></aside>"
+         << "<main><section id='summary'><h1>" << r.title << "</h1>"
+         << "<div class='meta-bar'><span>Date: " << r.date << "</span><span>Participants: " << p << "</span><span style='margin-left:auto'>Persona: <strong>" << r.persona << "</strong></span></div>"
+         << "<div class='callout abstract'><h2>Summary</h2><p>" << real_os << "</p></div>"
+         << "<div class='callout important'><h2>Key Takeaways</h2>" << md_to_html(kt) << "</div>";
+
+    if (!r.research.empty()) html << "<div class='callout info'><h2>AI Research & Context</h2>" << md_to_html(r.research) << "</div>";
+
+    html << "</section><section id='details' class='card'><h2>Meeting Details</h2><h3>Agenda</h3>" << md_to_html(ai) << "<h3>Discussion Points</h3>" << md_to_html(dp);
+    if (!qa.empty()) html << "<h3>Questions Arisen</h3>" << md_to_html(qa);
+
+    html << "</section><section id='outcomes' class='card'><h2>Outcomes & Actions</h2><h3>Decisions</h3>" << md_to_html(dm) << "<h3>Action Items</h3>" << md_to_html(acts) << "</section>";
+
+    html << "<section id='transcript' class='card'><h2>Raw Transcript</h2><details><summary>Expand full transcription log</summary><pre style='margin-top:20px'>" << r.transcription << "</pre></details></section></main></body></html>";
+    return write_file_atomic(r.path(".html"), html.str());
+}
+
+bool EmailWriter::write(const MeetingReport& r) {
+    const std::string& email = r.get("EMAIL_DRAFT");
+    return email.empty() || write_file_atomic(r.path("_email.txt"), email);
+}
+
+bool JsonWriter::write(const MeetingReport& r) {
+    nlohmann::json j = {{"title", r.title}, {"date", r.date}, {"persona", r.persona}, {"meeting", r.baseName}, {"sections", r.sections}, {"research", r.research}, {"transcript", r.transcription}};
+    // The transcript can end inside a UTF-8 sequence split by whisper; the strict default would throw.
+    return write_file_atomic(r.path(".json"), j.dump(2, ' ', false, nlohmann::json::error_handler_t::replace));
+}
+
+bool IssueSyncWriter::write(const MeetingReport& r) {
+    sync_action_items(r.get("ACTION_ITEMS"), config, r.title);
+    return true;
+}
+
+std::vector<std::unique_ptr<ReportWriter>> create_writers(const Config::Data& config) {
+    std::vector<std::unique_ptr<ReportWriter>> writers;
+    std::stringstream ss(config.export_formats); std::string f;
+    while (std::getline(ss, f, ',')) {
+        trim(f);
+        if (f == "md") writers.push_back(std::make_unique<MarkdownWriter>());
+        else if (f == "html") writers.push_back(std::make_unique<HtmlWriter>());
+        else if (f == "email") writers.push_back(std::make_unique<EmailWriter>());
+        else if (f == "json") writers.push_back(std::make_unique<JsonWriter>());
+        else if (!f.empty()) std::cerr << "Unknown export format: " << f << std::endl;
+    }
+    if (!config.github_token.empty() || !config.gitlab_token.empty()) writers.push_back(std::make_unique<IssueSyncWriter>(config));
+    return writers;
+}
+
+std::vector<ExportTiming> run_exports(const MeetingReport& report, const std::vector<std::unique_ptr<ReportWriter>>& writers) {
+    std::vector<ExportTiming> timings(writers.size());
+    std::vector<Scheduler::Future<void>> pool;
+    for (size_t i = 0; i < writers.size(); ++i) {
+        pool.push_back(Scheduler::shared().submit(Scheduler::Lane::Render, [&, i] {
+            auto t0 = std::chrono::steady_clock::now(); bool ok = false;
+            try { ok = writers[i]->write(report); }
+            catch (const std::exception& e) { std::cerr << writers[i]->name() << " export failed: " << e.what() << std::endl; }
+            timings[i] = {writers[i]->name(), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count(), ok};
+        }));
+    }
+    // Every task uses timings, report and writers by reference: all must be done before anything can unwind.
+    for (auto& f : pool) f.wait();
+    for (auto& f : pool) f.get();
+    return timings;
+}
@@ -0,0 +1,181 @@
+#include "Governor.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <pthread.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#ifdef __APPLE__
+#include <pthread/qos.h>
+#endif
+
+namespace fs = std::filesystem;
+
+std::atomic<int> ResourceGovernor::audioCore{-1};
+
+namespace {
+const double ESCALATE_BACKLOG_SEC = 4.0, CALM_BACKLOG_SEC = 1.0;
+
+#ifdef __linux__
+// Linux keeps nice values per thread; setpriority() on a TID changes only that thread.
+void set_nice(int nice) { setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice); }
+#endif
+}
+
+ResourceGovernor::ResourceGovernor(const Config::Data& config, int logicalCores, bool measureJitter)
+    : mode(config.cpu_profile), share(std::min(1.0, std::max(0.1, (double)config.cpu_share))), pinAudio(config.pin_audio_core),
+      logical(std::max(1, logicalCores)), battery(detectBattery()), current(config.cpu_profile == "realtime" ? Profile::Realtime : Profile::Background) {
+    audioCore = pinAudio && logical > 1 ? 0 : -1;
+    if (measureJitter) {
+        jitterIdle.assign(JITTER_BUCKETS, 0); jitterBusy.assign(JITTER_BUCKETS, 0);
+        probing = true; probe = std::thread([this]{ probeLoop(); });
+    }
+}
+
+ResourceGovernor::~ResourceGovernor() {
+    probing = false;
+    if (probe.joinable()) probe.join();
+}
+
+int ResourceGovernor::threads(int suggested) const {
+    int n = std::max(1, suggested);
+    if (current == Profile::Background) {
+        int cap = std::max(1, (int)(logical * share));
+        if (battery) cap = std::max(1, cap / 2);
+        n = std::min(n, cap);
+    }
+    lastThreads = n;
+    return n;
+}
+
+void ResourceGovernor::run(const std::function<void()>& fn, int threads) { run(fn, threads, current); }
+
+void ResourceGovernor::run(const std::function<void()>& fn, int threads, Profile p) {
+    auto reservation = Scheduler::shared().reserve(threads);
+    inferring++;
+    std::thread worker([&]{ applyProfile(p); fn(); });
+    worker.join();
+    inferring--;
+}
+
+void ResourceGovernor::record(double audio_sec, double proc_sec, double backlog_sec) {
+    ProfileStats& st = current == Profile::Realtime ? realtimeStats : backgroundStats;
+    st.windows++; st.audio_sec += audio_sec; st.proc_sec += proc_sec;
+    if (mode != "auto" || audio_sec <= 0) return;
+    double rtf = proc_sec / audio_sec;
+    if (current == Profile::Background) {
+        if (backlog_sec > ESCALATE_BACKLOG_SEC || rtf > 1.0) { current = Profile::Realtime; calmWindows = 0; }
+    } else if (backlog_sec < CALM_BACKLOG_SEC && rtf < 0.5) {
+        if (++calmWindows >= 3) current = Profile::Background;
+    } else calmWindows = 0;
+}
+
+void ResourceGovernor::applyProfile(Profile p) const {
+#ifdef __linux__
+    if (p == Profile::Background) {
+        struct sched_param sp{};
+        if (sched_setscheduler(0, SCHED_IDLE, &sp) != 0) set_nice(10);
+    } else set_nice(0); // undoes an elevated capture thread's nice value inherited at spawn
+    if (audioCore >= 0) {
+        cpu_set_t set; CPU_ZERO(&set);
+        for (int c = 0; c < logical; ++c) if (c != audioCore) CPU_SET(c, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#elif defined(__APPLE__)
+    // QoS is inherited by threads created from this one; background QoS also prefers the efficiency cores.
+    pthread_set_qos_class_self_np(p == Profile::Realtime ? QOS_CLASS_USER_INITIATED : battery ? QOS_CLASS_BACKGROUND : QOS_CLASS_UTILITY, 0);
+#endif
+}
+
+void ResourceGovernor::elevateCurrentThread() {
+#ifdef __linux__
+    set_nice(-5); // needs CAP_SYS_NICE or an RLIMIT_NICE allowance; best effort
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+#endif
+}
+
+void ResourceGovernor::prepareAudioThread() {
+#ifdef __linux__
+    // PortAudio's ALSA/JACK thread may already be real-time; only raise it when it is not.
+    int policy; struct sched_param sp{};
+    if (pthread_getschedparam(pthread_self(), &policy, &sp) == 0 && policy == SCHED_OTHER) {
+        sp.sched_priority = 10;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0) elevateCurrentThread();
+    }
+    if (audioCore >= 0) {
+        cpu_set_t set; CPU_ZERO(&set); CPU_SET(audioCore.load(), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+    // macOS: the CoreAudio IO thread is already time-constrained.
+}
+
+bool ResourceGovernor::detectBattery() {
+#ifdef __APPLE__
+    FILE* p = popen("pmset -g ps 2>/dev/null", "r"); if (!p) return false;
+    char buf[256]; bool onBattery = false;
+    while (fgets(buf, sizeof(buf), p)) if (std::string(buf).find("Battery Power") != std::string::npos) onBattery = true;
+    pclose(p);
+    return onBattery;
+#else
+    std::error_code ec; bool hasBattery = false;
+    for (const auto& e : fs::directory_iterator("/sys/class/power_supply", ec)) {
+        std::ifstream tf(e.path() / "type"); std::string type; tf >> type;
+        if (type == "Mains") { std::ifstream of(e.path() / "online"); int online = 0; of >> online; if (online) return false; }
+        else if (type == "Battery") hasBattery = true;
+    }
+    return hasBattery;
+#endif
+}
+
+void ResourceGovernor::probeLoop() {
+    const auto period = std::chrono::milliseconds(5);
+    while (probing) {
+        auto target = std::chrono::steady_clock::now() + period;
+        std::this_thread::sleep_until(target);
+        double late = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - target).count();
+        int b = std::min(JITTER_BUCKETS - 1, std::max(0, (int)(late * 10)));
+        std::lock_guard<std::mutex> lock(jitterMutex);
+        (inferring > 0 ? jitterBusy : jitterIdle)[b]++;
+    }
+}
+
+ResourceGovernor::Jitter ResourceGovernor::jitter(bool duringInference) const {
+    std::lock_guard<std::mutex> lock(jitterMutex);
+    const auto& h = duringInference ? jitterBusy : jitterIdle;
+    Jitter j; for (long c : h) j.samples += c;
+    if (j.samples == 0) return j;
+    long seen = 0;
+    for (int b = 0; b < (int)h.size(); ++b) {
+        if (!h[b]) continue;
+        if (seen < j.samples / 2 && seen + h[b] >= j.samples / 2) j.p50_ms = b / 10.0;
+        if (seen < j.samples * 99 / 100 && seen + h[b] >= j.samples * 99 / 100) j.p99_ms = b / 10.0;
+        seen += h[b]; j.max_ms = b / 10.0;
+    }
+    return j;
+}
+
+std::string ResourceGovernor::summary() const {
+    std::stringstream ss; ss << std::fixed << std::setprecision(2);
+    ss << "CPU governor (" << mode << (battery ? ", on battery" : "") << "):";
+    for (Profile p : {Profile::Background, Profile::Realtime}) {
+        ProfileStats s = stats(p); if (!s.windows) continue;
+        ss << " " << (p == Profile::Realtime ? "realtime" : "background") << " " << s.windows << " windows RTF " << (s.audio_sec > 0 ? s.proc_sec / s.audio_sec : 0.0) << ";";
+    }
+    if (probing) {
+        Jitter busy = jitter(true), idle = jitter(false);
+        ss << std::setprecision(1) << " wakeup jitter p50/p99/max " << busy.p50_ms << "/" << busy.p99_ms << "/" << busy.max_ms << " ms during inference vs "
+           << idle.p50_ms << "/" << idle.p99_ms << "/" << idle.max_ms << " ms idle";
+    }
+    return ss.str();
+}
@@ -2,9 +2,45 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <algorithm>
 
-HttpClient::HttpClient() { curl_global_init(CURL_GLOBAL_ALL); }
-HttpClient::~HttpClient() { curl_global_cleanup(); }
+namespace {
+std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+void lockShare(CURL*, curl_lock_data data, curl_lock_access, void*) { shareLocks[data].lock(); }
+void unlockShare(CURL*, curl_lock_data data, void*) { shareLocks[data].unlock(); }
+std::atomic<long> retries429{0};
+}
+
+long HttpClient::retryCount() { return retries429; }
+
+CURLSH* HttpClient::sharedPool() {
+    static CURLSH* share = [] {
+        curl_global_init(CURL_GLOBAL_ALL);
+        CURLSH* s = curl_share_init();
+        curl_share_setopt(s, CURLSHOPT_LOCKFUNC, lockShare);
+        curl_share_setopt(s, CURLSHOPT_UNLOCKFUNC, unlockShare);
+        curl_share_setopt(s, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(s, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(s, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        return s;
+    }();
+    return share;
+}
+
+HttpClient::HttpClient() { sharedPool(); }
+HttpClient::~HttpClient() { if (handle) curl_easy_cleanup(handle); }
+
+CURL* HttpClient::acquireHandle() {
+    if (!handle) handle = curl_easy_init();
+    else curl_easy_reset(handle);
+    if (handle) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, sharedPool());
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    }
+    return handle;
+}
 
 size_t HttpClient::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     ((std::string*)userp)->append((char*)contents, size * nmemb);
@@ -12,18 +48,20 @@ size_t HttpClient::WriteCallback(void* contents, size_t size, size_t nmemb, void
 }
 
 HttpClient::Response HttpClient::post(const std::string& url, const json& payload, const std::map<std::string, std::string>& headers) {
+    std::lock_guard<std::mutex> lock(handleMutex);
     int retries = 0;
     const int max_retries = 3;
     long http_code = 0;
     std::string readBuffer;
+    // Prompts carry transcript text, which can end inside a UTF-8 sequence; send U+FFFD rather than throw.
+    std::string json_str = payload.dump(-1, ' ', false, json::error_handler_t::replace);
 
     while (retries <= max_retries) {
         readBuffer.clear();
-        CURL* curl = curl_easy_init();
+        CURL* curl = acquireHandle();
         if (curl) {
             curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
             curl_easy_setopt(curl, CURLOPT_POST, 1L);
-            std::string json_str = payload.dump();
             curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_str.c_str());
 
             struct curl_slist* chunk = NULL;
@@ -38,22 +76,19 @@ HttpClient::Response HttpClient::post(const std::string& url, const json& payloa
 
             CURLcode res = curl_easy_perform(curl);
             curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-            if (res != CURLE_OK) {
-                std::string err = curl_easy_strerror(res);
-                curl_slist_free_all(chunk);
-                curl_easy_cleanup(curl);
-                return {http_code, "", err};
-            }
-
             curl_slist_free_all(chunk);
-            curl_easy_cleanup(curl);
+
+            if (res != CURLE_OK) return {http_code, "", curl_easy_strerror(res)};
 
             // Handle Rate Limiting
             if (http_code == 429) {
                 retries++;
                 if (retries <= max_retries) {
-                    int backoff = (1 << retries); // 2s, 4s, 8s...
+                    // The server's Retry-After (in seconds) when it sends one, else 2s, 4s, 8s...
+                    curl_off_t retryAfter = 0;
+                    curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retryAfter);
+                    int backoff = retryAfter > 0 ? (int)std::min<curl_off_t>(retryAfter, 60) : (1 << retries);
+                    retries429++;
                     std::cerr << "Rate limited (429). Retrying in " << backoff << "s..." << std::endl;
                     std::this_thread::sleep_for(std::chrono::seconds(backoff));
                     continue;
@@ -67,8 +102,9 @@ HttpClient::Response HttpClient::post(const std::string& url, const json& payloa
 }
 
 HttpClient::Response HttpClient::get(const std::string& url, const std::map<std::string, std::string>& headers) {
-    CURL* curl; CURLcode res; std::string readBuffer; long http_code = 0;
-    curl = curl_easy_init();
+    std::lock_guard<std::mutex> lock(handleMutex);
+    CURLcode res; std::string readBuffer; long http_code = 0;
+    CURL* curl = acquireHandle();
     if (curl) {
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         struct curl_slist* chunk = NULL;
@@ -81,9 +117,8 @@ HttpClient::Response HttpClient::get(const std::string& url, const std::map<std:
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
         res = curl_easy_perform(curl);
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-        if (res != CURLE_OK) return {http_code, "", curl_easy_strerror(res)};
         if (chunk) curl_slist_free_all(chunk);
-        curl_easy_cleanup(curl);
+        if (res != CURLE_OK) return {http_code, "", curl_easy_strerror(res)};
     }
     return {http_code, readBuffer, ""};
 }
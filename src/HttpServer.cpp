@@ -0,0 +1,157 @@
+#include "HttpServer.h"
+#include "Reports.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <chrono>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <unistd.h>
+
+namespace {
+const size_t MAX_HEADER_BYTES = 64 * 1024;
+const size_t MAX_UPLOAD_BYTES = 1ull << 30;
+}
+
+std::string url_decode(const std::string& s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '%' && i + 2 < s.size() && std::isxdigit((unsigned char)s[i + 1]) && std::isxdigit((unsigned char)s[i + 2])) {
+            out += (char)std::strtol(s.substr(i + 1, 2).c_str(), nullptr, 16); i += 2;
+        }
+        else if (s[i] == '+') out += ' ';
+        else out += s[i];
+    }
+    return out;
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, 0);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+bool send_response(int fd, int code, const std::string& body, const std::string& type, const std::string& extra, bool keepAlive) {
+    static const std::map<int, std::string> reasons = {{200, "OK"}, {201, "Created"}, {202, "Accepted"}, {400, "Bad Request"}, {403, "Forbidden"}, {404, "Not Found"}, {405, "Method Not Allowed"}, {413, "Payload Too Large"}, {429, "Too Many Requests"}, {500, "Internal Server Error"}, {503, "Service Unavailable"}};
+    auto r = reasons.find(code);
+    std::stringstream ss;
+    ss << "HTTP/1.1 " << code << " " << (r != reasons.end() ? r->second : "Error") << "\r\nContent-Type: " << type
+       << "\r\nContent-Length: " << body.size() << "\r\nConnection: " << (keepAlive ? "keep-alive" : "close") << "\r\n" << extra << "\r\n" << body;
+    return send_all(fd, ss.str());
+}
+
+bool send_chunk(int fd, const std::string& data) {
+    if (data.empty()) return true;
+    std::stringstream ss; ss << std::hex << data.size() << "\r\n" << data << "\r\n";
+    return send_all(fd, ss.str());
+}
+
+int read_request(int fd, HttpRequest& req) {
+    std::string buf; char tmp[8192]; size_t hdr_end;
+    while ((hdr_end = buf.find("\r\n\r\n")) == std::string::npos) {
+        if (buf.size() > MAX_HEADER_BYTES) return 413;
+        ssize_t n = ::recv(fd, tmp, sizeof(tmp), 0);
+        if (n <= 0) return 400;
+        buf.append(tmp, n);
+    }
+    std::istringstream hs(buf.substr(0, hdr_end));
+    std::string line, target, version;
+    std::getline(hs, line);
+    std::istringstream rl(line); rl >> req.method >> target >> version;
+    if (req.method.empty() || target.empty()) return 400;
+    while (std::getline(hs, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t c = line.find(':'); if (c == std::string::npos) continue;
+        std::string k = line.substr(0, c), v = line.substr(c + 1);
+        std::transform(k.begin(), k.end(), k.begin(), ::tolower); trim(v);
+        req.headers[k] = v;
+    }
+    size_t q = target.find('?');
+    req.path = target.substr(0, q);
+    if (q != std::string::npos) {
+        std::istringstream qs(target.substr(q + 1)); std::string kv;
+        while (std::getline(qs, kv, '&')) {
+            size_t e = kv.find('=');
+            req.query[url_decode(kv.substr(0, e))] = e == std::string::npos ? "" : url_decode(kv.substr(e + 1));
+        }
+    }
+    size_t len = 0;
+    if (req.headers.count("content-length")) {
+        try { len = std::stoull(req.headers["content-length"]); } catch (...) { return 400; }
+    }
+    if (len > MAX_UPLOAD_BYTES) return 413;
+    req.body.assign(buf.begin() + hdr_end + 4, buf.end());
+    // curl holds back larger bodies for up to a second unless told to go ahead.
+    if (req.body.size() < len && req.headers.count("expect") && req.headers["expect"] == "100-continue" && !send_all(fd, "HTTP/1.1 100 Continue\r\n\r\n")) return 400;
+    req.body.reserve(len);
+    while (req.body.size() < len) {
+        ssize_t n = ::recv(fd, tmp, std::min(sizeof(tmp), len - req.body.size()), 0);
+        if (n <= 0) return 400;
+        req.body.insert(req.body.end(), tmp, tmp + n);
+    }
+    req.body.resize(len);
+    return 0;
+}
+
+int listen_socket(const std::string& address, std::string& unixPath) {
+    int fd = -1;
+    if (address.rfind("unix:", 0) == 0) {
+        unixPath = address.substr(5);
+        sockaddr_un addr{}; addr.sun_family = AF_UNIX;
+        if (unixPath.empty() || unixPath.size() >= sizeof(addr.sun_path)) { std::cerr << "Invalid socket path: " << unixPath << std::endl; return -1; }
+        std::strncpy(addr.sun_path, unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(unixPath.c_str());
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) { std::cerr << "Cannot bind " << unixPath << ": " << std::strerror(errno) << std::endl; if (fd >= 0) ::close(fd); return -1; }
+    } else {
+        std::string host = "127.0.0.1", port = address;
+        size_t c = address.rfind(':');
+        if (c != std::string::npos) { host = address.substr(0, c); port = address.substr(c + 1); }
+        addrinfo hints{}, *res = nullptr; hints.ai_family = AF_UNSPEC; hints.ai_socktype = SOCK_STREAM;
+        if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) { std::cerr << "Cannot resolve " << address << std::endl; return -1; }
+        fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        int one = 1;
+        if (fd >= 0) ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        bool ok = fd >= 0 && ::bind(fd, res->ai_addr, res->ai_addrlen) == 0;
+        ::freeaddrinfo(res);
+        if (!ok) { std::cerr << "Cannot bind " << address << ": " << std::strerror(errno) << std::endl; if (fd >= 0) ::close(fd); return -1; }
+    }
+    if (::listen(fd, 64) != 0) { std::cerr << "listen() failed: " << std::strerror(errno) << std::endl; ::close(fd); return -1; }
+    return fd;
+}
+
+bool ConnectionSet::admit(int fd) {
+    timeval tv{IO_TIMEOUT_MS / 1000, (IO_TIMEOUT_MS % 1000) * 1000};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fds.size() < limit) { fds.insert(fd); return true; }
+    }
+    send_response(fd, 503, "{\"error\":\"too many connections\"}", "application/json", "Retry-After: 1\r\n");
+    ::close(fd);
+    return false;
+}
+
+void ConnectionSet::release(int fd) {
+    ::close(fd);
+    std::lock_guard<std::mutex> lock(mutex);
+    fds.erase(fd);
+    cv.notify_all();
+}
+
+void ConnectionSet::drain(int grace_ms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (cv.wait_for(lock, std::chrono::milliseconds(grace_ms), [this]{ return fds.empty(); })) return;
+    for (int fd : fds) ::shutdown(fd, SHUT_RDWR);
+    cv.wait(lock, [this]{ return fds.empty(); });
+}
@@ -2,11 +2,11 @@
 #include "Config.h"
 #include <iostream>
 
-GitHubTracker::GitHubTracker(const std::string& token, const std::string& repo) : token(token), repo(repo) {}
+GitHubTracker::GitHubTracker(const std::string& token, const std::string& repo, const std::string& apiUrl) : token(token), repo(repo), apiUrl(apiUrl) {}
 
 bool GitHubTracker::createIssue(const std::string& title, const std::string& body) {
     if (token.empty() || repo.empty()) return false;
-    std::string url = "https://api.github.com/repos/" + repo + "/issues";
+    std::string url = apiUrl + "/repos/" + repo + "/issues";
     json payload = {
         {"title", title},
         {"body", body}
@@ -20,7 +20,7 @@ bool GitHubTracker::createIssue(const std::string& title, const std::string& bod
     return response.status_code == 201;
 }
 
-GitLabTracker::GitLabTracker(const std::string& token, const std::string& repo) : token(token), repo(repo) {}
+GitLabTracker::GitLabTracker(const std::string& token, const std::string& repo, const std::string& baseUrl) : token(token), repo(repo), baseUrl(baseUrl) {}
 
 bool GitLabTracker::createIssue(const std::string& title, const std::string& body) {
     // GitLab repo needs to be URL encoded or ID
@@ -31,7 +31,7 @@ bool GitLabTracker::createIssue(const std::string& title, const std::string& bod
         if (encoded_repo[i] == '/') encoded_repo.replace(i, 1, "%2F");
     }
     
-    std::string url = "https://gitlab.com/api/v4/projects/" + encoded_repo + "/issues";
+    std::string url = baseUrl + "/api/v4/projects/" + encoded_repo + "/issues";
     json payload = {
         {"title", title},
         {"description", body}
@@ -46,10 +46,10 @@ bool GitLabTracker::createIssue(const std::string& title, const std::string& bod
 std::vector<std::unique_ptr<IssueTracker>> IntegrationFactory::createTrackers(const Config::Data& config) {
     std::vector<std::unique_ptr<IssueTracker>> trackers;
     if (!config.github_token.empty()) {
-        trackers.push_back(std::make_unique<GitHubTracker>(config.github_token, config.github_repo));
+        trackers.push_back(std::make_unique<GitHubTracker>(config.github_token, config.github_repo, config.github_api_url));
     }
     if (!config.gitlab_token.empty()) {
-        trackers.push_back(std::make_unique<GitLabTracker>(config.gitlab_token, config.gitlab_repo));
+        trackers.push_back(std::make_unique<GitLabTracker>(config.gitlab_token, config.gitlab_repo, config.gitlab_url));
     }
     return trackers;
 }
@@ -0,0 +1,133 @@
+#include "Journal.h"
+#include "Config.h"
+#include "Reports.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+const size_t BATCH_RECORDS = 64;
+}
+
+TranscriptJournal::~TranscriptJournal() { if (fd >= 0) close(false); }
+
+std::string TranscriptJournal::journalDir() {
+    fs::path dir = fs::path(Config::getConfigPath()).parent_path() / "journal";
+    fs::create_directories(dir);
+    return dir.string();
+}
+
+bool TranscriptJournal::open(const std::string& path, const std::string& baseName, int flushMs) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd < 0) return false;
+    this->flushMs = std::max(10, flushMs);
+    stopping = false; st = Stats(); appendTotalUs = fsyncTotalMs = 0;
+    pending = json{{"type", "begin"}, {"base", baseName}, {"unix", (int64_t)std::time(nullptr)}}.dump() + "\n";
+    pendingRecords = 1;
+    flusher = std::thread([this]{ flushLoop(); });
+    return true;
+}
+
+void TranscriptJournal::append(const std::string& timestamp, const std::string& text, int64_t t0_ms, int64_t t1_ms, int speaker) {
+    auto t_start = std::chrono::steady_clock::now();
+    json j = {{"type", "seg"}, {"t0", t0_ms}, {"t1", t1_ms}, {"ts", timestamp}, {"text", text}};
+    if (speaker >= 0) j["spk"] = speaker;
+    // whisper can end a segment in the middle of a UTF-8 sequence; the strict default would throw here.
+    std::string rec = j.dump(-1, ' ', false, json::error_handler_t::replace) + "\n";
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) return;
+    pending += rec;
+    if (++pendingRecords >= BATCH_RECORDS) cv.notify_one();
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t_start).count();
+    st.records++; appendTotalUs += us; st.append_max_us = std::max(st.append_max_us, us);
+}
+
+void TranscriptJournal::writeBatch(std::string& batch) {
+    size_t off = 0;
+    while (off < batch.size()) {
+        ssize_t n = ::write(fd, batch.data() + off, batch.size() - off);
+        if (n <= 0) break;
+        off += n;
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    ::fsync(fd);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::lock_guard<std::mutex> lock(mutex);
+    st.bytes += off; st.fsyncs++; fsyncTotalMs += ms; st.fsync_max_ms = std::max(st.fsync_max_ms, ms);
+}
+
+void TranscriptJournal::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait_for(lock, std::chrono::milliseconds(flushMs), [this]{ return stopping || pendingRecords >= BATCH_RECORDS; });
+        std::string batch; batch.swap(pending); pendingRecords = 0;
+        bool done = stopping;
+        if (!batch.empty()) { lock.unlock(); writeBatch(batch); lock.lock(); }
+        if (done && pending.empty()) break;
+    }
+}
+
+void TranscriptJournal::close(bool completed) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd < 0) return;
+        if (completed) { pending += json{{"type", "end"}}.dump() + "\n"; pendingRecords++; }
+        stopping = true;
+        cv.notify_one();
+    }
+    if (flusher.joinable()) flusher.join();
+    ::close(fd); fd = -1;
+}
+
+TranscriptJournal::Stats TranscriptJournal::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s = st;
+    if (s.records) s.append_avg_us = appendTotalUs / s.records;
+    if (s.fsyncs) s.fsync_avg_ms = fsyncTotalMs / s.fsyncs;
+    return s;
+}
+
+bool TranscriptJournal::load(const std::string& path, Session& session) {
+    std::ifstream f(path); if (!f.is_open()) return false;
+    session = Session(); session.path = path; session.transcript = std::make_shared<TranscriptStore>();
+    std::string line;
+    while (std::getline(f, line)) {
+        json j = json::parse(line, nullptr, false);
+        if (j.is_discarded() || !j.is_object()) continue; // torn tail after a crash
+        std::string type = j.value("type", "");
+        if (type == "begin") session.baseName = j.value("base", "");
+        else if (type == "end") session.completed = true;
+        else if (type == "seg") {
+            session.transcript->append(j.value("t0", (int64_t)0), j.value("t1", (int64_t)0), j.value("spk", -1), j.value("text", ""));
+            session.last_ms = std::max(session.last_ms, j.value("t1", (int64_t)0));
+            session.segments++;
+        }
+    }
+    if (session.baseName.empty()) session.baseName = fs::path(path).stem().string();
+    return true;
+}
+
+bool TranscriptJournal::markCompleted(const std::string& path) {
+    std::ofstream f(path, std::ios::app);
+    if (!f.is_open()) return false;
+    f << json{{"type", "end"}}.dump() << "\n";
+    return (bool)f.flush();
+}
+
+std::string TranscriptJournal::findLatestUnfinished() {
+    std::string best; fs::file_time_type bestTime;
+    for (const auto& e : fs::directory_iterator(journalDir())) {
+        if (e.path().extension() != ".ndjson") continue;
+        Session s;
+        if (!load(e.path().string(), s) || s.completed || s.segments == 0) continue;
+        if (best.empty() || e.last_write_time() > bestTime) { best = e.path().string(); bestTime = e.last_write_time(); }
+    }
+    return best;
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <algorithm>
 #include <map>
+#include <chrono>
 
 const std::string SUMMARY_PROMPT = R"(You are a helpful meeting assistant. The following is a raw transcription of a meeting. Please structure this into a clean Markdown note. Include:
 1. A concise Summary.
@@ -17,7 +18,28 @@ Transcription:
 const std::string TITLE_PROMPT = R"(Based on the following meeting transcription, generate a concise and descriptive title (2-7 words) for the meeting. Your response MUST contain ONLY the title text, as a single line, and nothing else. Transcription:
 )";
 
-std::string get_obsidian_prompt(const std::string& persona) {
+const std::string COPILOT_PROMPT = "You are a live meeting copilot. You get the most recent part of the meeting transcript and a question. Answer concisely, using only the transcript and general knowledge.";
+
+const std::vector<ReportSection> REPORT_SECTIONS = {
+    {"PARTICIPANTS", "Comma-separated list of participant names. Example: John Doe, Jane Smith. Infer from context if not explicit. Leave blank if none."},
+    {"TAGS", "Comma-separated list of relevant tags (without #). Example: meeting, project-x, AI. Leave blank if none."},
+    {"TITLE", "A concise and descriptive title (2-7 words) for the meeting."},
+    {"TOPIC", "A 1-3 word primary topic for the meeting. Example: Authentication Refactor."},
+    {"YAML_SUMMARY", "A brief, one-sentence overview of the meeting, enclosed in double quotes."},
+    {"OVERVIEW_SUMMARY", "A concise, 2-3 sentence overview summary paragraph of the entire meeting."},
+    {"KEY_TAKEAWAYS", "3-5 most critical points discussed or decided, as a Markdown bulleted list."},
+    {"AGENDA_ITEMS", "Key agenda items, as a Markdown bulleted list."},
+    {"DISCUSSION_POINTS", "Key discussion points, as a Markdown bulleted list. Use wikilinks `[[Link]]` for key concepts/people and `#tags`."},
+    {"DECISIONS_MADE", "All decisions made, as a Markdown bulleted list. Use wikilinks `[[Link]]` and `#decision` tag."},
+    {"QUESTIONS_ARISEN", "Any specific questions, uncertainties, or topics requiring further clarification that arose during the meeting, as a Markdown bulleted list."},
+    {"ACTION_ITEMS", "All action items, as a Markdown bulleted list with checkboxes. Assign to `[[Person]]` with a due date (YYYY-MM-DD) and `#todo` tag."},
+    {"MERMAID_GRAPH", "A Mermaid.js graph definition (e.g., `graph TD; A-->B;`) visualizing the relationships between discussed topics, people, and decisions. Do not include markdown code block backticks (```mermaid), just the code."},
+    {"EMAIL_DRAFT", "A professional follow-up email draft summarizing the meeting for the attendees. Include a subject line and body."},
+};
+
+static const std::string OBSIDIAN_PREAMBLE = "The following is a raw transcription of a meeting. Please extract the following information and present it in a clearly delimited plain-text format. Strictly follow the output format described below. DO NOT ADD any other text, explanations, or markdown formatting outside the specified delimiters. Extract information only from the provided transcription.\n\n";
+
+std::string get_obsidian_prompt(const std::string& persona, bool speakerLabels, const std::vector<std::string>& sections) {
     std::string persona_instruction;
     if (persona == "dev") {
         persona_instruction = "You are a Senior Technical Lead. Focus intensely on architectural decisions, code snippets mentioned, technical debt, bugs, and library choices. Ignore marketing fluff.";
@@ -29,59 +51,71 @@ std::string get_obsidian_prompt(const std::string& persona) {
         persona_instruction = "You are a helpful Meeting Assistant. Provide a balanced, comprehensive summary covering all aspects.";
     }
 
-    return persona_instruction + R"(
-The following is a raw transcription of a meeting. Please extract the following information and present it in a clearly delimited plain-text format. Strictly follow the output format described below. DO NOT ADD any other text, explanations, or markdown formatting outside the specified delimiters. Extract information only from the provided transcription.
+    std::string speaker_instruction = speakerLabels
+        ? "\nLines are labelled [Speaker N] by acoustic diarization. Keep these labels as participant names unless the conversation makes clear who a speaker is, in which case use the real name."
+        : "";
 
----PARTICIPANTS---
-<Comma-separated list of participant names. Example: John Doe, Jane Smith. Infer from context if not explicit. Leave blank if none.>
----TAGS---
-<Comma-separated list of relevant tags (without #). Example: meeting, project-x, AI. Leave blank if none.>
----TITLE---
-<A concise and descriptive title (2-7 words) for the meeting.>
----TOPIC---
-<A 1-3 word primary topic for the meeting. Example: Authentication Refactor.>
----YAML_SUMMARY---
-<A brief, one-sentence overview of the meeting, enclosed in double quotes.>
----OVERVIEW_SUMMARY---
-<A concise, 2-3 sentence overview summary paragraph of the entire meeting.>
----KEY_TAKEAWAYS---
-<3-5 most critical points discussed or decided, as a Markdown bulleted list.>
----AGENDA_ITEMS---
-<Key agenda items, as a Markdown bulleted list.>
----DISCUSSION_POINTS---
-<Key discussion points, as a Markdown bulleted list. Use wikilinks `[[Link]]` for key concepts/people and `#tags`.>
----DECISIONS_MADE---
-<All decisions made, as a Markdown bulleted list. Use wikilinks `[[Link]]` and `#decision` tag.>
----QUESTIONS_ARISEN---
-<Any specific questions, uncertainties, or topics requiring further clarification that arose during the meeting, as a Markdown bulleted list.>
----ACTION_ITEMS---
-<All action items, as a Markdown bulleted list with checkboxes. Assign to `[[Person]]` with a due date (YYYY-MM-DD) and `#todo` tag.>
----MERMAID_GRAPH---
-<A Mermaid.js graph definition (e.g., `graph TD; A-->B;`) visualizing the relationships between discussed topics, people, and decisions. Do not include markdown code block backticks (```mermaid), just the code.>
----EMAIL_DRAFT---
-<A professional follow-up email draft summarizing the meeting for the attendees. Include a subject line and body.>
+    std::string format = OBSIDIAN_PREAMBLE;
+    for (const auto& sec : REPORT_SECTIONS) {
+        if (!sections.empty() && std::find(sections.begin(), sections.end(), sec.name) == sections.end()) continue;
+        format += "---" + std::string(sec.name) + "---\n<" + sec.spec + ">\n";
+    }
+    return format + "\n" + persona_instruction + speaker_instruction + "\n";
+}
 
-Transcription:
-)";
+std::string format_usage(const LLMUsage& u) {
+    std::stringstream ss;
+    ss << u.prompt_tokens << " prompt tokens";
+    if (u.cached_tokens >= 0) ss << " (" << u.cached_tokens << " cached)";
+    ss << ", " << u.output_tokens << " output, " << (int)u.ms << " ms";
+    return ss.str();
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
 }
 
 OllamaClient::OllamaClient(const std::string& model, const std::string& baseUrl) : model(model), baseUrl(baseUrl) {}
-std::string OllamaClient::generateSummary(const std::string& transcription) {
+std::string OllamaClient::generateSummary(const std::string& transcription) { return chat("You are a helpful meeting assistant.", transcription); }
+std::string OllamaClient::generate(const std::string& prefix, const std::string& input) { return chat(prefix, input); }
+std::string OllamaClient::chat(const std::string& system, const std::string& user) {
     std::string url = baseUrl + "/api/chat";
-    json payload = {{"model", model}, {"messages", {{{"role", "system"}, {"content", "You are a helpful meeting assistant."}}, {{"role", "user"}, {"content", transcription}}}}, {"stream", false}};
+    // keep_alive keeps the model (and the KV cache of the identical system prefix) resident between calls.
+    json payload = {{"model", model}, {"messages", {{{"role", "system"}, {"content", system}}, {{"role", "user"}, {"content", user}}}}, {"stream", false}, {"keep_alive", "30m"}};
+    usage = LLMUsage(); auto t0 = std::chrono::steady_clock::now();
     auto response = httpClient.post(url, payload);
-    if (response.status_code == 200) { try { auto j = json::parse(response.body); if (j.contains("message") && j["message"].contains("content")) return j["message"]["content"]; } catch (...) {} }
+    usage.ms = elapsed_ms(t0);
+    if (response.status_code == 200) {
+        try {
+            auto j = json::parse(response.body);
+            usage.prompt_tokens = j.value("prompt_eval_count", 0); usage.output_tokens = j.value("eval_count", 0);
+            if (j.contains("message") && j["message"].contains("content")) return j["message"]["content"];
+        } catch (...) {}
+    }
     return "Error calling Ollama: " + std::to_string(response.status_code) + " " + response.error;
 }
 
-GeminiClient::GeminiClient(const std::string& apiKey, const std::string& model) : apiKey(apiKey), model(model) {}
+GeminiClient::GeminiClient(const std::string& apiKey, const std::string& model, const std::string& baseUrl) : apiKey(apiKey), model(model), baseUrl(baseUrl) {}
 std::string GeminiClient::generateSummary(const std::string& transcription) {
-    std::string url = "https://generativelanguage.googleapis.com/v1beta/models/" + model + ":generateContent?key=" + apiKey;
-    json payload = {{"contents", {{{"role", "user"}, {"parts", {{{"text", transcription}}}}}}}};
+    return call({{"contents", {{{"role", "user"}, {"parts", {{{"text", transcription}}}}}}}});
+}
+std::string GeminiClient::generate(const std::string& prefix, const std::string& input) {
+    // The system instruction is the start of the prompt, which is what implicit caching matches on.
+    return call({{"systemInstruction", {{"parts", {{{"text", prefix}}}}}}, {"contents", {{{"role", "user"}, {"parts", {{{"text", input}}}}}}}});
+}
+std::string GeminiClient::call(const json& payload) {
+    std::string url = baseUrl + "/models/" + model + ":generateContent?key=" + apiKey;
+    usage = LLMUsage(); auto t0 = std::chrono::steady_clock::now();
     auto response = httpClient.post(url, payload);
+    usage.ms = elapsed_ms(t0);
     if (response.status_code == 200) {
         try {
             auto j = json::parse(response.body);
+            if (j.contains("usageMetadata")) {
+                const auto& m = j["usageMetadata"];
+                usage.prompt_tokens = m.value("promptTokenCount", 0); usage.cached_tokens = m.value("cachedContentTokenCount", 0);
+                usage.output_tokens = m.value("candidatesTokenCount", 0);
+            }
             if (j.contains("candidates") && !j["candidates"].empty() && j["candidates"][0].contains("content")) {
                 return j["candidates"][0]["content"]["parts"][0]["text"];
             }
@@ -90,7 +124,7 @@ std::string GeminiClient::generateSummary(const std::string& transcription) {
     return "Error calling Gemini: " + std::to_string(response.status_code) + " " + response.error + " (Model: " + model + ")";
 }
 std::string GeminiClient::researchTopics(const std::string& transcription) {
-    std::string url = "https://generativelanguage.googleapis.com/v1beta/models/" + model + ":generateContent?key=" + apiKey;
+    std::string url = baseUrl + "/models/" + model + ":generateContent?key=" + apiKey;
     json google_search_tool = {{"google_search", json::object()}};
     json payload = {
         {"contents", {{{"role", "user"}, {"parts", {{{"text", "Research the key technical terms, companies, or concepts mentioned in this meeting transcription. Provide additional context, current trends, or suggestions for each. Use Google Search grounding for accurate information.\n\nTranscription:\n" + transcription}}}}}}},
@@ -108,23 +142,42 @@ std::string GeminiClient::researchTopics(const std::string& transcription) {
     return "Research failed: " + std::to_string(response.status_code) + " " + response.error;
 }
 
-OpenAIClient::OpenAIClient(const std::string& apiKey, const std::string& model) : apiKey(apiKey), model(model) {}
-std::string OpenAIClient::generateSummary(const std::string& transcription) {
-    std::string url = "https://api.openai.com/v1/chat/completions";
-    json payload = {{"model", model}, {"messages", {{{"role", "system"}, {"content", "You are a helpful meeting assistant."}}, {{"role", "user"}, {"content", transcription}}}}};
+OpenAIClient::OpenAIClient(const std::string& apiKey, const std::string& model, const std::string& baseUrl) : apiKey(apiKey), model(model), baseUrl(baseUrl) {}
+std::string OpenAIClient::generateSummary(const std::string& transcription) { return chat("You are a helpful meeting assistant.", transcription); }
+std::string OpenAIClient::generate(const std::string& prefix, const std::string& input) { return chat(prefix, input); }
+std::string OpenAIClient::chat(const std::string& system, const std::string& user) {
+    std::string url = baseUrl + "/chat/completions";
+    // Prompt caching is automatic for identical leading tokens, so the static system message must come first.
+    json payload = {{"model", model}, {"messages", {{{"role", "system"}, {"content", system}}, {{"role", "user"}, {"content", user}}}}};
     std::map<std::string, std::string> headers = {{"Authorization", "Bearer " + apiKey}};
+    usage = LLMUsage(); auto t0 = std::chrono::steady_clock::now();
     auto response = httpClient.post(url, payload, headers);
-    if (response.status_code == 200) { try { auto j = json::parse(response.body); if (j.contains("choices") && !j["choices"].empty()) return j["choices"][0]["message"]["content"]; } catch (...) {} }
+    usage.ms = elapsed_ms(t0);
+    if (response.status_code == 200) {
+        try {
+            auto j = json::parse(response.body);
+            if (j.contains("usage")) {
+                const auto& u = j["usage"];
+                usage.prompt_tokens = u.value("prompt_tokens", 0); usage.output_tokens = u.value("completion_tokens", 0);
+                usage.cached_tokens = u.contains("prompt_tokens_details") ? u["prompt_tokens_details"].value("cached_tokens", 0) : 0;
+            }
+            if (j.contains("choices") && !j["choices"].empty()) return j["choices"][0]["message"]["content"];
+        } catch (...) {}
+    }
     return "Error calling OpenAI: " + std::to_string(response.status_code) + " " + response.error;
 }
 std::string OpenAIClient::researchTopics(const std::string& transcription) { return "Research currently only supported for Gemini."; }
 
-std::unique_ptr<LLMClient> ClientFactory::createClient(const std::string& provider, const std::string& apiKeyOrUrl, const std::string& model) {
-    if (provider == "ollama") return std::make_unique<OllamaClient>(model, apiKeyOrUrl.empty() ? "http://localhost:11434" : apiKeyOrUrl);
+std::unique_ptr<LLMClient> ClientFactory::createClient(const std::string& provider, const std::string& apiKeyOrUrl, const std::string& model, const std::string& baseUrl) {
+    if (provider == "ollama") return std::make_unique<OllamaClient>(model, !baseUrl.empty() ? baseUrl : apiKeyOrUrl.empty() ? "http://localhost:11434" : apiKeyOrUrl);
     else if (provider == "gemini") {
         // Use 1.5-flash as the most widely available stable default if none provided
+        if (!baseUrl.empty()) return std::make_unique<GeminiClient>(apiKeyOrUrl, model.empty() ? "gemini-1.5-flash" : model, baseUrl);
         return std::make_unique<GeminiClient>(apiKeyOrUrl, model.empty() ? "gemini-1.5-flash" : model);
     }
-    else if (provider == "openai") return std::make_unique<OpenAIClient>(apiKeyOrUrl, model.empty() ? "gpt-3.5-turbo" : model);
+    else if (provider == "openai") {
+        if (!baseUrl.empty()) return std::make_unique<OpenAIClient>(apiKeyOrUrl, model.empty() ? "gpt-3.5-turbo" : model, baseUrl);
+        return std::make_unique<OpenAIClient>(apiKeyOrUrl, model.empty() ? "gpt-3.5-turbo" : model);
+    }
     return nullptr;
 }
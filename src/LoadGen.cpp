@@ -0,0 +1,136 @@
+#include "LoadGen.h"
+#include "LLMClients.h"
+#include "Integrations.h"
+#include "Reports.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+namespace {
+const char* const LINES[] = {
+    "Let's start with the latency numbers from last week's load test.",
+    "The p99 went up to almost three seconds once we passed sixteen concurrent requests.",
+    "Most of that was the provider rate limiting us, we got a lot of 429s.",
+    "Then we should respect Retry-After instead of our own fixed backoff.",
+    "Agreed. Can we also generate the report sections in parallel?",
+    "Yes, but only three at a time, otherwise we hit the limit again.",
+    "I'll publish the results and ask for a higher quota by Friday.",
+    "Sounds good. Anything else on the agenda? No? Then let's wrap up.",
+};
+
+// A ten-minute two-person meeting in transcript format, the size of a typical analysis request.
+std::string synthetic_transcript() {
+    std::string out;
+    for (int i = 0; i < 80; ++i) out += format_segment_line(i * 7500, i % 2, LINES[i % (sizeof(LINES) / sizeof(LINES[0]))]) + "\n";
+    return out;
+}
+
+// Served requests and the server time they took, from the mock server's /mock/stats; false elsewhere.
+bool mock_served(const std::string& root, const std::string& api, long& served, double& ms) {
+    auto r = HttpClient().get(root + "/mock/stats");
+    if (r.status_code != 200) return false;
+    try {
+        json j = json::parse(r.body);
+        served = 0; ms = 0;
+        if (j["apis"].contains(api)) { served = j["apis"][api].value("served", 0L); ms = j["apis"][api].value("served_ms", 0.0); }
+        return true;
+    } catch (...) { return false; }
+}
+}
+
+int run_loadgen(int argc, char** argv) {
+    std::string api = "ollama", root = "http://127.0.0.1:8808", key = "mock", model, promptPath, outPath;
+    int requests = 100, concurrency = 8; double duration = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--api" && i + 1 < argc) api = argv[++i];
+        else if (arg == "--url" && i + 1 < argc) root = argv[++i];
+        else if (arg == "-k" && i + 1 < argc) key = argv[++i];
+        else if (arg == "-L" && i + 1 < argc) model = argv[++i];
+        else if (arg == "-n" && i + 1 < argc) requests = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "-c" && i + 1 < argc) concurrency = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--duration" && i + 1 < argc) duration = std::stod(argv[++i]);
+        else if (arg == "--prompt" && i + 1 < argc) promptPath = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else { api.clear(); break; }
+    }
+    bool tracker = api == "github" || api == "gitlab";
+    if (!tracker && api != "ollama" && api != "openai" && api != "gemini") {
+        std::cerr << "Usage: " << argv[0] << " loadgen [--api ollama|openai|gemini|github|gitlab] [--url http://host:port] [-n requests | --duration s]\n"
+                  << "       [-c concurrency] [-k key] [-L model] [--prompt transcript.txt] [--out results.json]\n";
+        return 1;
+    }
+    while (!root.empty() && root.back() == '/') root.pop_back();
+
+    std::string input = synthetic_transcript();
+    if (!promptPath.empty()) {
+        std::ifstream f(promptPath); std::stringstream ss; ss << f.rdbuf();
+        if (!f) { std::cerr << "Could not read " << promptPath << "\n"; return 1; }
+        input = ss.str();
+    }
+    input = "Transcription:\n" + input;
+    const std::string prefix = get_obsidian_prompt("general");
+    const std::string base = root + (api == "openai" ? "/v1" : api == "gemini" ? "/v1beta" : "");
+
+    std::cout << "Load test: " << api << " at " << root << ", " << (duration > 0 ? std::to_string((int)duration) + " s" : std::to_string(requests) + " requests")
+              << ", concurrency " << concurrency << std::endl;
+    long served0 = 0, served1 = 0; double servedMs0 = 0, servedMs1 = 0;
+    bool mock = mock_served(root, api, served0, servedMs0);
+    long retries0 = HttpClient::retryCount();
+
+    std::atomic<int> next{0}; std::mutex mutex;
+    std::vector<double> latencies; long ok = 0, failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(duration));
+    auto worker = [&] {
+        std::unique_ptr<LLMClient> llm; std::unique_ptr<IssueTracker> issues;
+        if (api == "github") issues = std::make_unique<GitHubTracker>(key, "loadgen/mock", root);
+        else if (api == "gitlab") issues = std::make_unique<GitLabTracker>(key, "loadgen/mock", root);
+        else llm = ClientFactory::createClient(api, api == "ollama" ? "" : key, model.empty() ? "mock" : model, base);
+        for (;;) {
+            int i = next++;
+            if (duration > 0 ? std::chrono::steady_clock::now() >= deadline : i >= requests) break;
+            auto t0 = std::chrono::steady_clock::now();
+            bool success = llm ? llm->generate(prefix, input).rfind("Error calling", 0) != 0
+                               : issues->createIssue("Load test issue " + std::to_string(i), "Created by meeting_assistant loadgen.");
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::lock_guard<std::mutex> lock(mutex);
+            (success ? ok : failed)++;
+            if (success) latencies.push_back(ms);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < concurrency; ++i) pool.emplace_back(worker);
+    for (auto& t : pool) t.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long retries = HttpClient::retryCount() - retries0;
+
+    auto pct = [](std::vector<double> v, double p) { if (v.empty()) return 0.0; std::sort(v.begin(), v.end()); return v[std::min(v.size() - 1, (size_t)(v.size() * p))]; };
+    double mean = latencies.empty() ? 0.0 : std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+    json j = {{"api", api}, {"url", root}, {"concurrency", concurrency}, {"ok", ok}, {"failed", failed}, {"retries_429", retries}, {"wall_sec", wall},
+              {"throughput_rps", wall > 0 ? ok / wall : 0.0},
+              {"latency_ms", {{"mean", mean}, {"p50", pct(latencies, 0.5)}, {"p90", pct(latencies, 0.9)}, {"p99", pct(latencies, 0.99)}, {"max", pct(latencies, 1.0)}}}};
+    std::cout << std::fixed << std::setprecision(1)
+              << "  ok " << ok << ", failed " << failed << ", 429 retries " << retries << "\n"
+              << "  throughput " << j["throughput_rps"].get<double>() << " req/s over " << std::setprecision(2) << wall << " s\n" << std::setprecision(1)
+              << "  latency ms: mean " << mean << "  p50 " << pct(latencies, 0.5) << "  p90 " << pct(latencies, 0.9) << "  p99 " << pct(latencies, 0.99)
+              << "  max " << pct(latencies, 1.0) << std::endl;
+    // Retries add their backoff to the client time, so the difference only means something without them.
+    if (mock && mock_served(root, api, served1, servedMs1) && served1 - served0 == ok && ok > 0 && retries == 0) {
+        double serverMean = (servedMs1 - servedMs0) / ok;
+        j["server_mean_ms"] = serverMean; j["overhead_ms"] = mean - serverMean;
+        std::cout << "  mock server time mean " << serverMean << " ms -> client overhead " << std::setprecision(2) << mean - serverMean << " ms/request" << std::endl;
+    }
+    if (!outPath.empty()) {
+        std::ofstream f(outPath); f << j.dump(2) << "\n";
+        if (!f) { std::cerr << "Could not write " << outPath << "\n"; return 1; }
+    }
+    return failed ? 1 : 0;
+}
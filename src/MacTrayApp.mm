@@ -88,7 +88,7 @@ public:
 
     Engine() {
         config = Config::load();
-        transcriber = std::make_unique<Transcriber>(config.model_path);
+        transcriber = std::make_unique<Transcriber>(config.model_path, 1, true);
     }
 
     void start() {
@@ -0,0 +1,142 @@
+#include "MemoryBudget.h"
+#include "AudioSource.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+const size_t MB = 1024 * 1024;
+const size_t BASE_BYTES = 100 * MB;         // runtime, libraries, live window, transcript, report strings
+const int QUEUE_SEC = 600, MIN_QUEUE_SEC = 60; // live capture backlog: preferred and smallest bound
+const int JOB_AUDIO_SEC = 3600;             // server: recording length a running job is planned for
+const size_t MIN_UPLOAD_BYTES = 64 * MB;
+const uint32_t GGML_MAGIC = 0x67676d6c;
+
+// Compute buffers (conv + encode + cross + decode) of one whisper_state by audio width, tiny to large.
+const struct { int width; double mb; } COMPUTE_MB[] = {{384, 177}, {512, 206}, {768, 411}, {1024, 729}, {1280, 1185}};
+
+double compute_mb(int width) {
+    const int n = sizeof(COMPUTE_MB) / sizeof(COMPUTE_MB[0]);
+    int i = 1;
+    while (i < n - 1 && width > COMPUTE_MB[i].width) ++i;
+    const auto& a = COMPUTE_MB[i - 1]; const auto& b = COMPUTE_MB[i];
+    return std::max(a.mb * 0.5, a.mb + (b.mb - a.mb) * (width - a.width) / (b.width - a.width));
+}
+
+size_t pad(size_t n, size_t to) { return (n + to - 1) / to * to; }
+std::string mb(size_t bytes) { return std::to_string((bytes + MB / 2) / MB) + " MB"; }
+
+bool refuse(const MemoryPlan& plan, const std::string& what) {
+    std::cerr << "Memory budget of " << mb(plan.budget) << " is too small for " << what << ": " << plan.describe()
+              << ". Use a smaller or quantized model, or raise --memory-budget." << std::endl;
+    return false;
+}
+}
+
+ModelFootprint estimate_model(const std::string& path, const Config::Data& config) {
+    ModelFootprint m; std::error_code ec;
+    m.weight_bytes = (size_t)fs::file_size(path, ec);
+    if (ec) m.weight_bytes = 0;
+    // whisper.cpp's ggml header: magic, then n_vocab, n_audio_ctx, n_audio_state, n_audio_head, n_audio_layer,
+    // n_text_ctx, n_text_state, n_text_head, n_text_layer, n_mels, ftype.
+    std::ifstream f(path, std::ios::binary); uint32_t magic = 0; int32_t hp[11] = {};
+    if (f.read((char*)&magic, 4) && magic == GGML_MAGIC && f.read((char*)hp, sizeof(hp)) && hp[2] > 0 && hp[8] > 0) {
+        size_t audio_ctx = hp[1], text_ctx = hp[5], text_state = hp[6], text_layers = hp[8];
+        size_t decoders = config.decoding == "greedy" ? 1 : 5; // beam_size of the adaptive and beam policies
+        size_t kv_self = 2 * text_layers * pad(text_ctx, 256) * text_state * 2 * decoders;   // f16 K and V
+        size_t kv_cross = 2 * text_layers * pad(audio_ctx, 256) * text_state * 2;
+        m.state_bytes = kv_self + kv_cross + (size_t)(compute_mb(hp[2]) * MB);
+        m.known = true;
+    } else m.state_bytes = 256 * MB + m.weight_bytes / 2; // other formats: roughly tiny/base-sized buffers plus a share of the weights
+    return m;
+}
+
+size_t MemoryPlan::planned() const {
+    return weights + states * (per_state + job_audio) + (audio_queue_samples + refine_queue_samples) * sizeof(float) + upload_bytes + base;
+}
+
+std::string MemoryPlan::describe() const {
+    std::stringstream ss;
+    ss << "weights " << mb(weights) << ", " << states << " x (decoder state " << mb(per_state);
+    if (job_audio) ss << " + job audio " << mb(job_audio);
+    ss << ")";
+    if (audio_queue_samples) ss << ", audio queue " << audio_queue_samples / SAMPLE_RATE << " s (" << mb(audio_queue_samples * sizeof(float)) << ")";
+    if (refine_queue_samples) ss << ", refine queue " << refine_queue_samples / SAMPLE_RATE << " s (" << mb(refine_queue_samples * sizeof(float)) << ")";
+    if (upload_bytes) ss << ", uploads " << mb(upload_bytes);
+    ss << ", base " << mb(base) << " = " << mb(planned());
+    return ss.str();
+}
+
+bool plan_session(const Config::Data& config, bool live, MemoryPlan& plan) {
+    plan = MemoryPlan(); plan.budget = (size_t)std::max(0, config.memory_budget_mb) * MB; plan.base = BASE_BYTES;
+    ModelFootprint m = estimate_model(config.model_path, config);
+    plan.weights = m.weight_bytes; plan.per_state = m.state_bytes;
+    if (live && !config.refine_model.empty()) {
+        ModelFootprint r = estimate_model(config.refine_model, config);
+        plan.weights += r.weight_bytes; plan.per_state += r.state_bytes;
+        plan.refine_queue_samples = (size_t)std::max(0, config.refine_queue_sec) * SAMPLE_RATE;
+    }
+    if (!plan.budget) return true;
+    if (live) {
+        // Whatever is left bounds the capture backlog, up to QUEUE_SEC.
+        size_t fixed = plan.planned(), perSec = SAMPLE_RATE * sizeof(float);
+        size_t sec = fixed < plan.budget ? std::min<size_t>(QUEUE_SEC, (plan.budget - fixed) / perSec) : 0;
+        plan.audio_queue_samples = std::max<size_t>(sec, MIN_QUEUE_SEC) * SAMPLE_RATE;
+    }
+    if (plan.planned() > plan.budget) return refuse(plan, live ? "live transcription" : "this file");
+    return true;
+}
+
+bool plan_server(const Config::Data& config, int workers, MemoryPlan& plan) {
+    plan = MemoryPlan(); plan.budget = (size_t)std::max(0, config.memory_budget_mb) * MB; plan.base = BASE_BYTES;
+    ModelFootprint m = estimate_model(config.model_path, config);
+    plan.weights = m.weight_bytes; plan.per_state = m.state_bytes;
+    plan.job_audio = (size_t)JOB_AUDIO_SEC * SAMPLE_RATE * sizeof(float) * 2; // the recording plus its speech-only copy
+    plan.states = std::max(1, workers);
+    if (!plan.budget) return true;
+    size_t fixed = plan.weights + plan.base + MIN_UPLOAD_BYTES, perWorker = plan.per_state + plan.job_audio;
+    int fit = fixed < plan.budget ? (int)std::min<size_t>(plan.states, (plan.budget - fixed) / perWorker) : 0;
+    if (fit < 1) { plan.states = 1; plan.upload_bytes = MIN_UPLOAD_BYTES; return refuse(plan, "one server worker"); }
+    if (fit < plan.states) std::cout << "Memory budget: running " << fit << " of " << plan.states << " requested workers" << std::endl;
+    plan.states = fit;
+    plan.upload_bytes = plan.budget - (plan.weights + plan.base + plan.states * perWorker);
+    return true;
+}
+
+std::string memory_report(const MemoryPlan& plan) {
+    if (!plan.budget) return "";
+    return "Memory: peak RSS " + mb(peak_rss()) + " vs planned " + mb(plan.planned()) + " (budget " + mb(plan.budget) + ")";
+}
+
+size_t current_rss() {
+#ifdef __APPLE__
+    mach_task_basic_info info; mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) return 0;
+    return info.resident_size;
+#else
+    std::ifstream f("/proc/self/statm"); size_t pages = 0, resident = 0;
+    if (!(f >> pages >> resident)) return 0;
+    return resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+size_t peak_rss() {
+    struct rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)ru.ru_maxrss;        // bytes
+#else
+    return (size_t)ru.ru_maxrss * 1024; // kilobytes
+#endif
+}
@@ -0,0 +1,321 @@
+#include "MockServer.h"
+#include "HttpServer.h"
+#include "LLMClients.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <csignal>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+extern volatile sig_atomic_t shutdown_requested;
+
+namespace {
+const int KEEPALIVE_MS = 5000, STOP_GRACE_MS = 2000;
+
+// Canned content per report section; shaped like real replies so the report writers have something to render.
+const std::map<std::string, std::string> CANNED = {
+    {"PARTICIPANTS", "Alex Example, Sam Example"},
+    {"TAGS", "meeting, load-test, mock"},
+    {"TITLE", "Mock Capacity Review"},
+    {"TOPIC", "Capacity Planning"},
+    {"YAML_SUMMARY", "\"The team reviewed request latency and agreed on a retry policy.\""},
+    {"OVERVIEW_SUMMARY", "The team reviewed the latency of the analysis pipeline under load. They agreed on a retry policy for rate-limited calls and a budget for tail latency."},
+    {"KEY_TAKEAWAYS", "- p99 latency must stay below two seconds\n- Rate-limited calls are retried after Retry-After\n- Report sections can be generated in parallel"},
+    {"AGENDA_ITEMS", "- Latency results\n- Retry policy\n- Next steps"},
+    {"DISCUSSION_POINTS", "- [[Alex Example]] presented the load test results #performance\n- [[Sam Example]] raised the provider's rate limits #api"},
+    {"DECISIONS_MADE", "- Honour Retry-After on 429 responses #decision"},
+    {"QUESTIONS_ARISEN", "- How much concurrency does the provider tolerate?"},
+    {"ACTION_ITEMS", "- [ ] [[Alex Example]] Publish the load test results (2030-01-15) #todo\n- [ ] [[Sam Example]] Request a higher rate limit (2030-01-20) #todo"},
+    {"MERMAID_GRAPH", "graph TD; A[Load test]-->B[Latency budget]; A-->C[Retry policy];"},
+    {"EMAIL_DRAFT", "Subject: Capacity review follow-up\n\nHi all,\n\nthanks for joining. We agreed to honour Retry-After and to keep p99 below two seconds.\n\nBest,\nAlex"},
+};
+
+double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Splits text into n pieces of similar size without cutting a UTF-8 sequence.
+std::vector<std::string> split_chunks(const std::string& text, int n) {
+    std::vector<std::string> out;
+    size_t step = std::max<size_t>(1, text.size() / std::max(1, n)), pos = 0;
+    while (pos < text.size()) {
+        size_t end = std::min(text.size(), pos + step);
+        while (end < text.size() && ((unsigned char)text[end] & 0xC0) == 0x80) end++;
+        if ((int)out.size() + 1 == n) end = text.size();
+        out.push_back(text.substr(pos, end - pos)); pos = end;
+    }
+    if (out.empty()) out.push_back("");
+    return out;
+}
+
+// Every text field the client sent: Ollama/OpenAI messages, Gemini systemInstruction and contents.
+std::string prompt_text(const json& j) {
+    std::string out;
+    if (j.contains("messages")) for (const auto& m : j["messages"]) out += m.value("content", "") + "\n";
+    for (const char* k : {"systemInstruction", "contents"}) {
+        if (!j.contains(k)) continue;
+        json items = j[k].is_array() ? j[k] : json::array({j[k]});
+        for (const auto& c : items) if (c.contains("parts")) for (const auto& p : c["parts"]) out += p.value("text", "") + "\n";
+    }
+    return out;
+}
+
+int tokens(const std::string& s) { return std::max(1, (int)s.size() / 4); }
+}
+
+MockServer::MockServer(const Options& opt) : opt(opt), rng(opt.seed) {
+    if (!opt.response_file.empty()) {
+        std::ifstream f(opt.response_file); std::stringstream ss; ss << f.rdbuf();
+        fixedReply = ss.str();
+        if (!f) std::cerr << "Cannot read " << opt.response_file << "; using canned replies" << std::endl;
+    }
+}
+
+MockServer::~MockServer() { stop(); }
+
+bool MockServer::listen(const std::string& address) {
+    listenFd = listen_socket(address, unixPath);
+    if (listenFd < 0) return false;
+    std::cout << "Mock APIs on " << address << ": first chunk " << opt.latency_ms << "+" << opt.jitter_ms << " ms, " << opt.chunks << " chunks x "
+              << opt.chunk_ms << " ms, issues " << opt.issue_ms << " ms, 429 on " << opt.rate_limit * 100 << "% (Retry-After " << opt.retry_after << " s)" << std::endl;
+    return true;
+}
+
+void MockServer::start() {
+    std::signal(SIGPIPE, SIG_IGN);
+    running = true;
+    acceptor = std::thread([this]{ acceptLoop(); });
+}
+
+void MockServer::stop() {
+    if (!running.exchange(false)) return;
+    if (acceptor.joinable()) acceptor.join();
+    if (listenFd >= 0) { ::close(listenFd); listenFd = -1; }
+    if (!unixPath.empty()) ::unlink(unixPath.c_str());
+    connections.drain(STOP_GRACE_MS);
+}
+
+void MockServer::acceptLoop() {
+    while (running) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        if (!connections.admit(fd)) continue;
+        std::thread([this, fd]{ handleConnection(fd); connections.release(fd); }).detach();
+    }
+}
+
+void MockServer::handleConnection(int fd) {
+    // HttpClient keeps its connections alive, so serve requests until the client goes quiet or hangs up.
+    for (;;) {
+        bool ready = false;
+        for (int waited = 0; running && !ready && waited < KEEPALIVE_MS; waited += 200) {
+            pollfd pfd{fd, POLLIN, 0};
+            ready = ::poll(&pfd, 1, 200) > 0;
+        }
+        char peek;
+        if (!ready || ::recv(fd, &peek, 1, MSG_PEEK) <= 0) return;
+        HttpRequest req;
+        if (int err = read_request(fd, req)) { send_response(fd, err, json{{"error", "malformed request"}}.dump()); return; }
+        if (!handleRequest(fd, req)) return;
+    }
+}
+
+int MockServer::firstChunkDelayMs() {
+    if (opt.jitter_ms <= 0) return opt.latency_ms;
+    std::lock_guard<std::mutex> lock(mutex);
+    return opt.latency_ms + std::uniform_int_distribution<int>(0, opt.jitter_ms)(rng);
+}
+
+bool MockServer::injectRateLimit() {
+    if (opt.rate_limit <= 0) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::bernoulli_distribution(std::min(1.0, opt.rate_limit))(rng);
+}
+
+void MockServer::record(const std::string& api, bool limited, bool streamed, double ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Counters& c = counters[api];
+    c.requests++;
+    if (limited) c.rate_limited++;
+    else { c.served++; c.served_ms += ms; }
+    if (streamed) c.streamed++;
+}
+
+std::string MockServer::completion(const std::string& prompt) const {
+    if (!fixedReply.empty()) return fixedReply;
+    std::string out;
+    for (const auto& sec : REPORT_SECTIONS) {
+        std::string marker = "---" + std::string(sec.name) + "---";
+        if (prompt.find(marker) == std::string::npos) continue;
+        auto it = CANNED.find(sec.name);
+        out += marker + "\n" + (it != CANNED.end() ? it->second : "Mock " + std::string(sec.name) + ".") + "\n";
+    }
+    if (!out.empty()) return out;
+    if (prompt.find(TITLE_PROMPT.substr(0, 60)) != std::string::npos) return CANNED.at("TITLE");
+    return "## Summary\n" + CANNED.at("OVERVIEW_SUMMARY") + "\n\n## Key Discussion Points\n" + CANNED.at("KEY_TAKEAWAYS") + "\n\n## Action Items\n" + CANNED.at("ACTION_ITEMS") + "\n";
+}
+
+bool MockServer::handleRequest(int fd, const HttpRequest& req) {
+    auto t0 = std::chrono::steady_clock::now();
+    auto hdr = req.headers.find("connection");
+    bool keepAlive = hdr == req.headers.end() || hdr->second != "close";
+
+    if (req.path == "/mock/stats" && req.method == "GET") {
+        json j = {{"in_flight", inFlight.load()}, {"max_in_flight", maxInFlight.load()}, {"apis", json::object()}};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& kv : counters)
+                j["apis"][kv.first] = {{"requests", kv.second.requests}, {"rate_limited", kv.second.rate_limited}, {"streamed", kv.second.streamed},
+                                       {"served", kv.second.served}, {"served_ms", kv.second.served_ms}};
+        }
+        return send_response(fd, 200, j.dump(), "application/json", "", keepAlive) && keepAlive;
+    }
+
+    std::string api;
+    bool geminiStream = ends_with(req.path, ":streamGenerateContent");
+    if (ends_with(req.path, "/api/chat")) api = "ollama";
+    else if (ends_with(req.path, "/chat/completions")) api = "openai";
+    else if (ends_with(req.path, ":generateContent") || geminiStream) api = "gemini";
+    else if (ends_with(req.path, "/issues") && req.path.find("/api/v4/projects/") != std::string::npos) api = "gitlab";
+    else if (ends_with(req.path, "/issues") && req.path.find("/repos/") != std::string::npos) api = "github";
+    if (api.empty()) return send_response(fd, 404, json{{"error", "not found"}}.dump(), "application/json", "", keepAlive) && keepAlive;
+    if (req.method != "POST") return send_response(fd, 405, json{{"error", "method not allowed"}}.dump(), "application/json", "", keepAlive) && keepAlive;
+
+    json body;
+    try { body = json::parse(req.body.begin(), req.body.end()); }
+    catch (const std::exception& e) { return send_response(fd, 400, json{{"error", e.what()}}.dump(), "application/json", "", keepAlive) && keepAlive; }
+
+    int now = ++inFlight;
+    for (int m = maxInFlight; now > m && !maxInFlight.compare_exchange_weak(m, now);) {}
+    struct Leave { std::atomic<int>& n; ~Leave() { n--; } } leave{inFlight};
+
+    if (injectRateLimit()) {
+        record(api, true, false, ms_since(t0));
+        std::string extra = opt.retry_after > 0 ? "Retry-After: " + std::to_string(opt.retry_after) + "\r\n" : "";
+        json err = {{"error", {{"code", 429}, {"message", "rate limited by mock-server"}, {"status", "RESOURCE_EXHAUSTED"}, {"type", "rate_limit_exceeded"}}}};
+        return send_response(fd, 429, err.dump(), "application/json", extra, keepAlive) && keepAlive;
+    }
+
+    if (api == "github" || api == "gitlab") {
+        std::this_thread::sleep_for(std::chrono::milliseconds(opt.issue_ms));
+        long n;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            n = nextIssue++;
+        }
+        json j = api == "github" ? json{{"number", n}, {"title", body.value("title", "")}, {"html_url", "http://mock/github/issues/" + std::to_string(n)}}
+                                 : json{{"iid", n}, {"title", body.value("title", "")}, {"web_url", "http://mock/gitlab/issues/" + std::to_string(n)}};
+        bool ok = send_response(fd, 201, j.dump(), "application/json", "", keepAlive);
+        record(api, false, false, ms_since(t0));
+        return ok && keepAlive;
+    }
+
+    std::string prompt = prompt_text(body), model = body.value("model", "mock");
+    std::string reply = completion(prompt);
+    auto pieces = split_chunks(reply, opt.chunks);
+    int pt = tokens(prompt), ot = tokens(reply);
+    bool stream = geminiStream || body.value("stream", false);
+    bool sse = api == "openai" || (api == "gemini" && req.query.count("alt") && req.query.at("alt") == "sse");
+    int firstMs = firstChunkDelayMs();
+
+    auto gemini_json = [&](const std::string& text, bool last) {
+        json j = {{"candidates", {{{"content", {{"parts", {{{"text", text}}}}, {"role", "model"}}}, {"index", 0}}}}};
+        if (last) { j["candidates"][0]["finishReason"] = "STOP"; j["usageMetadata"] = {{"promptTokenCount", pt}, {"candidatesTokenCount", ot}, {"totalTokenCount", pt + ot}}; }
+        return j;
+    };
+    auto openai_usage = json{{"prompt_tokens", pt}, {"completion_tokens", ot}, {"total_tokens", pt + ot}, {"prompt_tokens_details", {{"cached_tokens", 0}}}};
+
+    if (!stream) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(firstMs + opt.chunk_ms * ((int)pieces.size() - 1)));
+        json j;
+        if (api == "ollama") j = {{"model", model}, {"message", {{"role", "assistant"}, {"content", reply}}}, {"done", true}, {"done_reason", "stop"},
+                                  {"prompt_eval_count", pt}, {"eval_count", ot}};
+        else if (api == "openai") j = {{"id", "chatcmpl-mock"}, {"object", "chat.completion"}, {"created", (long)std::time(nullptr)}, {"model", model},
+                                       {"choices", {{{"index", 0}, {"message", {{"role", "assistant"}, {"content", reply}}}, {"finish_reason", "stop"}}}}, {"usage", openai_usage}};
+        else j = gemini_json(reply, true);
+        bool ok = send_response(fd, 200, j.dump(), "application/json", "", keepAlive);
+        record(api, false, false, ms_since(t0));
+        return ok && keepAlive;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(firstMs));
+    std::string type = sse ? "text/event-stream" : api == "ollama" ? "application/x-ndjson" : "application/json";
+    bool ok = send_all(fd, "HTTP/1.1 200 OK\r\nContent-Type: " + type + "\r\nTransfer-Encoding: chunked\r\nConnection: " + (keepAlive ? "keep-alive" : "close") + "\r\n\r\n");
+    for (size_t i = 0; ok && i < pieces.size(); ++i) {
+        if (i) std::this_thread::sleep_for(std::chrono::milliseconds(opt.chunk_ms));
+        bool last = i + 1 == pieces.size();
+        std::string out;
+        if (api == "ollama") {
+            out = json{{"model", model}, {"message", {{"role", "assistant"}, {"content", pieces[i]}}}, {"done", false}}.dump() + "\n";
+            if (last) out += json{{"model", model}, {"message", {{"role", "assistant"}, {"content", ""}}}, {"done", true}, {"done_reason", "stop"},
+                                  {"prompt_eval_count", pt}, {"eval_count", ot}}.dump() + "\n";
+        } else if (api == "openai") {
+            json j = {{"id", "chatcmpl-mock"}, {"object", "chat.completion.chunk"}, {"model", model}, {"choices", {{{"index", 0}, {"delta", {{"content", pieces[i]}}}, {"finish_reason", nullptr}}}}};
+            out = "data: " + j.dump() + "\n\n";
+            if (last) {
+                j["choices"][0]["delta"] = json::object(); j["choices"][0]["finish_reason"] = "stop"; j["usage"] = openai_usage;
+                out += "data: " + j.dump() + "\n\ndata: [DONE]\n\n";
+            }
+        } else if (sse) out = "data: " + gemini_json(pieces[i], last).dump() + "\r\n\r\n";
+        else out = (i ? ",\r\n" : "[") + gemini_json(pieces[i], last).dump() + (last ? "]" : "");
+        ok = send_chunk(fd, out);
+    }
+    ok = ok && send_all(fd, "0\r\n\r\n");
+    record(api, false, true, ms_since(t0));
+    return ok && keepAlive;
+}
+
+std::string MockServer::summary() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::stringstream ss; ss << std::fixed << std::setprecision(1) << "Mock: ";
+    if (counters.empty()) ss << "no requests";
+    for (auto it = counters.begin(); it != counters.end(); ++it) {
+        const Counters& c = it->second;
+        ss << (it == counters.begin() ? "" : "; ") << it->first << " " << c.requests << " requests (" << c.rate_limited << " x 429, " << c.streamed << " streamed, mean "
+           << (c.served ? c.served_ms / c.served : 0.0) << " ms)";
+    }
+    ss << "; peak concurrency " << maxInFlight.load();
+    return ss.str();
+}
+
+int run_mock_server(int argc, char** argv) {
+    MockServer::Options opt; std::string address = "127.0.0.1:8808";
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--listen" && i + 1 < argc) address = argv[++i];
+        else if (arg == "--latency-ms" && i + 1 < argc) opt.latency_ms = std::stoi(argv[++i]);
+        else if (arg == "--jitter-ms" && i + 1 < argc) opt.jitter_ms = std::stoi(argv[++i]);
+        else if (arg == "--chunk-ms" && i + 1 < argc) opt.chunk_ms = std::stoi(argv[++i]);
+        else if (arg == "--chunks" && i + 1 < argc) opt.chunks = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--issue-ms" && i + 1 < argc) opt.issue_ms = std::stoi(argv[++i]);
+        else if (arg == "--rate-limit" && i + 1 < argc) opt.rate_limit = std::stod(argv[++i]);
+        else if (arg == "--retry-after" && i + 1 < argc) opt.retry_after = std::stoi(argv[++i]);
+        else if (arg == "--response" && i + 1 < argc) opt.response_file = argv[++i];
+        else if (arg == "--seed" && i + 1 < argc) opt.seed = (unsigned)std::stoul(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " mock-server [--listen host:port|unix:/path] [--latency-ms n] [--jitter-ms n] [--chunk-ms n] [--chunks n]\n"
+                      << "       [--issue-ms n] [--rate-limit 0..1] [--retry-after s] [--response reply.txt] [--seed n]\n";
+            return 1;
+        }
+    }
+    MockServer server(opt);
+    if (!server.listen(address)) return 1;
+    server.start();
+    while (!shutdown_requested) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    server.stop();
+    std::cout << "\n" << server.summary() << std::endl;
+    return 0;
+}
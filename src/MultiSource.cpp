@@ -0,0 +1,160 @@
+#include "MultiSource.h"
+#include "Governor.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Controller gains on the FIFO level error in seconds; critically damped with a time constant of ~20 s,
+// slow enough that burst delivery (PortAudio hands over 32 ms at a time) does not modulate the pitch.
+const double KP = 0.1, KI = 0.0025, LEVEL_SMOOTHING = 0.02;
+const float DUCK_GAIN = 0.3f; const int HANGOVER_FRAMES = 30;
+}
+
+MultiSource::MultiSource(std::vector<Input> inputs) {
+    for (auto& in : inputs) { Channel c; c.stats.label = in.label; c.in = std::move(in); channels.push_back(std::move(c)); }
+    levels.resize(channels.size());
+}
+
+MultiSource::~MultiSource() { stopCapture(); }
+
+std::string MultiSource::describe() const {
+    std::string s;
+    for (const auto& c : channels) s += (s.empty() ? "" : " + ") + c.in.label + ": " + c.in.source->describe();
+    return s;
+}
+
+std::vector<std::string> MultiSource::sourceLabels() const {
+    std::vector<std::string> labels;
+    for (const auto& c : channels) labels.push_back(c.in.label);
+    return labels;
+}
+
+bool MultiSource::startCapture() {
+    if (running) return false;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        if (channels[i].in.source->startCapture()) continue;
+        std::cerr << "Cannot open " << channels[i].in.label << " input " << channels[i].in.source->describe() << std::endl;
+        for (size_t j = 0; j < i; ++j) channels[j].in.source->stopCapture();
+        return false;
+    }
+    setCapturing(true);
+    running = true;
+    mixer = std::thread([this]{ loop(); });
+    return true;
+}
+
+bool MultiSource::stopCapture() {
+    if (!running.exchange(false)) return false;
+    if (mixer.joinable()) mixer.join();
+    for (auto& c : channels) c.in.source->stopCapture();
+    setCapturing(false);
+    return true;
+}
+
+void MultiSource::loop() {
+    ResourceGovernor::elevateCurrentThread();
+    const auto start = std::chrono::steady_clock::now(); auto next = start;
+    std::vector<float> chunk, buf, mix;
+    while (running) {
+        next += std::chrono::milliseconds(TICK_MS);
+        std::this_thread::sleep_until(next);
+        bool allDone = true;
+        for (auto& c : channels) {
+            size_t n = c.in.source->pendingSamples();
+            if (n && c.in.source->getAudioChunk(chunk, (int)n)) c.fifo.insert(c.fifo.end(), chunk.begin(), chunk.end());
+            if (c.in.source->finished() && c.in.source->pendingSamples() == 0) c.done = true;
+            if (!c.done || c.fifo.size() > 1) allDone = false;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t due = std::min((size_t)(elapsed * SAMPLE_RATE) - std::min(emitted, (size_t)(elapsed * SAMPLE_RATE)), (size_t)SAMPLE_RATE);
+        if (due == 0) continue;
+        mix.assign(due, 0.0f);
+        for (size_t i = 0; i < channels.size(); ++i) {
+            Channel& c = channels[i];
+            buf.assign(due, 0.0f);
+            render(c, buf.data(), due);
+            float g0 = c.gain;
+            trackLevels(c, i, buf.data(), due);
+            // Ramp to the new gain across the tick so ducking does not click.
+            for (size_t k = 0; k < due; ++k) mix[k] += buf[k] * (g0 + (c.gain - g0) * (float)(k + 1) / due);
+        }
+        for (float& v : mix) v = std::max(-1.0f, std::min(1.0f, v));
+        push(mix.data(), due);
+        emitted += due;
+        if (allDone) { ended = true; break; }
+    }
+    setCapturing(false); // wakes the loop blocked in getAudioChunk()
+}
+
+void MultiSource::render(Channel& c, float* out, size_t n) {
+    const size_t target = (size_t)SAMPLE_RATE * TARGET_MS / 1000;
+    if (!c.primed) {
+        if (c.fifo.size() < target && !(c.done && !c.fifo.empty())) return; // silence until the source has built its cushion
+        c.primed = true; c.pos = 0; c.level = (double)c.fifo.size();
+    }
+    if (c.fifo.size() > target + SAMPLE_RATE / 2) {
+        c.fifo.erase(c.fifo.begin(), c.fifo.begin() + (c.fifo.size() - target));
+        c.level = (double)target; c.integral = 0; c.overruns++;
+    }
+    c.level += ((double)c.fifo.size() - c.level) * LEVEL_SMOOTHING;
+    double err = (c.level - target) / SAMPLE_RATE;
+    c.integral = std::max(-MAX_CORRECTION / KI, std::min(MAX_CORRECTION / KI, c.integral + err * TICK_MS / 1000.0));
+    c.ratio = 1.0 + std::max(-MAX_CORRECTION, std::min(MAX_CORRECTION, KP * err + KI * c.integral));
+
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = (size_t)c.pos;
+        if (i + 1 >= c.fifo.size()) {
+            if (!c.done) { c.underruns++; c.primed = false; } // stalled: re-prime, remainder stays silent
+            break;
+        }
+        float fr = (float)(c.pos - i);
+        out[k] = c.fifo[i] + (c.fifo[i + 1] - c.fifo[i]) * fr;
+        c.pos += c.ratio;
+    }
+    size_t used = std::min((size_t)c.pos, c.fifo.size());
+    c.fifo.erase(c.fifo.begin(), c.fifo.begin() + used); c.pos -= used;
+    if (!c.primed) c.pos = 0;
+}
+
+void MultiSource::trackLevels(Channel& c, size_t idx, const float* s, size_t n) {
+    std::lock_guard<std::mutex> lock(levelMutex);
+    for (size_t k = 0; k < n; ++k) {
+        c.frameSq += s[k] * s[k];
+        if (++c.frameFill < FRAME) continue;
+        float rms = std::sqrt(c.frameSq / FRAME); c.frameSq = 0; c.frameFill = 0;
+        levels[idx].push_back(rms);
+        // Noise floor: follows quiet frames quickly and creeps up ~5%/s, so speech does not drag it along.
+        c.floor = rms < c.floor ? c.floor * 0.9f + rms * 0.1f : c.floor * 1.0005f;
+        if (rms > std::max(3.0f * c.floor, 0.002f)) c.hangover = HANGOVER_FRAMES;
+        else if (c.hangover > 0) c.hangover--;
+        if (c.hangover > 0) c.stats.active_sec += FRAME / (double)SAMPLE_RATE;
+    }
+    c.gain = c.hangover > 0 ? 1.0f : DUCK_GAIN;
+    c.stats.drift_ppm = c.stats.drift_ppm * 0.99 + (c.ratio - 1.0) * 1e6 * 0.01;
+    c.stats.underruns = c.underruns; c.stats.overruns = c.overruns;
+    if (idx + 1 == channels.size() && levels[0].size() > (size_t)HISTORY_SEC * 100) {
+        size_t drop = levels[0].size() - (size_t)HISTORY_SEC * 100;
+        for (auto& l : levels) l.erase(l.begin(), l.begin() + std::min(drop, l.size()));
+        levelBase += drop;
+    }
+}
+
+int MultiSource::dominantSource(size_t from, size_t to) const {
+    std::lock_guard<std::mutex> lock(levelMutex);
+    size_t f0 = std::max(from / FRAME, levelBase), f1 = std::max(f0 + 1, (to + FRAME - 1) / FRAME);
+    int best = -1; double bestSum = 0;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        double sum = 0;
+        for (size_t f = f0; f < f1 && f - levelBase < levels[i].size(); ++f) sum += levels[i][f - levelBase];
+        if (sum > bestSum) { bestSum = sum; best = (int)i; }
+    }
+    return best;
+}
+
+std::vector<MultiSource::SourceStats> MultiSource::stats() const {
+    std::lock_guard<std::mutex> lock(levelMutex);
+    std::vector<SourceStats> out;
+    for (const auto& c : channels) out.push_back(c.stats);
+    return out;
+}
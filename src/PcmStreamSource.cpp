@@ -0,0 +1,190 @@
+#include "PcmStreamSource.h"
+#include "Governor.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace {
+const size_t MAX_SKEW = SAMPLE_RATE / 2; // a stream further behind than this is padded with silence
+
+void set_nonblocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK); }
+
+uint32_t le32(const std::string& s, size_t o) { uint32_t v; std::memcpy(&v, s.data() + o, 4); return v; }
+uint16_t le16(const std::string& s, size_t o) { uint16_t v; std::memcpy(&v, s.data() + o, 2); return v; }
+}
+
+bool PcmDecoder::parseHeader() {
+    size_t pos = 12;
+    while (pos + 8 <= carry.size()) {
+        std::string id = carry.substr(pos, 4); uint32_t sz = le32(carry, pos + 4);
+        if (id == "data") { carry.erase(0, pos + 8); return true; } // size is often 0 or ~0 on live streams
+        if (pos + 8 + sz > carry.size()) return false;
+        if (id == "fmt " && sz >= 16) {
+            uint16_t af = le16(carry, pos + 8), nc = le16(carry, pos + 10), bps = le16(carry, pos + 22);
+            fmt.rate = (int)le32(carry, pos + 12); fmt.channels = std::max<int>(1, nc);
+            // 0xFFFE (extensible) carries the real format in a sub-GUID; the sample width is enough here.
+            if ((af == 1 || af == 0xFFFE) && bps == 16) fmt.enc = Encoding::S16LE;
+            else if ((af == 3 || af == 0xFFFE) && bps == 32) fmt.enc = Encoding::F32LE;
+            else std::cerr << "Unsupported WAV input (format " << af << ", " << bps << " bit); decoding as 16-bit PCM" << std::endl;
+        }
+        pos += 8 + sz + (sz & 1);
+    }
+    return false;
+}
+
+void PcmDecoder::feed(const char* data, size_t n, std::vector<float>& out) {
+    carry.append(data, n);
+    if (!headerChecked) {
+        if (carry.size() < 12) return;
+        if (carry.compare(0, 4, "RIFF") == 0 && carry.compare(8, 4, "WAVE") == 0 && !parseHeader()) return;
+        headerChecked = true;
+    }
+    const size_t width = fmt.enc == Encoding::F32LE ? 4 : 2, frame = width * fmt.channels;
+    const size_t frames = carry.size() / frame;
+    if (frames == 0) return;
+    std::vector<float> mono(frames);
+    const char* p = carry.data();
+    for (size_t i = 0; i < frames; ++i) {
+        float s = 0;
+        for (int c = 0; c < fmt.channels; ++c, p += width) {
+            if (fmt.enc == Encoding::S16LE) { int16_t v; std::memcpy(&v, p, 2); s += v / 32768.0f; }
+            else { float v; std::memcpy(&v, p, 4); s += v; }
+        }
+        mono[i] = s / fmt.channels;
+    }
+    carry.erase(0, frames * frame);
+
+    if (fmt.rate == SAMPLE_RATE) { out.insert(out.end(), mono.begin(), mono.end()); return; }
+    // Linear interpolation; prev is the last sample of the previous feed (index -1), so the output is
+    // continuous across chunk boundaries.
+    const double step = (double)fmt.rate / SAMPLE_RATE;
+    if (!primed) { prev = mono[0]; primed = true; }
+    while (pos <= (double)(frames - 1)) {
+        long i = (long)std::floor(pos); double fr = pos - i;
+        float a = i < 0 ? prev : mono[i], b = i + 1 < (long)frames ? mono[i + 1] : a;
+        out.push_back(a + (float)((b - a) * fr));
+        pos += step;
+    }
+    pos -= frames; prev = mono[frames - 1];
+}
+
+PcmStreamSource::PcmStreamSource(const std::string& target, PcmDecoder::Format raw) : target(target), raw(raw) {}
+
+PcmStreamSource::~PcmStreamSource() { stopCapture(); }
+
+bool PcmStreamSource::startCapture() {
+    if (running) return false;
+    if (target == "-" || target == "stdin") {
+        // The flags belong to the file description we share with the shell or upstream process: put them back on stop.
+        fd = STDIN_FILENO; stdinFlags = fcntl(fd, F_GETFL, 0); set_nonblocking(fd);
+        streams.push_back({fd, PcmDecoder(raw), {}});
+    } else if (target.rfind("fifo:", 0) == 0) {
+        path = target.substr(5); struct stat st;
+        if (::stat(path.c_str(), &st) != 0 && ::mkfifo(path.c_str(), 0600) != 0) { std::cerr << "Cannot create FIFO " << path << ": " << std::strerror(errno) << std::endl; return false; }
+        fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+        if (fd < 0) { std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl; return false; }
+        // Holding a write end ourselves means writers can come and go without the reader ever seeing EOF.
+        keepaliveFd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK);
+        streams.push_back({fd, PcmDecoder(raw), {}});
+    } else {
+        path = target.substr(5);
+        sockaddr_un addr{}; addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) { std::cerr << "Invalid socket path: " << path << std::endl; return false; }
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(path.c_str());
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 || ::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 8) != 0) {
+            std::cerr << "Cannot bind " << path << ": " << std::strerror(errno) << std::endl;
+            if (listenFd >= 0) { ::close(listenFd); listenFd = -1; }
+            return false;
+        }
+        set_nonblocking(listenFd);
+    }
+    if (::pipe(wakePipe) != 0) { if (stdinFlags >= 0) { fcntl(STDIN_FILENO, F_SETFL, stdinFlags); stdinFlags = -1; } streams.clear(); return false; }
+    set_nonblocking(wakePipe[0]);
+    setCapturing(true);
+    running = true;
+    reader = std::thread([this]{ readerLoop(); });
+    return true;
+}
+
+bool PcmStreamSource::stopCapture() {
+    if (!running.exchange(false)) return false;
+    if (wakePipe[1] >= 0) { char c = 1; (void)!::write(wakePipe[1], &c, 1); }
+    if (reader.joinable()) reader.join();
+    for (auto& s : streams) if (s.fd > STDIN_FILENO) ::close(s.fd);
+    streams.clear();
+    if (stdinFlags >= 0) { fcntl(STDIN_FILENO, F_SETFL, stdinFlags); stdinFlags = -1; }
+    if (keepaliveFd >= 0) { ::close(keepaliveFd); keepaliveFd = -1; }
+    if (listenFd >= 0) { ::close(listenFd); listenFd = -1; ::unlink(path.c_str()); }
+    for (int& p : wakePipe) if (p >= 0) { ::close(p); p = -1; }
+    setCapturing(false);
+    return true;
+}
+
+void PcmStreamSource::readerLoop() {
+    ResourceGovernor::prepareAudioThread();
+    std::vector<char> buf(64 * 1024);
+    while (running) {
+        std::vector<pollfd> fds{{wakePipe[0], POLLIN, 0}};
+        if (listenFd >= 0) fds.push_back({listenFd, POLLIN, 0});
+        const size_t first = fds.size();
+        for (const auto& s : streams) fds.push_back({s.fd, POLLIN, 0});
+        if (::poll(fds.data(), fds.size(), 200) < 0 && errno != EINTR) break;
+        char drain[16]; while (::read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+
+        for (size_t i = 0; i < streams.size() && first + i < fds.size(); ++i) {
+            if (!(fds[first + i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Stream& s = streams[i];
+            ssize_t n;
+            while ((n = ::read(s.fd, buf.data(), buf.size())) > 0) s.dec.feed(buf.data(), (size_t)n, s.pending);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                if (s.fd > STDIN_FILENO) ::close(s.fd);
+                s.fd = -1; // mixed out once its pending samples are used, then dropped
+            }
+        }
+        if (listenFd >= 0) {
+            int c;
+            while ((c = ::accept(listenFd, nullptr, nullptr)) >= 0) { set_nonblocking(c); streams.push_back({c, PcmDecoder(raw), {}}); }
+        }
+        bool stdinDone = fd == STDIN_FILENO && !streams.empty() && streams[0].fd < 0;
+        mix(stdinDone);
+        if (stdinDone) { ended = true; break; }
+    }
+    mix(true);
+    setCapturing(false); // wakes the loop blocked in getAudioChunk()
+}
+
+void PcmStreamSource::mix(bool flushAll) {
+    // Streams are aligned by arrival time: the slowest open stream sets how much can be mixed, unless it
+    // has fallen more than MAX_SKEW behind, in which case the others go ahead and it is padded with silence.
+    size_t lo = SIZE_MAX, hi = 0;
+    for (const auto& s : streams) { if (s.fd >= 0) lo = std::min(lo, s.pending.size()); hi = std::max(hi, s.pending.size()); }
+    size_t n = (flushAll || lo == SIZE_MAX || hi - lo > MAX_SKEW) ? hi : lo;
+    if (n > 0) {
+        if (streams.size() == 1) {
+            push(streams[0].pending.data(), n);
+            streams[0].pending.erase(streams[0].pending.begin(), streams[0].pending.begin() + n);
+        } else {
+            std::vector<float> out(n, 0.0f);
+            for (auto& s : streams) {
+                size_t m = std::min(n, s.pending.size());
+                for (size_t i = 0; i < m; ++i) out[i] += s.pending[i];
+                s.pending.erase(s.pending.begin(), s.pending.begin() + m);
+            }
+            for (float& v : out) v = std::max(-1.0f, std::min(1.0f, v));
+            push(out.data(), n);
+        }
+    }
+    if (fd != STDIN_FILENO)
+        streams.erase(std::remove_if(streams.begin(), streams.end(), [](const Stream& s) { return s.fd < 0 && s.pending.empty(); }), streams.end());
+}
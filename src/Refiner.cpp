@@ -0,0 +1,113 @@
+#include "Refiner.h"
+#include "AudioSource.h"
+#include "Autotune.h"
+#include "Reports.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <chrono>
+
+Refiner::Refiner(Transcriber& model, const Config::Data& config, std::shared_ptr<TranscriptStore> transcript, ResourceGovernor& governor,
+                 RevisedCallback onRevised)
+    : model(model), config(config), transcript(std::move(transcript)), governor(governor), onRevised(std::move(onRevised)),
+      maxQueuedSamples((size_t)std::max(0, config.refine_queue_sec) * SAMPLE_RATE) {
+    prompt.budget = config.prompt_tokens;
+}
+
+Refiner::~Refiner() {
+    std::unique_lock<std::mutex> lock(mutex);
+    stopping = true;
+    cv.wait(lock, [&]{ return !active; });
+}
+
+void Refiner::submit(const std::vector<float>& pcm, int64_t off_ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // A paused or slower second pass must not hold the whole session's audio: drop the oldest windows unrefined.
+    while (!queue.empty() && queuedSamples + pcm.size() > maxQueuedSamples) {
+        size_t n = queue.front().pcm.size();
+        counters.dropped++; counters.dropped_sec += n / (double)SAMPLE_RATE;
+        queuedSamples -= n; queue.pop_front();
+    }
+    queue.push_back({pcm, off_ms}); queuedSamples += pcm.size();
+    kick();
+}
+
+void Refiner::finish() {
+    auto t0 = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    draining = true;
+    kick();
+    cv.wait(lock, [&]{ return queue.empty() && !active; });
+    counters.drain_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+Refiner::Stats Refiner::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s = counters; s.pending = (int)queue.size();
+    return s;
+}
+
+void Refiner::kick() {
+    if (active || stopping || queue.empty() || (!draining && governor.profile() == ResourceGovernor::Profile::Realtime)) return;
+    active = true;
+    Scheduler::shared().post(Scheduler::Lane::Refine, [this]{ step(); });
+}
+
+// One window per task, so a drain never holds a worker longer than a single decode.
+void Refiner::step() {
+    Window w; bool drain;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping || queue.empty()) { active = false; cv.notify_all(); return; }
+        w = std::move(queue.front()); queue.pop_front(); drain = draining; queuedSamples -= w.pcm.size();
+    }
+    refine(w, drain);
+    std::lock_guard<std::mutex> lock(mutex);
+    active = false;
+    kick();
+    cv.notify_all();
+}
+
+void Refiner::refine(const Window& w, bool drain) {
+    if (!model.isLoaded()) return;
+    if (!vocabTokenized) { vocabTokenized = true; if (!config.vocabulary.empty()) prompt.vocabulary = model.tokenize(" " + config.vocabulary); }
+    const int64_t end_ms = w.off_ms + (int64_t)(w.pcm.size() * 1000 / SAMPLE_RATE);
+    if (w.off_ms - lastSpeechMs > config.prompt_reset_ms) prompt.history.clear();
+    lastSpeechMs = end_ms;
+
+    auto t0 = std::chrono::steady_clock::now(); std::vector<TranscriptionSegment> segs;
+    int threads = drain ? default_threads(config) : governor.spareThreads();
+    governor.run([&]{ segs = model.transcribe(w.pcm, threads, prompt); }, threads,
+                 drain ? ResourceGovernor::Profile::Realtime : ResourceGovernor::Profile::Background);
+    double proc = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::vector<TranscriptStore::Entry> live;
+    transcript->forEach([&](TranscriptStore::Id, const TranscriptStore::Entry& e) { if (e.t0_ms >= w.off_ms && e.t0_ms < end_ms) live.push_back(e); });
+    std::string before, after;
+    for (const auto& e : live) before += std::string(e.text) + " ";
+
+    std::vector<TranscriptionSegment> kept; std::vector<TranscriptStore::Entry> entries;
+    for (auto s : segs) {
+        trim(s.text); if (s.text.length() < 2) continue;
+        s.t0 = s.t0 * 10 + w.off_ms; s.t1 = s.t1 * 10 + w.off_ms;
+        int64_t best = 0;
+        for (const auto& e : live) {
+            int64_t overlap = std::min(s.t1, e.t1_ms) - std::max(s.t0, e.t0_ms);
+            if (overlap > best) { best = overlap; s.speaker_id = e.speaker; }
+        }
+        if (best == 0 && !live.empty()) s.speaker_id = live.front().speaker;
+        after += s.text + " ";
+        kept.push_back(s);
+    }
+    // Strings in kept own the text until replace() has copied it into the arena.
+    for (const auto& s : kept) entries.push_back({s.t0, s.t1, s.speaker_id, s.text});
+    // An empty second pass over audio the live model found words in is more likely a failure than silence.
+    bool changed = before != after;
+    if (changed && !(kept.empty() && !live.empty())) {
+        transcript->replace(w.off_ms, end_ms, entries);
+        if (onRevised) onRevised(w.off_ms, end_ms, kept);
+    } else changed = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.windows++; counters.changed += changed;
+    counters.audio_sec += w.pcm.size() / (double)SAMPLE_RATE; counters.proc_sec += proc;
+}
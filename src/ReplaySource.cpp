@@ -0,0 +1,83 @@
+#include "ReplaySource.h"
+#include "AudioFile.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+bool ReplaySource::startCapture() {
+    if (running) return false;
+    if (pcm.empty() && !load_audio_file(path, pcm)) { std::cerr << "Could not read " << path << std::endl; return false; }
+    delivered = 0; ended = false;
+    started = std::chrono::steady_clock::now();
+    setCapturing(true);
+    running = true;
+    feeder = std::thread([this]{ feedLoop(); });
+    return true;
+}
+
+bool ReplaySource::stopCapture() {
+    if (!running.exchange(false)) return false;
+    if (feeder.joinable()) feeder.join();
+    setCapturing(false);
+    return true;
+}
+
+std::string ReplaySource::describe() const {
+    std::stringstream ss; ss << "replay of " << path << " (";
+    if (speed > 0) ss << speed << "x)"; else ss << "max speed)";
+    return ss.str();
+}
+
+double ReplaySource::clock() const {
+    if (speed <= 0) return delivered / (double)SAMPLE_RATE;
+    return std::min(durationSec(), std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() * speed);
+}
+
+void ReplaySource::feedLoop() {
+    const size_t chunk = SAMPLE_RATE / 10;
+    while (running && delivered < pcm.size()) {
+        size_t target;
+        if (speed <= 0) {
+            // One chunk in flight: the capture loop's getAudioChunk() gets exactly the same pieces every run.
+            if (pendingSamples() >= chunk) { std::this_thread::sleep_for(std::chrono::microseconds(200)); continue; }
+            target = delivered + chunk;
+        } else {
+            target = (size_t)(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() * speed * SAMPLE_RATE);
+            // Whole chunks only, except the tail once the clock has passed the end of the recording.
+            const size_t done = delivered;
+            target = target >= pcm.size() ? pcm.size() : target < done ? done : done + (target - done) / chunk * chunk;
+        }
+        target = std::min(target, pcm.size());
+        if (target == delivered) { std::this_thread::sleep_for(std::chrono::milliseconds(5)); continue; }
+        push(pcm.data() + delivered, target - delivered);
+        delivered = target;
+    }
+    ended = delivered >= pcm.size();
+    setCapturing(false); // wakes the loop blocked in getAudioChunk()
+}
+
+void ReplaySource::recordSegment(double end_sec, double consumed_sec) {
+    double now = speed <= 0 ? consumed_sec : clock();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    latencies.push_back(std::max(0.0, now - end_sec));
+}
+
+void ReplaySource::recordWindow(double audio_sec, double proc_sec, double backlog_sec) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    windows++; audioSec += audio_sec; procSec += proc_sec; backlogs.push_back(backlog_sec);
+}
+
+std::string ReplaySource::summary() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    auto pct = [](std::vector<double> v, double p) { if (v.empty()) return 0.0; std::sort(v.begin(), v.end()); return v[std::min(v.size() - 1, (size_t)(v.size() * p))]; };
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(), backlogMean = 0;
+    for (double b : backlogs) backlogMean += b;
+    if (!backlogs.empty()) backlogMean /= backlogs.size();
+    std::stringstream ss; ss << std::fixed << std::setprecision(1);
+    ss << "Replay: " << delivered / (double)SAMPLE_RATE << " s of audio in " << wall << " s (" << (wall > 0 ? delivered / (double)SAMPLE_RATE / wall : 0.0) << "x), "
+       << windows << " windows, RTF " << std::setprecision(2) << (audioSec > 0 ? procSec / audioSec : 0.0) << std::setprecision(1)
+       << "; latency p50/p95/max " << pct(latencies, 0.5) << "/" << pct(latencies, 0.95) << "/" << pct(latencies, 1.0) << " s"
+       << (speed <= 0 ? " (windowing only)" : "") << "; backlog mean/max " << std::setprecision(2) << backlogMean << "/" << pct(backlogs, 1.0) << " s";
+    return ss.str();
+}
@@ -0,0 +1,267 @@
+#include "Reports.h"
+#include "LLMClients.h"
+#include "Integrations.h"
+#include "SearchIndex.h"
+#include "Export.h"
+#include "Scheduler.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <atomic>
+
+namespace fs = std::filesystem;
+
+void trim(std::string& s) {
+    if (s.empty()) return;
+    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch); }));
+    s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) { return !std::isspace(ch); }).base(), s.end());
+    if (s.size() >= 2 && s.front() == '"' && s.back() == '"') s = s.substr(1, s.size() - 2);
+}
+
+std::string format_timestamp(int64_t t_ms) {
+    int64_t total_sec = t_ms / 1000;
+    int h = (int)(total_sec / 3600);
+    int m = (int)((total_sec % 3600) / 60);
+    int s = (int)(total_sec % 60);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02d:%02d:%02d", h, m, s);
+    return std::string(buf);
+}
+
+std::string format_segment_line(int64_t t_ms, int speaker, std::string_view text) {
+    std::string line = format_timestamp(t_ms);
+    if (speaker >= 0) line += " [Speaker " + std::to_string(speaker + 1) + "]";
+    line += ": "; line.append(text.data(), text.size());
+    return line;
+}
+
+std::string md_to_html(const std::string& md) {
+    std::stringstream html;
+    std::istringstream iss(md);
+    std::string line;
+    bool in_list = false;
+
+    auto process_inline = [](std::string s) {
+        size_t b;
+        while ((b = s.find("**")) != std::string::npos) {
+            size_t e = s.find("**", b + 2);
+            if (e != std::string::npos) {
+                s.replace(e, 2, "</strong>");
+                s.replace(b, 2, "<strong>");
+            } else break;
+        }
+        while ((b = s.find("[[")) != std::string::npos) {
+            size_t e = s.find("]]", b + 2);
+            if (e != std::string::npos) {
+                s.erase(e, 2);
+                s.erase(b, 2);
+            } else break;
+        }
+        return s;
+    };
+
+    while (std::getline(iss, line)) {
+        trim(line);
+        if (line.empty()) continue;
+
+        if (line.rfind("- ", 0) == 0 || line.rfind("* ", 0) == 0) {
+            if (!in_list) { html << "<ul>"; in_list = true; }
+            std::string content = line.substr(2);
+            trim(content);
+            if (content.rfind("[ ]", 0) == 0) content = "<input type='checkbox' disabled> " + content.substr(3);
+            else if (content.rfind("[x]", 0) == 0) content = "<input type='checkbox' checked disabled> " + content.substr(3);
+            html << "<li>" << process_inline(content) << "</li>";
+        } else {
+            if (in_list) { html << "</ul>"; in_list = false; }
+            if (line.rfind("### ", 0) == 0) html << "<h4>" << process_inline(line.substr(4)) << "</h4>";
+            else if (line.rfind("## ", 0) == 0) html << "<h3>" << process_inline(line.substr(3)) << "</h3>";
+            else if (line.rfind("# ", 0) == 0) html << "<h2>" << process_inline(line.substr(2)) << "</h2>";
+            else if (line.rfind("> ", 0) == 0) html << "<blockquote>" << process_inline(line.substr(2)) << "</blockquote>";
+            else html << "<p>" << process_inline(line) << "</p>";
+        }
+    }
+    if (in_list) html << "</ul>";
+    return html.str();
+}
+
+void sync_action_items(const std::string& acts, const Config::Data& config, const std::string& meeting_title) {
+    auto trackers = IntegrationFactory::createTrackers(config);
+    if (trackers.empty()) return;
+    std::istringstream iss(acts);
+    std::string line; std::vector<std::string> tasks;
+    while (std::getline(iss, line)) {
+        trim(line);
+        if (line.empty()) continue;
+        if (line.rfind("- ", 0) == 0) {
+            std::string task = line.substr(2);
+            if (task.rfind("[ ] ", 0) == 0) task = task.substr(4);
+            std::cout << "Syncing: " << task << std::endl;
+            tasks.push_back(task);
+        }
+    }
+    // Trackers are independent; each gets its issues in order on the Sync lane.
+    std::vector<Scheduler::Future<void>> pending;
+    for (auto& tracker : trackers)
+        pending.push_back(Scheduler::shared().submit(Scheduler::Lane::Sync, [&tasks, &meeting_title, t = tracker.get()] {
+            for (const auto& task : tasks) t->createIssue(task, "Automatically created from meeting: " + meeting_title);
+        }));
+    for (auto& f : pending) f.get();
+}
+
+// Section name -> content of its ---NAME--- block in the analysis reply.
+using ReportSections = std::map<std::string, std::string>;
+
+// Sections requested together in parallel mode; each group is an independent, smaller completion.
+static const std::vector<std::vector<std::string>> SECTION_GROUPS = {
+    {"PARTICIPANTS", "TAGS", "TITLE", "TOPIC", "YAML_SUMMARY", "OVERVIEW_SUMMARY", "KEY_TAKEAWAYS"},
+    {"AGENDA_ITEMS", "DISCUSSION_POINTS", "QUESTIONS_ARISEN"},
+    {"DECISIONS_MADE", "ACTION_ITEMS"},
+    {"MERMAID_GRAPH"},
+    {"EMAIL_DRAFT"},
+};
+static const int SECTION_ATTEMPTS = 3;
+
+static bool reply_ok(const std::string& reply) {
+    return !reply.empty() && !(reply.find("Error") != std::string::npos && reply.length() < 150);
+}
+
+// Copies the requested blocks found in reply into out and removes them from names; the rest stay pending.
+static void parse_sections(const std::string& reply, std::vector<std::string>& names, ReportSections& out) {
+    for (auto it = names.begin(); it != names.end();) {
+        std::string marker = "---" + *it + "---";
+        size_t st = reply.find(marker);
+        if (st == std::string::npos) { ++it; continue; }
+        st += marker.length(); size_t en = reply.find("---", st);
+        std::string v = reply.substr(st, (en == std::string::npos) ? std::string::npos : en - st);
+        trim(v);
+        if (v.length() >= 3 && v.substr(v.length() - 3) == "---") v = v.substr(0, v.length() - 3);
+        trim(v);
+        out[*it] = v; it = names.erase(it);
+    }
+}
+
+static void write_partial(const std::string& path, const ReportSections& sec, const std::string& research) {
+    std::stringstream md;
+    md << "# Report in progress\n\n";
+    for (const auto& r : REPORT_SECTIONS) {
+        auto it = sec.find(r.name);
+        md << "## " << r.name << "\n" << (it == sec.end() ? "_pending_" : it->second) << "\n\n";
+    }
+    if (!research.empty()) md << "## RESEARCH\n" << research << "\n";
+    write_file_atomic(path, md.str());
+}
+
+// Requests the section groups (and research) concurrently, at most config.llm_concurrency at a time, each
+// worker with its own client so requests are not serialized on one connection. Every landed group is
+// merged and the partial report rewritten; a group that comes back incomplete is re-requested for its
+// missing sections only. Returns false if nothing could be generated.
+static bool analyze_parallel(const std::string& transcription, const Config::Data& config, bool speakerLabels,
+                             const std::string& partialPath, ReportSections& out, std::string& research) {
+    bool withResearch = config.research && config.provider == "gemini";
+    size_t n_tasks = SECTION_GROUPS.size() + (withResearch ? 1 : 0);
+    std::atomic<size_t> next{0}; std::mutex outMutex;
+    const std::string input = "Transcription:\n" + transcription;
+    auto t_start = std::chrono::steady_clock::now();
+
+    auto worker = [&] {
+        auto client = ClientFactory::createClient(config.provider, config.api_key, config.llm_model, config.llm_base_url);
+        if (!client) return;
+        for (size_t task; (task = next++) < n_tasks;) {
+            if (task == SECTION_GROUPS.size()) {
+                std::string r;
+                try { r = client->researchTopics(transcription); } catch (const std::exception& e) { r = std::string("Research failed: ") + e.what(); }
+                std::lock_guard<std::mutex> lock(outMutex);
+                if (r.rfind("Research failed", 0) != 0) { research = r; write_partial(partialPath, out, research); }
+                continue;
+            }
+            std::vector<std::string> pending = SECTION_GROUPS[task];
+            ReportSections got;
+            // A throwing client fails this group only; the other workers keep going.
+            try {
+                for (int attempt = 0; attempt < SECTION_ATTEMPTS && !pending.empty(); ++attempt) {
+                    std::string reply = client->generate(get_obsidian_prompt(config.persona, speakerLabels, pending), input);
+                    if (reply_ok(reply)) parse_sections(reply, pending, got);
+                }
+            } catch (const std::exception& e) { std::lock_guard<std::mutex> lock(outMutex); std::cerr << "  " << SECTION_GROUPS[task].front() << ": " << e.what() << std::endl; }
+            auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+            std::lock_guard<std::mutex> lock(outMutex);
+            for (auto& kv : got) out[kv.first] = kv.second;
+            std::cout << "  [" << std::fixed << std::setprecision(1) << secs << "s] " << SECTION_GROUPS[task].front()
+                      << (SECTION_GROUPS[task].size() > 1 ? "..." : "") << (pending.empty() ? " done" : " incomplete") << ", " << format_usage(client->lastUsage()) << std::endl;
+            if (!got.empty()) write_partial(partialPath, out, research);
+        }
+    };
+    std::vector<Scheduler::Future<void>> pool;
+    for (size_t i = 0; i < std::min<size_t>(std::max(1, config.llm_concurrency), n_tasks); ++i) pool.push_back(Scheduler::shared().submit(Scheduler::Lane::Render, worker));
+    // Workers share this frame's locals: let every one finish before a failure can unwind it.
+    for (auto& f : pool) f.wait();
+    for (auto& f : pool) f.get();
+    return !out.empty();
+}
+
+static void index_meeting(const std::vector<SearchIndex::Segment>& segments, const std::string& name, const std::string& path) {
+    if (segments.empty()) return;
+    if (!SearchIndex().addMeeting(name, path, (int64_t)std::time(nullptr), segments)) std::cerr << "Search index not updated for " << name << std::endl;
+}
+
+std::string save_meeting_reports(const std::string& transcription, const std::vector<SearchIndex::Segment>& segments,
+                                 const Config::Data& config, const std::string& baseName) {
+    if (transcription.empty()) return "";
+    std::string finalOutputDir = (config.mode == "obsidian" && !config.obsidian_vault_path.empty()) ? config.obsidian_vault_path : config.output_dir;
+    fs::create_directories(finalOutputDir);
+    
+    std::string tPath = finalOutputDir + "/" + baseName + "_transcript.md";
+    write_file_atomic(tPath, transcription);
+
+    if (config.provider.empty()) { index_meeting(segments, baseName, tPath); return tPath; }
+    auto client = ClientFactory::createClient(config.provider, config.api_key, config.llm_model, config.llm_base_url);
+    if (!client) { index_meeting(segments, baseName, tPath); return tPath; }
+
+    std::cout << "Analyzing Meeting Content..." << std::endl;
+    bool speakerLabels = transcription.find(" [Speaker ") != std::string::npos;
+    ReportSections sec; std::string research;
+    if (config.report_mode == "parallel") {
+        std::string partialPath = finalOutputDir + "/" + baseName + "_report.partial.md";
+        bool ok = analyze_parallel(transcription, config, speakerLabels, partialPath, sec, research);
+        fs::remove(partialPath);
+        if (!ok) { std::cerr << "Analysis failed: no section could be generated." << std::endl; index_meeting(segments, baseName, tPath); return tPath; }
+    } else {
+        std::string master = client->generate(get_obsidian_prompt(config.persona, speakerLabels), "Transcription:\n" + transcription);
+        std::cout << "LLM: " << format_usage(client->lastUsage()) << std::endl;
+        if (!reply_ok(master)) {
+            std::cerr << "Analysis failed: " << master << std::endl;
+            index_meeting(segments, baseName, tPath);
+            return tPath;
+        }
+        std::vector<std::string> all; for (const auto& r : REPORT_SECTIONS) all.push_back(r.name);
+        parse_sections(master, all, sec);
+        if (config.research && config.provider == "gemini") research = client->researchTopics(transcription);
+    }
+
+    MeetingReport report;
+    report.title = sec["TITLE"];
+    if (report.title.empty() || report.title.length() < 3) report.title = "Meeting " + baseName;
+    std::string san = report.title; for (char& c : san) { if (std::isspace(c)) c = '-'; else if (!std::isalnum(c) && c != '-') c = '_'; }
+
+    auto now = std::chrono::system_clock::now(); auto t_now = std::chrono::system_clock::to_time_t(now);
+    std::stringstream date_ss; date_ss << std::put_time(std::localtime(&t_now), "%Y-%m-%d");
+    report.date = date_ss.str(); report.persona = config.persona; report.baseName = baseName;
+    report.transcription = transcription; report.research = research; report.sections = std::move(sec);
+    report.outputDir = finalOutputDir; report.fileBase = san + "-" + report.date;
+
+    auto timings = run_exports(report, create_writers(config));
+    std::cout << "[Success] Amazing reports generated: " << report.fileBase << "\n";
+    std::cout << "Export:";
+    for (const auto& t : timings) std::cout << " " << t.writer << " " << std::fixed << std::setprecision(1) << t.ms << "ms" << (t.ok ? "" : " (failed)");
+    std::cout << std::endl;
+    index_meeting(segments, report.title, report.path(".md"));
+    return report.path(".md");
+}
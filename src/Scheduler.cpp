@@ -0,0 +1,183 @@
+#include "Scheduler.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+thread_local Scheduler* tlsOwner = nullptr;
+thread_local int tlsWorker = -1;
+
+int log2_bucket(double us) {
+    int b = 0;
+    for (double v = us; v >= 1.0 && b < 31; v /= 2) b++;
+    return b;
+}
+}
+
+void Scheduler::StateBase::finish() {
+    std::vector<std::function<void()>> run;
+    { std::lock_guard<std::mutex> lock(m); done = true; run.swap(continuations); }
+    cv.notify_all();
+    for (auto& fn : run) fn();
+}
+
+void Scheduler::StateBase::onDone(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (!done) { continuations.push_back(std::move(fn)); return; }
+    }
+    fn();
+}
+
+Scheduler::Reservation::~Reservation() {
+    if (!owner) return;
+    owner->reserved -= cores;
+    { std::lock_guard<std::mutex> lock(owner->sleepMutex); owner->signal++; }
+    owner->wake.notify_all();
+}
+
+Scheduler& Scheduler::shared() {
+    // Never destroyed: tasks may still be running (e.g. a copilot request) while statics are torn down at exit.
+    static Scheduler* s = new Scheduler(std::max(2, (int)std::thread::hardware_concurrency()));
+    return *s;
+}
+
+Scheduler::Scheduler(int n) {
+    for (int i = 0; i < n; ++i) pool.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < n; ++i) threads.emplace_back([this, i]{ loop(i); });
+}
+
+const char* Scheduler::laneName(Lane lane) {
+    static const char* names[LANES] = {"live", "copilot", "refine", "render", "sync"};
+    return names[(int)lane];
+}
+
+void Scheduler::post(Lane lane, std::function<void()> fn) {
+    int l = (int)lane;
+    Task t{std::move(fn), lane, std::chrono::steady_clock::now()};
+    { std::lock_guard<std::mutex> lock(statsMutex); queuedCount[l]++; }
+    // Spawned from a task: stays on this worker (newest first) unless another worker steals it.
+    if (tlsOwner == this) { std::lock_guard<std::mutex> lock(pool[tlsWorker]->m); pool[tlsWorker]->q[l].push_back(std::move(t)); }
+    else { std::lock_guard<std::mutex> lock(globalMutex); global[l].push_back(std::move(t)); }
+    { std::lock_guard<std::mutex> lock(sleepMutex); signal++; }
+    wake.notify_one();
+}
+
+Scheduler::Reservation Scheduler::reserve(int cores) {
+    reserved += std::max(0, cores);
+    return Reservation(this, std::max(0, cores));
+}
+
+bool Scheduler::take(int self, Task& out, bool inline_) {
+    const int n = (int)pool.size();
+    bool slot = false;
+    for (int l = 0; l < LANES; ++l) {
+        if (l > 0 && !inline_ && !slot) {
+            // Lanes below Live share the cores no reservation holds (at least one worker).
+            int allowed = std::max(1, n - reserved.load()), cur = belowLive.load();
+            do { if (cur >= allowed) return false; } while (!belowLive.compare_exchange_weak(cur, cur + 1));
+            slot = true;
+        }
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lock(pool[self]->m);
+            auto& q = pool[self]->q[l];
+            if (!q.empty()) { out = std::move(q.back()); q.pop_back(); found = true; }
+        }
+        if (!found) {
+            std::lock_guard<std::mutex> lock(globalMutex);
+            if (!global[l].empty()) { out = std::move(global[l].front()); global[l].pop_front(); found = true; }
+        }
+        for (int k = 1; !found && k < n; ++k) {
+            Worker& victim = *pool[(self + k) % n];
+            std::lock_guard<std::mutex> lock(victim.m);
+            if (!victim.q[l].empty()) { out = std::move(victim.q[l].front()); victim.q[l].pop_front(); found = true; }
+        }
+        if (found) return true;
+    }
+    if (slot) belowLive--;
+    return false;
+}
+
+void Scheduler::run(Task& t) {
+    const int l = (int)t.lane;
+    auto start = std::chrono::steady_clock::now();
+    double queue_ms = std::chrono::duration<double, std::milli>(start - t.queued).count();
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        Counters& c = counters[l];
+        queuedCount[l]--; c.tasks++; c.running++; c.queue_ms += queue_ms; c.queue_ms_max = std::max(c.queue_ms_max, queue_ms);
+        c.hist[log2_bucket(queue_ms * 1000)]++;
+    }
+    try { t.fn(); }
+    catch (const std::exception& e) { std::cerr << "Scheduler: " << laneName(t.lane) << " task failed: " << e.what() << std::endl; }
+    catch (...) { std::cerr << "Scheduler: " << laneName(t.lane) << " task failed" << std::endl; }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    counters[l].running--;
+    counters[l].run_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Scheduler::loop(int self) {
+    tlsOwner = this; tlsWorker = self;
+    for (;;) {
+        uint64_t seen;
+        { std::lock_guard<std::mutex> lock(sleepMutex); seen = signal; }
+        Task t;
+        if (take(self, t, false)) {
+            run(t);
+            if (t.lane != Lane::Live) {
+                belowLive--;
+                { std::lock_guard<std::mutex> lock(sleepMutex); signal++; }
+                wake.notify_one();
+            }
+            continue;
+        }
+        // Anything posted or released since `seen` bumps the signal, so no wakeup is lost.
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [&]{ return signal != seen; });
+    }
+}
+
+void Scheduler::wait(StateBase& s) {
+    if (tlsOwner != this) {
+        std::unique_lock<std::mutex> lock(s.m);
+        s.cv.wait(lock, [&]{ return s.done; });
+        return;
+    }
+    // On a worker: keep the pool going (possibly with the very tasks awaited) instead of blocking a core.
+    for (;;) {
+        { std::lock_guard<std::mutex> lock(s.m); if (s.done) return; }
+        Task t;
+        if (take(tlsWorker, t, true)) { run(t); continue; }
+        std::unique_lock<std::mutex> lock(s.m);
+        s.cv.wait_for(lock, std::chrono::milliseconds(1), [&]{ return s.done; });
+    }
+}
+
+Scheduler::LaneStats Scheduler::stats(Lane lane) const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    const Counters& c = counters[(int)lane];
+    LaneStats s; s.tasks = c.tasks; s.queued = queuedCount[(int)lane]; s.running = c.running; s.run_ms = c.run_ms; s.queue_ms_max = c.queue_ms_max;
+    if (c.tasks == 0) return s;
+    s.queue_ms_mean = c.queue_ms / c.tasks;
+    long seen = 0;
+    for (int b = 0; b < 32; ++b) {
+        seen += c.hist[b];
+        if (seen * 100 >= c.tasks * 95) { s.queue_ms_p95 = std::min(c.queue_ms_max, (1u << b) / 1000.0); break; }
+    }
+    return s;
+}
+
+std::string Scheduler::summary() const {
+    std::stringstream ss; ss << std::fixed << std::setprecision(1) << "Scheduler (" << pool.size() << " workers):";
+    bool any = false;
+    for (int l = 0; l < LANES; ++l) {
+        LaneStats s = stats((Lane)l);
+        if (!s.tasks) continue;
+        ss << (any ? ";" : "") << " " << laneName((Lane)l) << " " << s.tasks << " tasks, queue mean/p95/max " << s.queue_ms_mean << "/" << s.queue_ms_p95 << "/" << s.queue_ms_max << " ms";
+        any = true;
+    }
+    if (!any) ss << " idle";
+    return ss.str();
+}
@@ -0,0 +1,303 @@
+#include "SearchIndex.h"
+#include "Config.h"
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+#include <chrono>
+#include <atomic>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+const uint32_t VERSION = 2; // 2: speakers 0-based (1 stored the transcript's 1-based labels)
+const size_t COMPACT_THRESHOLD = 32;
+const size_t MAX_TOKEN = 32;
+const double BM25_K1 = 1.2, BM25_B = 0.75;
+
+#pragma pack(push, 1)
+struct FileHeader { char magic[4]; uint32_t version, n_meetings, n_docs, n_terms; uint64_t off_meetings, off_docs, off_terms, off_postings, off_strings, total_tokens; };
+struct MeetingRec { uint32_t name_off, name_len, path_off, path_len; int64_t date_unix; };
+struct DocRec { uint32_t meeting; int32_t speaker; int64_t t_ms; uint32_t text_off, text_len, n_tokens, pad; };
+struct TermRec { uint32_t str_off, str_len, df, post_len; uint64_t post_off; };
+#pragma pack(pop)
+
+void put_varint(std::string& out, uint32_t v) {
+    while (v >= 0x80) { out += (char)(v | 0x80); v >>= 7; }
+    out += (char)v;
+}
+
+uint32_t get_varint(const uint8_t*& p, const uint8_t* end) {
+    uint32_t v = 0; int shift = 0;
+    while (p < end && shift < 35) { uint8_t b = *p++; v |= (uint32_t)(b & 0x7F) << shift; if (!(b & 0x80)) break; shift += 7; }
+    return v;
+}
+
+// In-memory segment under construction.
+struct Builder {
+    struct Doc { uint32_t meeting; int speaker; int64_t t_ms; std::string text; uint32_t n_tokens; };
+    struct Meeting { std::string name, path; int64_t date; };
+    std::vector<Meeting> meetings; std::vector<Doc> docs;
+    std::map<std::string, std::vector<std::pair<uint32_t, uint32_t>>> postings;
+
+    uint32_t addMeeting(const std::string& name, const std::string& path, int64_t date) { meetings.push_back({name, path, date}); return (uint32_t)meetings.size() - 1; }
+    void addDoc(uint32_t meeting, int speaker, int64_t t_ms, const std::string& text) {
+        uint32_t id = (uint32_t)docs.size();
+        auto toks = SearchIndex::tokenize(text);
+        std::unordered_map<std::string, uint32_t> tf;
+        for (auto& t : toks) tf[t]++;
+        for (auto& kv : tf) postings[kv.first].push_back({id, kv.second});
+        docs.push_back({meeting, speaker, t_ms, text, (uint32_t)toks.size()});
+    }
+    bool write(const std::string& path) {
+        std::string strings, post;
+        auto intern = [&](const std::string& s) { uint32_t off = (uint32_t)strings.size(); strings += s; return off; };
+        std::vector<MeetingRec> mrec; std::vector<DocRec> drec; std::vector<TermRec> trec;
+        for (auto& m : meetings) mrec.push_back({intern(m.name), (uint32_t)m.name.size(), intern(m.path), (uint32_t)m.path.size(), m.date});
+        for (auto& d : docs) drec.push_back({d.meeting, d.speaker, d.t_ms, intern(d.text), (uint32_t)d.text.size(), d.n_tokens, 0});
+        for (auto& kv : postings) {
+            uint64_t off = post.size(); uint32_t prev = 0;
+            for (auto& p : kv.second) { put_varint(post, p.first - prev); put_varint(post, p.second); prev = p.first; }
+            trec.push_back({intern(kv.first), (uint32_t)kv.first.size(), (uint32_t)kv.second.size(), (uint32_t)(post.size() - off), off});
+        }
+        FileHeader h{}; std::memcpy(h.magic, "MAIX", 4); h.version = VERSION;
+        h.n_meetings = (uint32_t)mrec.size(); h.n_docs = (uint32_t)drec.size(); h.n_terms = (uint32_t)trec.size();
+        for (auto& d : docs) h.total_tokens += d.n_tokens;
+        h.off_meetings = sizeof(FileHeader);
+        h.off_docs = h.off_meetings + mrec.size() * sizeof(MeetingRec);
+        h.off_terms = h.off_docs + drec.size() * sizeof(DocRec);
+        h.off_postings = h.off_terms + trec.size() * sizeof(TermRec);
+        h.off_strings = h.off_postings + post.size();
+
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f.is_open()) return false;
+            f.write((const char*)&h, sizeof(h));
+            f.write((const char*)mrec.data(), mrec.size() * sizeof(MeetingRec));
+            f.write((const char*)drec.data(), drec.size() * sizeof(DocRec));
+            f.write((const char*)trec.data(), trec.size() * sizeof(TermRec));
+            f.write(post.data(), post.size());
+            f.write(strings.data(), strings.size());
+            if (!f.flush()) return false;
+        }
+        std::error_code ec; fs::rename(tmp, path, ec);
+        return !ec;
+    }
+};
+
+// Read-only view of one segment file.
+class Mapped {
+public:
+    explicit Mapped(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY); if (fd < 0) return;
+        off_t sz = ::lseek(fd, 0, SEEK_END);
+        if (sz >= (off_t)sizeof(FileHeader)) {
+            void* p = ::mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) { base = (const uint8_t*)p; size = sz; }
+        }
+        ::close(fd);
+        if (!base) return;
+        std::memcpy(&h, base, sizeof(h));
+        // Tables in order and inside the file; every offset read below is checked against them.
+        valid = std::memcmp(h.magic, "MAIX", 4) == 0 && h.version == VERSION && h.off_strings <= size && h.off_meetings >= sizeof(FileHeader) &&
+                h.off_meetings + (uint64_t)h.n_meetings * sizeof(MeetingRec) <= h.off_docs && h.off_docs + (uint64_t)h.n_docs * sizeof(DocRec) <= h.off_terms &&
+                h.off_terms + (uint64_t)h.n_terms * sizeof(TermRec) <= h.off_postings && h.off_postings <= h.off_strings;
+    }
+    ~Mapped() { if (base) ::munmap((void*)base, size); }
+    Mapped(const Mapped&) = delete;
+
+    bool ok() const { return valid; }
+    uint32_t docCount() const { return h.n_docs; }
+    uint32_t meetingCount() const { return h.n_meetings; }
+    MeetingRec meeting(uint32_t i) const { MeetingRec r; std::memcpy(&r, base + h.off_meetings + i * sizeof(MeetingRec), sizeof(r)); return r; }
+    DocRec doc(uint32_t i) const { DocRec r; std::memcpy(&r, base + h.off_docs + i * sizeof(DocRec), sizeof(r)); return r; }
+    std::string str(uint32_t off, uint32_t len) const {
+        if (h.off_strings + off + len > size) return "";
+        return std::string((const char*)base + h.off_strings + off, len);
+    }
+    // Binary search over the sorted term table.
+    bool find(const std::string& term, TermRec& out) const {
+        uint32_t lo = 0, hi = h.n_terms;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            TermRec r; std::memcpy(&r, base + h.off_terms + mid * sizeof(TermRec), sizeof(r));
+            int c = compare(r, term);
+            if (c == 0) { out = r; return true; }
+            if (c < 0) lo = mid + 1; else hi = mid;
+        }
+        return false;
+    }
+    template <typename F> void forEachPosting(const TermRec& t, F f) const {
+        const uint64_t span = h.off_strings - h.off_postings;
+        if (t.post_off > span || t.post_len > span - t.post_off) return;
+        const uint8_t* p = base + h.off_postings + t.post_off;
+        const uint8_t* end = p + t.post_len;
+        uint32_t doc = 0;
+        for (uint32_t i = 0; i < t.df && p < end; ++i) { doc += get_varint(p, end); uint32_t tf = get_varint(p, end); f(doc, tf); }
+    }
+    double totalTokens() const { return (double)h.total_tokens; }
+private:
+    int compare(const TermRec& r, const std::string& term) const {
+        if (h.off_strings + r.str_off + r.str_len > size) return 1; // corrupt entry: sorts after anything
+        const char* s = (const char*)base + h.off_strings + r.str_off;
+        int c = std::memcmp(s, term.data(), std::min<size_t>(r.str_len, term.size()));
+        if (c) return c;
+        return r.str_len < term.size() ? -1 : (r.str_len > term.size() ? 1 : 0);
+    }
+    const uint8_t* base = nullptr; size_t size = 0; FileHeader h{}; bool valid = false;
+};
+
+std::string lower(std::string s) { std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); }); return s; }
+}
+
+SearchIndex::SearchIndex(const std::string& dir) : dir(dir) {}
+
+std::string SearchIndex::defaultDir() {
+    return (fs::path(Config::getConfigPath()).parent_path() / "index").string();
+}
+
+std::vector<std::string> SearchIndex::tokenize(const std::string& text) {
+    std::vector<std::string> out; std::string cur;
+    auto flush = [&] { if (cur.size() >= 2 && cur.size() <= MAX_TOKEN) out.push_back(cur); cur.clear(); };
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c >= 0x80) cur += (char)std::tolower(c);
+        else flush();
+    }
+    flush();
+    return out;
+}
+
+std::vector<SearchIndex::Segment> SearchIndex::parseTranscript(const std::string& transcript) {
+    std::vector<Segment> out;
+    std::istringstream iss(transcript); std::string line;
+    while (std::getline(iss, line)) {
+        int h, m, s, ms = 0, consumed = 0;
+        if (std::sscanf(line.c_str(), "%d:%d:%d%n", &h, &m, &s, &consumed) != 3) continue;
+        size_t pos = consumed;
+        if (pos < line.size() && line[pos] == '.') { int n = 0; std::sscanf(line.c_str() + pos, ".%d%n", &ms, &n); pos += n; }
+        Segment seg; seg.t_ms = ((h * 60LL + m) * 60 + s) * 1000 + ms;
+        if (line.compare(pos, 10, " [Speaker ") == 0) {
+            seg.speaker = std::atoi(line.c_str() + pos + 10) - 1;
+            size_t close = line.find(']', pos); if (close == std::string::npos) continue;
+            pos = close + 1;
+        }
+        if (pos < line.size() && line[pos] == ':') pos++;
+        seg.text = line.substr(std::min(pos, line.size()));
+        size_t first = seg.text.find_first_not_of(' ');
+        if (first == std::string::npos) continue;
+        seg.text = seg.text.substr(first);
+        out.push_back(std::move(seg));
+    }
+    return out;
+}
+
+std::vector<std::string> SearchIndex::segmentFiles() const {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& e : fs::directory_iterator(dir, ec)) if (e.path().extension() == ".idx") files.push_back(e.path().string());
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool SearchIndex::addMeeting(const std::string& name, const std::string& path, int64_t date_unix, const std::vector<Segment>& segments) {
+    if (segments.empty()) return false;
+    fs::create_directories(dir);
+    Builder b;
+    uint32_t m = b.addMeeting(name, path, date_unix);
+    for (const auto& s : segments) b.addDoc(m, s.speaker, s.t_ms, s.text);
+    static std::atomic<uint32_t> counter{0};
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::stringstream fn; fn << "seg_" << now_ms << "_" << ::getpid() << "_" << counter++ << ".idx";
+    if (!b.write((fs::path(dir) / fn.str()).string())) return false;
+    if (segmentFiles().size() > COMPACT_THRESHOLD) compact();
+    return true;
+}
+
+bool SearchIndex::compact() {
+    std::string lockPath = (fs::path(dir) / ".compact.lock").string();
+    int lockFd = ::open(lockPath.c_str(), O_CREAT | O_RDWR, 0600);
+    if (lockFd < 0) return false;
+    if (::flock(lockFd, LOCK_EX | LOCK_NB) != 0) { ::close(lockFd); return false; } // another process is compacting
+
+    auto files = segmentFiles();
+    Builder b;
+    for (const auto& f : files) {
+        Mapped seg(f); if (!seg.ok()) continue;
+        std::vector<uint32_t> remap(seg.meetingCount());
+        for (uint32_t i = 0; i < seg.meetingCount(); ++i) {
+            auto r = seg.meeting(i);
+            remap[i] = b.addMeeting(seg.str(r.name_off, r.name_len), seg.str(r.path_off, r.path_len), r.date_unix);
+        }
+        for (uint32_t i = 0; i < seg.docCount(); ++i) {
+            auto d = seg.doc(i);
+            if (d.meeting < remap.size()) b.addDoc(remap[d.meeting], d.speaker, d.t_ms, seg.str(d.text_off, d.text_len));
+        }
+    }
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string merged = (fs::path(dir) / ("seg_" + std::to_string(now_ms) + "_compact.idx")).string();
+    bool ok = b.write(merged);
+    if (ok) for (const auto& f : files) if (f != merged) fs::remove(f);
+    ::flock(lockFd, LOCK_UN); ::close(lockFd);
+    return ok;
+}
+
+std::vector<SearchIndex::Hit> SearchIndex::search(const Query& q) const {
+    auto terms = tokenize(q.text);
+    std::sort(terms.begin(), terms.end()); terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    std::vector<Hit> hits;
+    if (terms.empty()) return hits;
+
+    std::vector<std::unique_ptr<Mapped>> segs;
+    for (const auto& f : segmentFiles()) { auto m = std::make_unique<Mapped>(f); if (m->ok()) segs.push_back(std::move(m)); }
+
+    // Global statistics so scores are comparable across segment files.
+    double n_docs = 0, n_tokens = 0; std::vector<double> df(terms.size(), 0);
+    for (auto& s : segs) {
+        n_docs += s->docCount(); n_tokens += s->totalTokens();
+        TermRec t; for (size_t i = 0; i < terms.size(); ++i) if (s->find(terms[i], t)) df[i] += t.df;
+    }
+    if (n_docs == 0) return hits;
+    double avgdl = std::max(1.0, n_tokens / n_docs);
+    std::string meetingFilter = lower(q.meeting);
+
+    for (auto& s : segs) {
+        std::unordered_map<uint32_t, double> scores;
+        TermRec t;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            if (!s->find(terms[i], t)) continue;
+            double idf = std::log(1.0 + (n_docs - df[i] + 0.5) / (df[i] + 0.5));
+            s->forEachPosting(t, [&](uint32_t doc, uint32_t tf) {
+                if (doc >= s->docCount()) return;
+                double dl = s->doc(doc).n_tokens;
+                scores[doc] += idf * tf * (BM25_K1 + 1) / (tf + BM25_K1 * (1 - BM25_B + BM25_B * dl / avgdl));
+            });
+        }
+        for (auto& kv : scores) {
+            auto d = s->doc(kv.first);
+            if (q.speaker >= 0 && d.speaker != q.speaker) continue;
+            if (d.meeting >= s->meetingCount()) continue;
+            auto m = s->meeting(d.meeting);
+            if (m.date_unix < q.since_unix) continue;
+            std::string name = s->str(m.name_off, m.name_len);
+            if (!meetingFilter.empty() && lower(name).find(meetingFilter) == std::string::npos) continue;
+            hits.push_back({kv.second, name, s->str(m.path_off, m.path_len), s->str(d.text_off, d.text_len), m.date_unix, d.t_ms, d.speaker});
+        }
+    }
+    size_t k = std::min(q.limit, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + k, hits.end(), [](const Hit& a, const Hit& b) { return a.score > b.score; });
+    hits.resize(k);
+    return hits;
+}
@@ -0,0 +1,168 @@
+#include "SegmentStream.h"
+#include <iostream>
+#include <algorithm>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+namespace {
+void set_nonblocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK); }
+}
+
+bool SegmentStream::open(const std::string& target) {
+    if (running) return false;
+    std::signal(SIGPIPE, SIG_IGN);
+    if (target == "-" || target == "stdout") {
+        // stdout is shared with the terminal, so it stays blocking; flush() only writes what poll() says fits.
+        kind = Kind::Stdout; sinks.push_back({STDOUT_FILENO, false, "", 0, {}});
+    } else if (target.rfind("fifo:", 0) == 0) {
+        path = target.substr(5); struct stat st;
+        if (::stat(path.c_str(), &st) != 0) {
+            if (::mkfifo(path.c_str(), 0600) != 0) { std::cerr << "Cannot create FIFO " << path << ": " << std::strerror(errno) << std::endl; return false; }
+        } else if (!S_ISFIFO(st.st_mode)) { std::cerr << "Not a FIFO: " << path << std::endl; return false; }
+        kind = Kind::Fifo; sinks.push_back({-1, false, "", 0, {}}); // opened by the writer once a reader appears
+    } else if (target.rfind("unix:", 0) == 0) {
+        path = target.substr(5);
+        sockaddr_un addr{}; addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) { std::cerr << "Invalid socket path: " << path << std::endl; return false; }
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(path.c_str());
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 || ::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 8) != 0) {
+            std::cerr << "Cannot bind " << path << ": " << std::strerror(errno) << std::endl;
+            if (listenFd >= 0) { ::close(listenFd); listenFd = -1; }
+            return false;
+        }
+        set_nonblocking(listenFd); kind = Kind::Socket;
+    } else {
+        std::cerr << "Unknown stream target '" << target << "' (use -, fifo:<path> or unix:<path>)" << std::endl;
+        return false;
+    }
+    if (::pipe(wakePipe) != 0) { std::cerr << "Cannot create stream wake pipe" << std::endl; return false; }
+    set_nonblocking(wakePipe[0]); set_nonblocking(wakePipe[1]);
+    running = true;
+    writer = std::thread([this]{ writerLoop(); });
+    return true;
+}
+
+void SegmentStream::segment(int64_t t0_ms, int64_t t1_ms, const std::string& text, int speaker, float confidence, bool final) {
+    if (!running) return;
+    event(nlohmann::json{{"type", "segment"}, {"t0_ms", t0_ms}, {"t1_ms", t1_ms}, {"text", text}, {"speaker", speaker},
+                         {"confidence", confidence}, {"final", final}});
+}
+
+void SegmentStream::event(const nlohmann::json& j) {
+    // Segment text can end inside a UTF-8 sequence; the strict default would throw into the capture loop.
+    if (running) publish(j.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) + "\n");
+}
+
+void SegmentStream::publish(const std::string& line) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.published++;
+        for (auto& s : sinks) {
+            if (s.buf.size() - s.head + line.size() > maxBuffer) { counters.dropped++; continue; }
+            s.buf += line; s.marks.push_back({s.buf.size(), Clock::now()});
+        }
+    }
+    wake();
+}
+
+void SegmentStream::wake() {
+    if (wakePipe[1] >= 0) { char c = 1; (void)!::write(wakePipe[1], &c, 1); }
+}
+
+bool SegmentStream::flush(Sink& s) {
+    while (s.head < s.buf.size()) {
+        size_t n = s.buf.size() - s.head;
+        if (kind == Kind::Stdout) {
+            pollfd p{s.fd, POLLOUT, 0};
+            if (::poll(&p, 1, 0) <= 0) break;
+            if (p.revents & (POLLERR | POLLHUP)) return false;
+            n = std::min<size_t>(n, PIPE_BUF); // never blocks once POLLOUT is reported
+        }
+        ssize_t w = s.socket ? ::send(s.fd, s.buf.data() + s.head, n, MSG_NOSIGNAL) : ::write(s.fd, s.buf.data() + s.head, n);
+        if (w < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            return false;
+        }
+        s.head += (size_t)w;
+    }
+    auto now = Clock::now();
+    while (!s.marks.empty() && s.marks.front().first <= s.head) {
+        counters.max_lag_ms = std::max(counters.max_lag_ms, std::chrono::duration<double, std::milli>(now - s.marks.front().second).count());
+        counters.written++; s.marks.pop_front();
+    }
+    if (s.head == s.buf.size()) { s.buf.clear(); s.head = 0; }
+    else if (s.head > 64 * 1024) {
+        s.buf.erase(0, s.head);
+        for (auto& m : s.marks) m.first -= s.head;
+        s.head = 0;
+    }
+    return true;
+}
+
+void SegmentStream::writerLoop() {
+    Clock::time_point deadline{};
+    while (true) {
+        bool pending = false;
+        std::vector<pollfd> fds{{wakePipe[0], POLLIN, 0}};
+        if (listenFd >= 0) fds.push_back({listenFd, POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (kind == Kind::Fifo && sinks[0].fd < 0 && Clock::now() - lastFifoAttempt > std::chrono::milliseconds(250)) {
+                lastFifoAttempt = Clock::now();
+                sinks[0].fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK); // ENXIO until a reader has it open
+            }
+            for (const auto& s : sinks) if (s.fd >= 0 && s.head < s.buf.size()) { pending = true; fds.push_back({s.fd, POLLOUT, 0}); }
+        }
+        if (!running) {
+            if (!draining || !pending) break;
+            if (deadline == Clock::time_point{}) deadline = Clock::now() + std::chrono::milliseconds(drainMs);
+            if (Clock::now() > deadline) break;
+        }
+        ::poll(fds.data(), fds.size(), running ? 200 : 20);
+        char drain[64]; while (::read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+        if (listenFd >= 0) {
+            int fd;
+            while ((fd = ::accept(listenFd, nullptr, nullptr)) >= 0) {
+                set_nonblocking(fd);
+                std::lock_guard<std::mutex> lock(mutex);
+                sinks.push_back({fd, true, "", 0, {}});
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = sinks.begin(); it != sinks.end();) {
+            if (it->fd < 0 || flush(*it)) { ++it; continue; }
+            // The consumer went away: sockets are forgotten, a FIFO is reopened for the next reader.
+            if (kind == Kind::Stdout) { it->fd = -1; ++it; continue; }
+            ::close(it->fd); it->fd = -1;
+            if (kind == Kind::Socket) { it = sinks.erase(it); continue; }
+            it->buf.clear(); it->head = 0; it->marks.clear(); ++it;
+        }
+    }
+}
+
+void SegmentStream::close(int timeoutMs) {
+    if (!running) return;
+    drainMs = timeoutMs; draining = timeoutMs > 0; running = false; wake();
+    if (writer.joinable()) writer.join();
+    for (auto& s : sinks) if (s.fd >= 0 && kind != Kind::Stdout) ::close(s.fd);
+    sinks.clear();
+    if (listenFd >= 0) { ::close(listenFd); listenFd = -1; ::unlink(path.c_str()); }
+    for (int& fd : wakePipe) if (fd >= 0) { ::close(fd); fd = -1; }
+}
+
+SegmentStream::Stats SegmentStream::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats s = counters; s.consumers = 0;
+    for (const auto& k : sinks) if (k.fd >= 0) s.consumers++;
+    return s;
+}
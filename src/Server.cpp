@@ -0,0 +1,375 @@
+#include "Server.h"
+#include "AudioFile.h"
+#include "AudioSource.h"
+#include "Reports.h"
+#include "Diarizer.h"
+#include "SpeechMap.h"
+#include "HttpServer.h"
+#include "Scheduler.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <csignal>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+const size_t MAX_RETAINED_JOBS = 1024;
+const int STOP_GRACE_MS = 2000; // open connections get this long to finish on stop() before their sockets are shut down
+
+const char* state_name(Job::State s) {
+    switch (s) {
+        case Job::State::Queued: return "queued";
+        case Job::State::Running: return "running";
+        case Job::State::Done: return "done";
+        default: return "failed";
+    }
+}
+
+// Segment text can end inside a UTF-8 sequence and names come from the client; the strict default would throw.
+std::string dump(const json& j) { return j.dump(-1, ' ', false, json::error_handler_t::replace); }
+
+// True for unix sockets and sockets bound to 127.0.0.0/8 or ::1.
+bool is_local_listener(int fd) {
+    sockaddr_storage ss{}; socklen_t len = sizeof(ss);
+    if (::getsockname(fd, (sockaddr*)&ss, &len) != 0) return false;
+    if (ss.ss_family == AF_UNIX) return true;
+    if (ss.ss_family == AF_INET) return (ntohl(((sockaddr_in*)&ss)->sin_addr.s_addr) >> 24) == 127;
+    if (ss.ss_family == AF_INET6) return IN6_IS_ADDR_LOOPBACK(&((sockaddr_in6*)&ss)->sin6_addr);
+    return false;
+}
+
+json segment_json(const TranscriptionSegment& s) {
+    return {{"t0_ms", s.t0 * 10}, {"t1_ms", s.t1 * 10}, {"text", s.text}, {"speaker", s.speaker_id}, {"confidence", s.confidence}};
+}
+
+// Caller holds job.mutex.
+json job_json(const Job& job) {
+    using ms = std::chrono::milliseconds;
+    auto now = std::chrono::steady_clock::now();
+    json j = {{"id", job.id}, {"name", job.name}, {"priority", job.priority}, {"state", state_name(job.state)},
+              {"segments", job.segments.size()}, {"audio_sec", job.audio_sec}};
+    if (job.state != Job::State::Queued) {
+        j["queue_ms"] = std::chrono::duration_cast<ms>(job.started - job.submitted).count();
+        auto end = (job.state == Job::State::Running) ? now : job.finished;
+        auto proc = std::chrono::duration_cast<ms>(end - job.started).count();
+        j["processing_ms"] = proc;
+        if (job.audio_sec > 0) j["rtf"] = proc / 1000.0 / job.audio_sec;
+    }
+    if (!job.output.empty()) j["output"] = job.output;
+    if (!job.error.empty()) j["error"] = job.error;
+    return j;
+}
+}
+
+JobQueue::JobQueue(size_t capacity) : cap(std::max<size_t>(1, capacity)) {}
+
+bool JobQueue::push(std::shared_ptr<Job> job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed || queue.size() >= cap) return false;
+    queue.push({job->priority, seq++, std::move(job)});
+    cv.notify_one();
+    return true;
+}
+
+std::shared_ptr<Job> JobQueue::pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]{ return closed || !queue.empty(); });
+    if (queue.empty()) return nullptr; // closed: accepted jobs are drained first
+    auto job = queue.top().job; queue.pop();
+    return job;
+}
+
+void JobQueue::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    cv.notify_all();
+}
+
+size_t JobQueue::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+MeetingServer::MeetingServer(const Config::Data& config, Transcriber& transcriber, int workers, size_t queueCapacity)
+    : config(config), transcriber(transcriber), n_workers(std::max(1, workers)), queue(queueCapacity) {
+    int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads_per_worker = std::max(1, hw / n_workers);
+    transcriber.setMaxStates(n_workers);
+}
+
+MeetingServer::~MeetingServer() { stop(); }
+
+bool MeetingServer::listen(const std::string& address) {
+    listenFd = listen_socket(address, unixPath);
+    if (listenFd < 0) return false;
+    localOnly = is_local_listener(listenFd);
+    if (!localOnly && config.serve_path_root.empty()) std::cout << "Listening beyond loopback: JSON path jobs are refused unless serve_path_root is set" << std::endl;
+    std::cout << "Serving on " << address << " (" << n_workers << " workers x " << threads_per_worker << " threads, queue " << queue.capacity() << ")" << std::endl;
+    return true;
+}
+
+void MeetingServer::start() {
+    std::signal(SIGPIPE, SIG_IGN);
+    running = true;
+    for (int i = 0; i < n_workers; ++i) workers.emplace_back([this]{ workerLoop(); });
+    if (listenFd >= 0) acceptor = std::thread([this]{ acceptLoop(); });
+}
+
+void MeetingServer::stop() {
+    if (!running.exchange(false)) return;
+    if (acceptor.joinable()) acceptor.join();
+    if (listenFd >= 0) { ::close(listenFd); listenFd = -1; }
+    if (!unixPath.empty()) ::unlink(unixPath.c_str());
+    queue.close();
+    for (auto& w : workers) if (w.joinable()) w.join();
+    connections.drain(STOP_GRACE_MS);
+}
+
+void MeetingServer::acceptLoop() {
+    while (running) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        if (!connections.admit(fd)) continue;
+        std::thread([this, fd]{ handleConnection(fd); connections.release(fd); }).detach();
+    }
+}
+
+void MeetingServer::workerLoop() {
+    while (auto job = queue.pop()) {
+        busy++;
+        processJob(job);
+        busy--;
+    }
+}
+
+void MeetingServer::processJob(const std::shared_ptr<Job>& job) {
+    auto finish = [&](Job::State st, const std::string& err) {
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->state = st; job->error = err; job->finished = std::chrono::steady_clock::now();
+            job->cv.notify_all();
+            (st == Job::State::Done ? completed : failed)++;
+        }
+        if (onFinished) onFinished(*job);
+    };
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->state = Job::State::Running; job->started = std::chrono::steady_clock::now();
+        job->cv.notify_all();
+    }
+
+    // Uploads are released exactly once, whether decoding finishes or something below throws.
+    bool released = false;
+    auto release = [&] { if (!released) { released = true; uploadBytes -= job->upload.size(); std::vector<char>().swap(job->upload); } };
+    // This runs on a plain worker thread: anything escaping would terminate the daemon with every queued job.
+    try {
+        std::vector<float> pcm;
+        bool ok = job->path.empty() ? decode_wav(job->upload.data(), job->upload.size(), pcm) : load_audio_file(job->path, pcm);
+        release();
+        if (!ok || pcm.empty()) { finish(Job::State::Failed, "could not decode audio"); return; }
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->audio_sec = pcm.size() / (double)SAMPLE_RATE;
+        }
+
+        std::vector<float> speech; SpeechMap speechMap;
+        if (config.elide_silence) { SpeechMap::Options opt; opt.max_threshold = config.vad_threshold; speechMap = SpeechMap::build(pcm, speech, opt); }
+        auto segs = transcriber.transcribe(speech.empty() ? pcm : speech, threads_per_worker, "", nullptr, [&](const TranscriptionSegment& s) {
+            TranscriptionSegment mapped = s; speechMap.remap(mapped);
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->segments.push_back(mapped);
+            job->cv.notify_all();
+        });
+        speechMap.remap(segs); std::vector<float>().swap(speech);
+        // Speaker IDs need the whole recording, so streamed segments carry speaker -1 and the final list is labelled.
+        if (Diarizer::enabledFor(config)) Diarizer(Diarizer::modelSupportsTurns(config.model_path)).assign(segs, pcm);
+        std::vector<float>().swap(pcm);
+
+        std::stringstream ft; std::vector<SearchIndex::Segment> indexed;
+        for (const auto& s : segs) {
+            ft << format_segment_line(s.t0 * 10, s.speaker_id, s.text) << "\n";
+            std::string txt = s.text; trim(txt); if (!txt.empty()) indexed.push_back({s.t0 * 10, s.speaker_id, txt});
+        }
+        std::string output;
+        if (job->report) output = save_meeting_reports(ft.str(), indexed, config, job->name);
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->segments = std::move(segs);
+            job->output = output;
+        }
+    } catch (const std::exception& e) {
+        release();
+        bool running; { std::lock_guard<std::mutex> lock(job->mutex); running = job->state == Job::State::Running; }
+        if (running) finish(Job::State::Failed, e.what());
+        return;
+    }
+    finish(Job::State::Done, "");
+}
+
+bool MeetingServer::submit(const std::shared_ptr<Job>& job) {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        job->id = nextId++;
+    }
+    if (job->name.empty()) job->name = job->path.empty() ? "job_" + std::to_string(job->id) : fs::path(job->path).stem().string();
+    job->submitted = std::chrono::steady_clock::now();
+    // Registered before it is queued, so a worker or GET /jobs/<id> never sees an unknown job.
+    { std::lock_guard<std::mutex> lock(jobsMutex); jobs[job->id] = job; }
+    if (!queue.push(job)) {
+        { std::lock_guard<std::mutex> lock(jobsMutex); jobs.erase(job->id); }
+        rejected++; return false;
+    }
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    for (auto it = jobs.begin(); jobs.size() > MAX_RETAINED_JOBS && it != jobs.end();) {
+        std::lock_guard<std::mutex> jl(it->second->mutex);
+        bool done = it->second->state == Job::State::Done || it->second->state == Job::State::Failed;
+        it = done ? jobs.erase(it) : std::next(it);
+    }
+    return true;
+}
+
+bool MeetingServer::pathAllowed(const std::string& path) const {
+    if (config.serve_path_root.empty()) return localOnly;
+    std::error_code ec;
+    fs::path root = fs::weakly_canonical(config.serve_path_root, ec); if (ec) return false;
+    if (root.filename().empty()) root = root.parent_path(); // "/data/" -> "/data"
+    fs::path p = fs::weakly_canonical(path, ec); if (ec) return false;
+    auto mismatch = std::mismatch(root.begin(), root.end(), p.begin(), p.end());
+    return mismatch.first == root.end();
+}
+
+std::shared_ptr<Job> MeetingServer::findJob(uint64_t id) {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    auto it = jobs.find(id);
+    return it == jobs.end() ? nullptr : it->second;
+}
+
+void MeetingServer::handleConnection(int fd) {
+    HttpRequest req;
+    if (int err = read_request(fd, req)) { send_response(fd, err, json{{"error", "malformed request"}}.dump()); return; }
+
+    if (req.path == "/health") {
+        json j = {{"workers", n_workers}, {"busy", busy.load()}, {"queued", queue.size()}, {"queue_capacity", queue.capacity()},
+                  {"completed", completed.load()}, {"failed", failed.load()}, {"rejected", rejected.load()}};
+        auto& sched = Scheduler::shared();
+        json lanes = json::object();
+        for (int l = 0; l < Scheduler::LANES; ++l) {
+            auto st = sched.stats((Scheduler::Lane)l);
+            lanes[Scheduler::laneName((Scheduler::Lane)l)] = {{"tasks", st.tasks}, {"queued", st.queued}, {"running", st.running},
+                                                             {"queue_ms_mean", st.queue_ms_mean}, {"queue_ms_p95", st.queue_ms_p95}};
+        }
+        j["scheduler"] = {{"workers", sched.workers()}, {"lanes", lanes}};
+        j["memory"] = {{"rss_mb", current_rss() >> 20}, {"peak_rss_mb", peak_rss() >> 20}, {"planned_mb", memPlan.planned() >> 20},
+                       {"budget_mb", memPlan.budget >> 20}, {"queued_upload_mb", uploadBytes.load() >> 20}};
+        send_response(fd, 200, j.dump());
+        return;
+    }
+
+    if (req.path == "/jobs" && req.method == "POST") {
+        auto job = std::make_shared<Job>();
+        try {
+            if (req.headers["content-type"].find("json") != std::string::npos) {
+                json j = json::parse(req.body.begin(), req.body.end());
+                job->path = j.value("path", "");
+                job->priority = j.value("priority", 0);
+                job->name = j.value("name", "");
+                job->report = j.value("report", true);
+                if (job->path.empty()) { send_response(fd, 400, json{{"error", "missing 'path'"}}.dump()); return; }
+                if (!pathAllowed(job->path)) { send_response(fd, 403, json{{"error", "path not allowed (see serve_path_root)"}}.dump()); return; }
+            } else {
+                job->upload = std::move(req.body);
+                if (req.query.count("priority")) job->priority = std::stoi(req.query["priority"]);
+                if (req.query.count("name")) job->name = req.query["name"];
+                if (req.query.count("report")) job->report = req.query["report"] != "0" && req.query["report"] != "false";
+                if (job->upload.empty()) { send_response(fd, 400, json{{"error", "empty upload"}}.dump()); return; }
+            }
+        } catch (const std::exception& e) {
+            send_response(fd, 400, dump(json{{"error", e.what()}}));
+            return;
+        }
+        // Uploads stay in memory until a worker decodes them, so they count against the memory plan.
+        size_t bytes = job->upload.size(), held = uploadBytes.fetch_add(bytes) + bytes;
+        if (memPlan.upload_bytes && held > memPlan.upload_bytes) {
+            uploadBytes -= bytes; rejected++;
+            send_response(fd, 503, json{{"error", "upload memory budget full"}}.dump(), "application/json", "Retry-After: 5\r\n");
+            return;
+        }
+        if (!submit(job)) {
+            uploadBytes -= bytes;
+            send_response(fd, 503, json{{"error", "queue full"}}.dump(), "application/json", "Retry-After: 5\r\n");
+            return;
+        }
+        json j;
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            j = job_json(*job);
+        }
+        send_response(fd, 202, dump(j));
+        return;
+    }
+
+    if (req.path == "/jobs" && req.method == "GET") {
+        std::vector<std::shared_ptr<Job>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            for (auto& kv : jobs) snapshot.push_back(kv.second);
+        }
+        json arr = json::array();
+        for (auto& job : snapshot) { std::lock_guard<std::mutex> lock(job->mutex); arr.push_back(job_json(*job)); }
+        send_response(fd, 200, dump(arr));
+        return;
+    }
+
+    if (req.path.rfind("/jobs/", 0) == 0) {
+        std::string rest = req.path.substr(6);
+        bool stream = false;
+        size_t slash = rest.find('/');
+        if (slash != std::string::npos) {
+            if (rest.substr(slash) != "/segments") { send_response(fd, 404, json{{"error", "not found"}}.dump()); return; }
+            stream = true; rest = rest.substr(0, slash);
+        }
+        uint64_t id = 0;
+        try { id = std::stoull(rest); } catch (...) {}
+        auto job = findJob(id);
+        if (!job) { send_response(fd, 404, json{{"error", "unknown job"}}.dump()); return; }
+        if (req.method != "GET") { send_response(fd, 405, json{{"error", "method not allowed"}}.dump()); return; }
+
+        if (!stream) {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            send_response(fd, 200, dump(job_json(*job)));
+            return;
+        }
+
+        size_t sent = 0;
+        if (req.query.count("from")) { try { sent = std::stoull(req.query["from"]); } catch (...) {} }
+        if (!send_all(fd, "HTTP/1.1 200 OK\r\nContent-Type: application/x-ndjson\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n")) return;
+        while (running) {
+            std::string out; bool done;
+            {
+                std::unique_lock<std::mutex> lock(job->mutex);
+                job->cv.wait_for(lock, std::chrono::milliseconds(500), [&]{
+                    return job->segments.size() > sent || job->state == Job::State::Done || job->state == Job::State::Failed;
+                });
+                for (; sent < job->segments.size(); ++sent) out += dump(segment_json(job->segments[sent])) + "\n";
+                done = job->state == Job::State::Done || job->state == Job::State::Failed;
+                if (done) out += dump(json{{"event", "end"}, {"job", job_json(*job)}}) + "\n";
+            }
+            if (!send_chunk(fd, out)) return;
+            if (done) break;
+        }
+        send_all(fd, "0\r\n\r\n");
+        return;
+    }
+
+    send_response(fd, 404, json{{"error", "not found"}}.dump());
+}
@@ -0,0 +1,72 @@
+#include "SpeechMap.h"
+#include "AudioSource.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t SAMPLES_PER_TICK = SAMPLE_RATE / 100; // segment times are in 10 ms ticks
+}
+
+SpeechMap SpeechMap::build(const std::vector<float>& pcm, std::vector<float>& speech, const Options& opt) {
+    SpeechMap map; map.total = pcm.size();
+    const size_t frame = (size_t)std::max(10, opt.frame_ms / 10 * 10) * SAMPLE_RATE / 1000;
+    const size_t nf = (pcm.size() + frame - 1) / frame;
+    auto keepAll = [&]() { speech.clear(); map.spans.assign(1, {0, 0, pcm.size()}); if (pcm.empty()) map.spans.clear(); return map; };
+    if (nf < 2) return keepAll();
+
+    std::vector<float> rms(nf);
+    for (size_t f = 0; f < nf; ++f) {
+        size_t b = f * frame, e = std::min(pcm.size(), b + frame); double sum = 0;
+        for (size_t i = b; i < e; ++i) sum += pcm[i] * pcm[i];
+        rms[f] = (float)std::sqrt(sum / (e - b));
+    }
+    // The threshold follows the recording's own noise floor (10th percentile frame), capped at the live VAD
+    // threshold so a noisy file keeps everything rather than losing quiet speech.
+    std::vector<float> sorted = rms;
+    std::nth_element(sorted.begin(), sorted.begin() + nf / 10, sorted.end());
+    const float threshold = std::min(std::max(sorted[nf / 10] * 4.0f, 1e-3f), opt.max_threshold);
+
+    // Speech frames, widened by the padding; gaps shorter than min_gap_ms are kept as natural pauses.
+    const long pad = opt.pad_ms / opt.frame_ms, minGap = opt.min_gap_ms / opt.frame_ms;
+    std::vector<char> keep(nf, 0);
+    for (long f = 0; f < (long)nf; ++f)
+        if (rms[f] >= threshold) for (long k = std::max(0L, f - pad); k <= std::min((long)nf - 1, f + pad); ++k) keep[k] = 1;
+    long lastKept = -1;
+    for (long f = 0; f < (long)nf; ++f) {
+        if (!keep[f]) continue;
+        if (lastKept >= 0 && f - lastKept - 1 < minGap) std::fill(keep.begin() + lastKept + 1, keep.begin() + f, 1);
+        lastKept = f;
+    }
+
+    size_t kept = 0;
+    for (size_t f = 0; f < nf;) {
+        if (!keep[f]) { ++f; continue; }
+        size_t g = f; while (g < nf && keep[g]) ++g;
+        size_t b = f * frame, e = std::min(pcm.size(), g * frame);
+        map.spans.push_back({b, kept, e - b}); kept += e - b; f = g;
+    }
+    // Nothing to gain (or no speech found at all): decode the recording as is.
+    if (kept == 0 || kept > pcm.size() * 0.95) return keepAll();
+
+    speech.clear(); speech.reserve(kept);
+    for (const auto& s : map.spans) speech.insert(speech.end(), pcm.begin() + s.src, pcm.begin() + s.src + s.len);
+    return map;
+}
+
+int64_t SpeechMap::toSource(int64_t t, bool isEnd) const {
+    if (spans.empty()) return t;
+    size_t pos = (size_t)std::max<int64_t>(0, t) * SAMPLES_PER_TICK;
+    // Last span starting at (or, for an end time, strictly before) pos.
+    auto it = std::upper_bound(spans.begin(), spans.end(), pos, [isEnd](size_t p, const Span& s) { return isEnd ? p <= s.dst : p < s.dst; });
+    if (it != spans.begin()) --it;
+    size_t src = it->src + std::min(pos - std::min(pos, it->dst), it->len);
+    return (int64_t)(src / SAMPLES_PER_TICK);
+}
+
+void SpeechMap::remap(TranscriptionSegment& seg) const {
+    seg.t0 = toSource(seg.t0); seg.t1 = std::max(seg.t0, toSource(seg.t1, true));
+}
+
+void SpeechMap::remap(std::vector<TranscriptionSegment>& segments) const {
+    for (auto& s : segments) remap(s);
+}
@@ -1,4 +1,6 @@
 #include "TerminalUI.h"
+#include "TranscriptStore.h"
+#include "Reports.h"
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/screen/screen.hpp>
 #include <ftxui/component/component.hpp>
@@ -26,7 +28,7 @@ std::string TerminalUI::current_status = "Initializing";
 float TerminalUI::current_rms = 0.0f;
 float TerminalUI::current_threshold = 0.01f;
 int TerminalUI::current_progress = 0;
-std::vector<std::pair<std::string, std::string>> TerminalUI::segments;
+const TranscriptStore* TerminalUI::transcript = nullptr;
 std::mutex TerminalUI::data_mutex;
 std::chrono::steady_clock::time_point TerminalUI::start_proc_time;
 
@@ -76,15 +78,9 @@ void TerminalUI::updateProgress(int progress) {
     current_progress = progress;
 }
 
-void TerminalUI::addSegment(const std::string& timestamp, const std::string& text) {
+void TerminalUI::setTranscript(const TranscriptStore* store) {
     std::lock_guard<std::mutex> lock(data_mutex);
-    segments.push_back({timestamp, text});
-    if (segments.size() > 50) segments.erase(segments.begin());
-}
-
-void TerminalUI::clearSegments() {
-    std::lock_guard<std::mutex> lock(data_mutex);
-    segments.clear();
+    transcript = store;
 }
 
 void TerminalUI::stop() {
@@ -165,16 +161,20 @@ void TerminalUI::loop() {
         // History
         Elements trans_elements;
         trans_elements.push_back(filler());
-        if (segments.empty()) {
+        size_t n_segments = transcript ? transcript->size() : 0;
+        if (n_segments == 0) {
             trans_elements.push_back(text("Listening for conversations...") | center | dim);
         } else {
-            for (const auto& s : segments) {
+            static const Color speaker_colors[] = {Color::Cyan, Color::Yellow, Color::Magenta, Color::Green, Color::BlueLight, Color::RedLight, Color::Orange1, Color::Pink1};
+            transcript->forEach([&](TranscriptStore::Id, const TranscriptStore::Entry& s) {
+                Element who = s.speaker >= 0 ? text(" S" + std::to_string(s.speaker + 1)) | bold | color(speaker_colors[s.speaker % 8]) : text("");
                 trans_elements.push_back(hbox({
-                    text(s.first) | color(Color::GrayDark),
+                    text(format_timestamp(s.t0_ms)) | color(Color::GrayDark),
+                    who,
                     text(": "),
-                    paragraph(s.second) | flex
+                    paragraph(std::string(s.text)) | flex
                 }));
-            }
+            }, (TranscriptStore::Id)(n_segments > 50 ? n_segments - 50 : 0));
         }
 
         auto dashboard = vbox({
@@ -1,27 +1,261 @@
 #include "Transcriber.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-Transcriber::Transcriber(const std::string& modelPath) {
-    struct whisper_context_params cparams = whisper_context_default_params();
-    ctx = whisper_init_from_file_with_params(modelPath.c_str(), cparams);
+namespace {
+struct MappedFile { const char* data; size_t size, pos; };
+
+// Feeds whisper's loader from an mmap of the model so the kernel can read ahead while tensors are copied
+// out, instead of going through small buffered reads. Falls back to whisper's own file loader.
+struct whisper_context* init_from_mapped_file(const std::string& path, struct whisper_context_params cparams) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) {
+        if (fd >= 0) ::close(fd);
+        return whisper_init_from_file_with_params_no_state(path.c_str(), cparams);
+    }
+    size_t size = (size_t)st.st_size;
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return whisper_init_from_file_with_params_no_state(path.c_str(), cparams);
+    madvise(p, size, MADV_SEQUENTIAL); madvise(p, size, MADV_WILLNEED);
+
+    MappedFile file{(const char*)p, size, 0};
+    whisper_model_loader loader;
+    loader.context = &file;
+    loader.read = [](void* c, void* out, size_t n) -> size_t {
+        auto* f = static_cast<MappedFile*>(c);
+        n = std::min(n, f->size - f->pos);
+        std::memcpy(out, f->data + f->pos, n); f->pos += n;
+        return n;
+    };
+    loader.eof = [](void* c) { auto* f = static_cast<MappedFile*>(c); return f->pos >= f->size; };
+    loader.close = [](void*) {};
+    struct whisper_context* ctx = whisper_init_with_params_no_state(&loader, cparams);
+    munmap(p, size);
+    return ctx;
+}
+
+double ms_since(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+// Cheap stand-in for the gzip ratio whisper uses to spot repetition loops: bytes that start a 4-byte
+// sequence already seen earlier in the segment are counted as compressed away.
+double compression_ratio(const std::string& s) {
+    if (s.size() < 32) return 1.0;
+    std::unordered_set<uint32_t> seen; size_t literal = 3;
+    for (size_t i = 0; i + 4 <= s.size(); ++i) {
+        uint32_t k; std::memcpy(&k, s.data() + i, 4);
+        if (seen.insert(k).second) literal++;
+    }
+    return (double)s.size() / literal;
 }
 
-Transcriber::~Transcriber() { if (ctx) whisper_free(ctx); }
+// Reads segment i: text tokens go to tokens, confidence is the geometric mean of their probabilities.
+TranscriptionSegment read_segment(struct whisper_context* ctx, struct whisper_state* st, int i, std::vector<whisper_token>* tokens) {
+    TranscriptionSegment seg{whisper_full_get_segment_t0_from_state(st, i), whisper_full_get_segment_t1_from_state(st, i),
+                             whisper_full_get_segment_text_from_state(st, i), -1, whisper_full_get_segment_speaker_turn_next_from_state(st, i)};
+    // Text tokens only; timestamps, [_TT_], [SPEAKER_TURN] and other specials sort after EOT.
+    const whisper_token eot = whisper_token_eot(ctx);
+    double logp = 0; int n = 0;
+    for (int t = 0, nt = whisper_full_n_tokens_from_state(st, i); t < nt; ++t) {
+        whisper_token_data td = whisper_full_get_token_data_from_state(st, i, t);
+        if (td.id >= eot) continue;
+        if (tokens) tokens->push_back(td.id);
+        logp += std::log(std::max(td.p, 1e-6f)); n++;
+    }
+    if (n > 0) seg.confidence = (float)std::exp(logp / n);
+    return seg;
+}
+}
+
+Transcriber::Transcriber(const std::string& modelPath, int maxStates, bool background, bool useGpu) : useGpu(useGpu), maxStates(std::max(1, maxStates)) {
+    if (background) loader = Scheduler::shared().submit(Scheduler::Lane::Live, [this, modelPath]{ load(modelPath); });
+    else load(modelPath);
+}
+
+void Transcriber::load(const std::string& modelPath) {
+    auto t_start = std::chrono::steady_clock::now();
+    whisper_context_params cparams = whisper_context_default_params(); cparams.use_gpu = useGpu;
+    struct whisper_context* c = init_from_mapped_file(modelPath, cparams);
+    if (!c) std::cerr << "Failed to load model: " << modelPath << std::endl;
+    stats.load_ms = ms_since(t_start);
+
+    if (c) {
+        // Warm-up: allocate the first decoder state and run a tiny decode so compute buffers, thread pools
+        // and GPU pipelines exist before the first real window arrives.
+        ctx = c;
+        auto t_warm = std::chrono::steady_clock::now();
+        if (struct whisper_state* st = acquireState()) {
+            whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+            wparams.n_threads = std::max(1, std::min(4, (int)std::thread::hardware_concurrency()));
+            wparams.language = "en"; wparams.no_context = true; wparams.single_segment = true;
+            wparams.max_tokens = 1; wparams.audio_ctx = 64;
+            wparams.print_progress = false; wparams.print_realtime = false; wparams.print_timestamps = false;
+            std::vector<float> silence(WARMUP_SAMPLES, 0.0f);
+            whisper_full_with_state(ctx, st, wparams, silence.data(), (int)silence.size());
+            releaseState(st);
+        }
+        stats.warmup_ms = ms_since(t_warm);
+    }
+    { std::lock_guard<std::mutex> lock(readyMutex); ready = true; }
+    readyCv.notify_all();
+}
+
+bool Transcriber::isLoaded() {
+    std::unique_lock<std::mutex> lock(readyMutex);
+    readyCv.wait(lock, [this]{ return ready.load(); });
+    return ctx != nullptr;
+}
+
+Transcriber::~Transcriber() {
+    if (loader.valid()) loader.wait();
+    for (auto* st : states) whisper_free_state(st);
+    if (ctx) whisper_free(ctx);
+}
+
+Transcriber::DecodePolicy Transcriber::decodePolicyFor(const Config::Data& config) {
+    DecodePolicy p;
+    p.mode = config.decoding == "adaptive" ? DecodePolicy::Adaptive : config.decoding == "beam" ? DecodePolicy::Beam : DecodePolicy::Greedy;
+    if (config.min_confidence > 0) p.min_confidence = config.min_confidence;
+    return p;
+}
+
+Transcriber::DecodeStats Transcriber::decodeStats() {
+    std::lock_guard<std::mutex> lock(decodeMutex);
+    return decodeTotals;
+}
+
+void Transcriber::setMaxStates(int n) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    maxStates = std::max(1, n);
+    stateCv.notify_all();
+}
+
+struct whisper_state* Transcriber::acquireState() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    stateCv.wait(lock, [this]{ return !idleStates.empty() || (int)states.size() < maxStates; });
+    if (!idleStates.empty()) { auto* st = idleStates.back(); idleStates.pop_back(); return st; }
+    auto* st = whisper_init_state(ctx);
+    if (st) states.push_back(st);
+    return st;
+}
+
+void Transcriber::releaseState(struct whisper_state* state) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    idleStates.push_back(state);
+    stateCv.notify_one();
+}
 
 std::vector<TranscriptionSegment> Transcriber::transcribe(const std::vector<float>& pcmf32, 
                                                         int n_threads, 
                                                         const std::string& initial_prompt,
-                                                        ProgressCallback callback) {
-    std::vector<TranscriptionSegment> result; if (!ctx) return result;
-    
-    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-    wparams.language = "en"; 
-    wparams.n_threads = n_threads; 
-    wparams.tdrz_enable = true;
-    
+                                                        ProgressCallback callback,
+                                                        SegmentCallback onSegment) {
+    whisper_full_params wparams = whisper_full_default_params(policy.mode == DecodePolicy::Beam ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY);
+    wparams.n_threads = n_threads;
     if (!initial_prompt.empty()) {
         wparams.initial_prompt = initial_prompt.c_str();
     }
+    return run(pcmf32, wparams, callback, onSegment, nullptr);
+}
+
+std::vector<TranscriptionSegment> Transcriber::transcribe(const std::vector<float>& pcmf32, int n_threads, PromptState& prompt,
+                                                        ProgressCallback callback, SegmentCallback onSegment) {
+    size_t room = prompt.budget > (int)prompt.vocabulary.size() ? prompt.budget - prompt.vocabulary.size() : 0;
+    std::vector<whisper_token> tokens = prompt.vocabulary;
+    tokens.insert(tokens.end(), prompt.history.end() - std::min(room, prompt.history.size()), prompt.history.end());
+
+    whisper_full_params wparams = whisper_full_default_params(policy.mode == DecodePolicy::Beam ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY);
+    wparams.n_threads = n_threads;
+    if (!tokens.empty()) { wparams.prompt_tokens = tokens.data(); wparams.prompt_n_tokens = (int)tokens.size(); }
+    std::vector<whisper_token> decoded;
+    auto result = run(pcmf32, wparams, callback, onSegment, &decoded);
+
+    prompt.history.insert(prompt.history.end(), decoded.begin(), decoded.end());
+    if (prompt.history.size() > room) {
+        // Keep the tail, starting at a token that begins a word.
+        size_t cut = prompt.history.size() - room;
+        while (cut < prompt.history.size()) {
+            const char* s = whisper_token_to_str(ctx, prompt.history[cut]);
+            if (s && s[0] == ' ') break;
+            cut++;
+        }
+        prompt.history.erase(prompt.history.begin(), prompt.history.begin() + cut);
+    }
+    return result;
+}
+
+std::vector<whisper_token> Transcriber::tokenize(const std::string& text) {
+    std::vector<whisper_token> tokens; if (!isLoaded() || text.empty()) return tokens;
+    tokens.resize(text.size() + 8);
+    int n = whisper_tokenize(ctx, text.c_str(), tokens.data(), (int)tokens.size());
+    tokens.resize(std::max(0, n));
+    return tokens;
+}
+
+bool Transcriber::needsRedecode(const TranscriptionSegment& seg) const {
+    return seg.confidence < policy.min_confidence || compression_ratio(seg.text) > policy.max_compression;
+}
+
+bool Transcriber::redecode(struct whisper_state* state, const std::vector<float>& pcmf32, const whisper_full_params& greedy,
+                           const std::vector<whisper_token>& context, TranscriptionSegment& seg, std::vector<whisper_token>& tokens) {
+    // Segment times are in 10 ms units; whisper skips input shorter than a second, so short segments are
+    // centred in a second of silence. Widening into the neighbouring audio would copy its words in here.
+    const int64_t min_len = 16000;
+    int64_t s0 = std::max<int64_t>(0, seg.t0 * 160), s1 = std::min<int64_t>((int64_t)pcmf32.size(), seg.t1 * 160);
+    if (s1 <= s0) return false;
+    const float* samples = pcmf32.data() + s0; int64_t len = s1 - s0; std::vector<float> padded;
+    if (len < min_len) {
+        padded.assign(min_len, 0.0f);
+        std::copy(samples, samples + len, padded.begin() + (min_len - len) / 2);
+        samples = padded.data(); len = min_len;
+    }
+
+    whisper_full_params bp = whisper_full_default_params(WHISPER_SAMPLING_BEAM_SEARCH);
+    bp.beam_search.beam_size = policy.beam_size;
+    bp.n_threads = greedy.n_threads; bp.language = greedy.language;
+    bp.single_segment = true; bp.no_timestamps = true;
+    bp.print_progress = false; bp.print_realtime = false; bp.print_timestamps = false;
+    if (!context.empty()) { bp.prompt_tokens = context.data(); bp.prompt_n_tokens = (int)context.size(); }
+    else if (greedy.initial_prompt) bp.initial_prompt = greedy.initial_prompt;
+    if (whisper_full_with_state(ctx, state, bp, samples, (int)len) != 0) return false;
+
+    TranscriptionSegment best{seg.t0, seg.t1, "", seg.speaker_id, seg.speaker_turn, 0.0f};
+    std::vector<whisper_token> bestTokens; double logp = 0; int n = 0;
+    for (int i = 0, ns = whisper_full_n_segments_from_state(state); i < ns; ++i) {
+        std::vector<whisper_token> t;
+        TranscriptionSegment part = read_segment(ctx, state, i, &t);
+        best.text += part.text; bestTokens.insert(bestTokens.end(), t.begin(), t.end());
+        logp += std::log(std::max(part.confidence, 1e-6f)) * t.size(); n += (int)t.size();
+    }
+    if (n == 0) return false;
+    best.confidence = (float)std::exp(logp / n);
+    // The replacement must clear both thresholds itself; a higher confidence alone can still be a repetition loop.
+    if (needsRedecode(best) || (best.confidence <= seg.confidence && compression_ratio(best.text) >= compression_ratio(seg.text))) return false;
+    seg = std::move(best); tokens = std::move(bestTokens);
+    return true;
+}
+
+std::vector<TranscriptionSegment> Transcriber::run(const std::vector<float>& pcmf32, whisper_full_params& wparams, ProgressCallback& callback,
+                                                  SegmentCallback& onSegment, std::vector<whisper_token>* outTokens) {
+    std::vector<TranscriptionSegment> result; if (!isLoaded()) return result;
+    struct whisper_state* state = acquireState(); if (!state) return result;
+    
+    wparams.language = "en"; 
+    wparams.tdrz_enable = true;
+    const bool adaptive = policy.mode == DecodePolicy::Adaptive;
+    // Low-confidence segments are fixed up per segment below instead of re-running the whole window.
+    if (adaptive) wparams.temperature_inc = 0.0f;
 
     if (callback) {
         wparams.progress_callback = [](struct whisper_context * /*ctx*/, struct whisper_state * /*state*/, int progress, void * user_data) {
@@ -31,13 +265,48 @@ std::vector<TranscriptionSegment> Transcriber::transcribe(const std::vector<floa
         wparams.progress_callback_user_data = &callback;
     }
 
-    if (whisper_full(ctx, wparams, pcmf32.data(), pcmf32.size()) != 0) return result;
+    // Segments are streamed as they are decoded. In adaptive mode the first one that needs re-decoding, and
+    // everything after it, is held back so the stream stays in order and never shows text that is replaced.
+    struct Stream { Transcriber* self; SegmentCallback* cb; bool adaptive; int sent = 0; bool held = false; } stream{this, &onSegment, adaptive};
+    if (onSegment) {
+        wparams.new_segment_callback = [](struct whisper_context * c, struct whisper_state * st, int n_new, void * user_data) {
+            auto* s = static_cast<Stream*>(user_data);
+            const int n = whisper_full_n_segments_from_state(st);
+            for (int i = std::max(0, n - n_new); i < n && !s->held; ++i) {
+                TranscriptionSegment seg = read_segment(c, st, i, nullptr);
+                if (s->adaptive && s->self->needsRedecode(seg)) { s->held = true; break; }
+                (*s->cb)(seg); s->sent = i + 1;
+            }
+        };
+        wparams.new_segment_callback_user_data = &stream;
+    }
+
+    if (whisper_full_with_state(ctx, state, wparams, pcmf32.data(), pcmf32.size()) != 0) { releaseState(state); return result; }
     
-    const int n_segments = whisper_full_n_segments(ctx);
-    for (int i = 0; i < n_segments; ++i) {
-        result.push_back({whisper_full_get_segment_t0(ctx, i), 
-                         whisper_full_get_segment_t1(ctx, i), 
-                         whisper_full_get_segment_text(ctx, i)});
+    const int n_segments = whisper_full_n_segments_from_state(state);
+    std::vector<std::vector<whisper_token>> tokens(n_segments);
+    for (int i = 0; i < n_segments; ++i) result.push_back(read_segment(ctx, state, i, &tokens[i]));
+
+    // Second tier. The greedy results are copied out above, so the state can be reused for the re-decodes.
+    DecodeStats call; call.audio_sec = pcmf32.size() / 16000.0; call.segments = n_segments;
+    if (adaptive) {
+        for (int i = 0; i < n_segments; ++i) {
+            if (!needsRedecode(result[i])) continue;
+            std::vector<whisper_token> context(wparams.prompt_tokens, wparams.prompt_tokens + std::max(0, wparams.prompt_n_tokens));
+            for (int j = std::max(0, i - 2); j < i; ++j) context.insert(context.end(), tokens[j].begin(), tokens[j].end());
+            if (context.size() > 64) context.erase(context.begin(), context.end() - 64);
+            call.redecoded++; call.redecoded_sec += std::max<int64_t>(100, result[i].t1 - result[i].t0) / 100.0;
+            if (redecode(state, pcmf32, wparams, context, result[i], tokens[i])) call.improved++;
+        }
+    }
+    releaseState(state);
+    {
+        std::lock_guard<std::mutex> lock(decodeMutex);
+        decodeTotals.audio_sec += call.audio_sec; decodeTotals.redecoded_sec += call.redecoded_sec;
+        decodeTotals.segments += call.segments; decodeTotals.redecoded += call.redecoded; decodeTotals.improved += call.improved;
     }
+
+    if (onSegment) for (int i = stream.sent; i < n_segments; ++i) onSegment(result[i]);
+    if (outTokens) for (const auto& t : tokens) outTokens->insert(outTokens->end(), t.begin(), t.end());
     return result;
 }
@@ -0,0 +1,73 @@
+#include "TranscriptStore.h"
+#include "Reports.h"
+#include <algorithm>
+#include <cstring>
+
+std::string_view TranscriptStore::store(std::string_view text) {
+    if (chunks.empty() || chunks.back().cap - chunks.back().used < text.size()) {
+        size_t cap = std::max(CHUNK_BYTES, text.size());
+        chunks.push_back({std::unique_ptr<char[]>(new char[cap]), cap, 0});
+        arenaBytes += cap;
+    }
+    Chunk& c = chunks.back();
+    char* dst = c.data.get() + c.used;
+    if (!text.empty()) std::memcpy(dst, text.data(), text.size());
+    c.used += text.size(); textBytes += text.size();
+    return std::string_view(dst, text.size());
+}
+
+TranscriptStore::Id TranscriptStore::append(int64_t t0_ms, int64_t t1_ms, int speaker, std::string_view text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back({t0_ms, t1_ms, speaker, store(text)});
+    lastMs = std::max(lastMs, t1_ms);
+    return (Id)(entries.size() - 1);
+}
+
+size_t TranscriptStore::replace(int64_t from_ms, int64_t to_ms, const std::vector<Entry>& with) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto first = std::find_if(entries.begin(), entries.end(), [&](const Entry& e) { return e.t0_ms >= from_ms; });
+    auto last = std::find_if(first, entries.end(), [&](const Entry& e) { return e.t0_ms >= to_ms; });
+    size_t removed = (size_t)(last - first);
+    for (auto it = first; it != last; ++it) textBytes -= it->text.size();
+    auto pos = entries.erase(first, last);
+    std::vector<Entry> copies;
+    for (const auto& e : with) { copies.push_back({e.t0_ms, e.t1_ms, e.speaker, store(e.text)}); lastMs = std::max(lastMs, e.t1_ms); }
+    entries.insert(pos, copies.begin(), copies.end());
+    return removed;
+}
+
+size_t TranscriptStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+TranscriptStore::Entry TranscriptStore::at(Id id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.at(id);
+}
+
+std::string TranscriptStore::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    out.reserve(textBytes + entries.size() * 24); // timestamp, speaker label, separators
+    for (const auto& e : entries) { out += format_segment_line(e.t0_ms, e.speaker, e.text); out += '\n'; }
+    return out;
+}
+
+std::string TranscriptStore::tail(size_t maxChars) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string_view> parts; size_t total = 0;
+    for (auto it = entries.rbegin(); it != entries.rend() && total < maxChars; ++it) { parts.push_back(it->text); total += it->text.size() + 1; }
+    std::string out; out.reserve(total);
+    for (auto it = parts.rbegin(); it != parts.rend(); ++it) { if (!out.empty()) out += ' '; out.append(it->data(), it->size()); }
+    if (out.size() > maxChars) {
+        size_t cut = out.find(' ', out.size() - maxChars);
+        out.erase(0, cut == std::string::npos ? out.size() - maxChars : cut + 1);
+    }
+    return out;
+}
+
+TranscriptStore::MemoryStats TranscriptStore::memory() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {entries.size(), textBytes, arenaBytes, entries.size() * sizeof(Entry) + chunks.capacity() * sizeof(Chunk), lastMs};
+}
@@ -0,0 +1,209 @@
+#include "WatchFolder.h"
+#include "Export.h"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+const int RESCAN_MS = 30000, TICK_MS = 1000;
+
+// File names need not be UTF-8 (Latin-1 names from room recorders on SMB shares); the strict default would throw.
+std::string dump(const json& j) { return j.dump(-1, ' ', false, json::error_handler_t::replace); }
+
+bool is_recording(const fs::path& p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return (ext == ".wav" || ext == ".maa") && p.filename().string()[0] != '.';
+}
+
+const char* state_name(int s) {
+    static const char* names[] = {"settling", "pending", "queued", "done", "failed"};
+    return names[s];
+}
+}
+
+WatchFolder::WatchFolder(const Config::Data& config, MeetingServer& server, const std::string& directory)
+    : settleMs(std::max(500, config.watch_settle_ms)), server(server) {
+    std::error_code ec;
+    dir = fs::weakly_canonical(fs::absolute(directory), ec).string();
+    if (dir.empty()) dir = directory;
+    std::string name = dir; std::replace(name.begin(), name.end(), '/', '_');
+    statePath = (fs::path(stateDir()) / (name + ".ndjson")).string();
+}
+
+std::string WatchFolder::stateDir() {
+    fs::path d = fs::path(Config::getConfigPath()).parent_path() / "watch";
+    fs::create_directories(d);
+    return d.string();
+}
+
+bool WatchFolder::start() {
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) { std::cerr << "Not a directory: " << dir << std::endl; return false; }
+
+    // Replay the log (last record per file wins), then rewrite it compacted.
+    {
+        std::ifstream in(statePath); std::string line;
+        while (std::getline(in, line)) {
+            try {
+                json j = json::parse(line);
+                Entry& e = files[j.at("path").get<std::string>()];
+                e.size = j.value("size", (uintmax_t)0); e.mtime = j.value("mtime", (int64_t)0); e.attempts = j.value("attempts", 0);
+                std::string st = j.value("state", "");
+                e.state = st == "done" ? State::Done : st == "failed" ? State::Failed : State::Pending; // queued/running: redo
+            } catch (const std::exception&) {} // torn last line after a crash
+        }
+    }
+    std::stringstream compacted; int requeued = 0;
+    for (auto& kv : files) {
+        Entry& e = kv.second; e.readyAt = Clock::now();
+        if (e.state == State::Pending) requeued++;
+        compacted << dump(json{{"path", kv.first}, {"size", e.size}, {"mtime", e.mtime}, {"attempts", e.attempts}, {"state", state_name((int)e.state)}}) << "\n";
+    }
+    if (!write_file_atomic(statePath, compacted.str())) return false;
+    logFd = ::open(statePath.c_str(), O_WRONLY | O_APPEND);
+    if (logFd < 0) { std::cerr << "Cannot open " << statePath << std::endl; return false; }
+
+#ifdef __linux__
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd >= 0 && inotify_add_watch(notifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY) < 0) { ::close(notifyFd); notifyFd = -1; }
+#endif
+    std::cout << "Watching " << dir << (notifyFd >= 0 ? " (inotify" : " (polling") << ", settle " << settleMs << " ms; "
+              << requeued << " unfinished from the last run)" << std::endl;
+    started = Clock::now();
+    running = true;
+    watcher = std::thread([this]{ loop(); });
+    return true;
+}
+
+void WatchFolder::stop() {
+    if (!running.exchange(false)) return;
+    if (watcher.joinable()) watcher.join();
+    if (notifyFd >= 0) { ::close(notifyFd); notifyFd = -1; }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (logFd >= 0) { ::close(logFd); logFd = -1; }
+}
+
+void WatchFolder::loop() {
+    auto lastScan = Clock::now() - std::chrono::milliseconds(RESCAN_MS);
+    while (running) {
+        if (Clock::now() - lastScan >= std::chrono::milliseconds(notifyFd >= 0 ? RESCAN_MS : 2000)) { scan(); lastScan = Clock::now(); }
+#ifdef __linux__
+        if (notifyFd >= 0) {
+            pollfd pfd{notifyFd, POLLIN, 0};
+            if (::poll(&pfd, 1, TICK_MS) > 0) {
+                alignas(inotify_event) char buf[4096]; ssize_t n;
+                while ((n = ::read(notifyFd, buf, sizeof(buf))) > 0) {
+                    for (char* p = buf; p < buf + n;) {
+                        auto* ev = reinterpret_cast<inotify_event*>(p);
+                        if (ev->len) observe((fs::path(dir) / ev->name).string());
+                        p += sizeof(inotify_event) + ev->len;
+                    }
+                }
+            }
+        } else
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+        promote();
+    }
+}
+
+void WatchFolder::scan() {
+    std::error_code ec;
+    for (const auto& e : fs::directory_iterator(dir, ec)) if (e.is_regular_file(ec)) observe(e.path().string());
+}
+
+void WatchFolder::observe(const std::string& path) {
+    if (!is_recording(path)) return;
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return;
+    int64_t mtime = (int64_t)st.st_mtime;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(path);
+    if (it != files.end() && it->second.size == (uintmax_t)st.st_size && it->second.mtime == mtime) return;
+    if (it != files.end() && it->second.state == State::Queued) return; // changed while queued: the job reads what is there
+    Entry& e = files[path];
+    if (e.state == State::Done || e.state == State::Failed) e.attempts = 0; // replaced by a new recording
+    e.size = (uintmax_t)st.st_size; e.mtime = mtime; e.state = State::Settling; e.lastChange = Clock::now();
+}
+
+void WatchFolder::promote() {
+    // Settling files with no change for settleMs (re-checked with stat, since writes into an existing inode
+    // may not raise an event we catch) become pending; pending files are queued while the server has room.
+    std::vector<std::string> settling;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& kv : files) if (kv.second.state == State::Settling) settling.push_back(kv.first);
+    }
+    for (const auto& path : settling) observe(path);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = Clock::now();
+    for (auto& kv : files) {
+        Entry& e = kv.second;
+        if (e.state == State::Settling && e.size > 0 && now - e.lastChange >= std::chrono::milliseconds(settleMs)) {
+            e.state = State::Pending; e.readyAt = now;
+        }
+        if (e.state != State::Pending) continue;
+        std::error_code ec;
+        if (e.attempts >= MAX_ATTEMPTS || !fs::exists(kv.first, ec)) { e.state = State::Failed; continue; }
+        auto job = std::make_shared<Job>(); job->path = kv.first; job->report = true;
+        if (!server.submit(job)) break; // queue full; try again next tick
+        e.state = State::Queued; e.attempts++;
+        log(kv.first, e, "queued");
+    }
+}
+
+void WatchFolder::jobFinished(const Job& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(job.path);
+    if (it == files.end() || it->second.state != State::Queued) return;
+    Entry& e = it->second;
+    bool ok = job.state == Job::State::Done;
+    e.state = ok ? State::Done : (e.attempts >= MAX_ATTEMPTS ? State::Failed : State::Pending);
+    log(job.path, e, ok ? "done" : "failed");
+
+    double wait = std::chrono::duration<double>(job.started - e.readyAt).count();
+    double proc = std::chrono::duration<double>(job.finished - job.started).count();
+    if (ok) { done++; audioSec += job.audio_sec; procSec += proc; queueWaits.push_back(std::max(0.0, wait)); }
+    else failedCount++;
+    std::cout << (ok ? "Done " : "Failed ") << fs::path(job.path).filename().string() << std::fixed << std::setprecision(1)
+              << ": waited " << std::max(0.0, wait) << " s, processed " << job.audio_sec << " s of audio in " << proc << " s"
+              << (ok ? "" : " (" + job.error + ")") << std::endl;
+}
+
+void WatchFolder::log(const std::string& path, const Entry& e, const char* event) {
+    if (logFd < 0) return;
+    State st = e.state == State::Pending ? State::Queued : e.state; // a failed attempt that will be retried
+    std::string line = dump(json{{"path", path}, {"size", e.size}, {"mtime", e.mtime}, {"attempts", e.attempts}, {"state", state_name((int)st)},
+                            {"event", event}, {"ts", (int64_t)std::time(nullptr)}}) + "\n";
+    if (::write(logFd, line.data(), line.size()) != (ssize_t)line.size()) std::cerr << "Cannot write " << statePath << std::endl;
+    ::fsync(logFd);
+}
+
+std::string WatchFolder::summary() {
+    std::lock_guard<std::mutex> lock(mutex);
+    double hours = std::max(1e-9, std::chrono::duration<double>(Clock::now() - started).count() / 3600.0);
+    std::vector<double> w = queueWaits; std::sort(w.begin(), w.end());
+    double avg = 0; for (double x : w) avg += x; if (!w.empty()) avg /= w.size();
+    std::stringstream ss; ss << std::fixed << std::setprecision(1);
+    ss << "Watch: " << done << " done, " << failedCount << " failed; queue wait avg " << avg << " s, p95 "
+       << (w.empty() ? 0.0 : w[std::min(w.size() - 1, w.size() * 95 / 100)]) << " s; throughput " << done / hours << " files/h, "
+       << audioSec / 3600.0 / hours << " audio h/h (RTF " << std::setprecision(2) << (audioSec > 0 ? procSec / audioSec : 0.0) << ")";
+    return ss.str();
+}
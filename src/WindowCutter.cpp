@@ -0,0 +1,28 @@
+#include "WindowCutter.h"
+#include "AudioSource.h"
+#include <cmath>
+
+float calculate_rms(const std::vector<float>& samples) {
+    if (samples.empty()) return 0.0f;
+    float sum_sq = 0.0f;
+    for (float s : samples) sum_sq += s * s;
+    return std::sqrt(sum_sq / samples.size());
+}
+
+float WindowCutter::add(const std::vector<float>& chunk) {
+    pcm.insert(pcm.end(), chunk.begin(), chunk.end());
+    float rms = calculate_rms(chunk); totalRms += rms; rmsCount++;
+    if (rms < threshold) silenceMs += chunk.size() * 1000.0f / SAMPLE_RATE; else silenceMs = 0;
+    return rms;
+}
+
+bool WindowCutter::due() const {
+    float sec = (float)seconds();
+    return (silenceMs >= silenceLimitMs && sec > MIN_WINDOW_SEC) || sec >= MAX_WINDOW_SEC;
+}
+
+bool WindowCutter::hasSpeech() const { return rmsCount && totalRms / rmsCount > threshold * 0.5f; }
+
+double WindowCutter::seconds() const { return pcm.size() / (double)SAMPLE_RATE; }
+
+void WindowCutter::clear() { pcm.clear(); silenceMs = 0; totalRms = 0; rmsCount = 0; }
@@ -15,10 +15,32 @@
 
 #include "Transcriber.h"
 #include "LLMClients.h"
-#include "AudioCapture.h"
+#include "AudioSource.h"
 #include "Config.h"
 #include "TerminalUI.h"
 #include "Integrations.h"
+#include "Reports.h"
+#include "Diarizer.h"
+#include "AudioFile.h"
+#include "Server.h"
+#include "Journal.h"
+#include "AudioArchive.h"
+#include "SearchIndex.h"
+#include "Autotune.h"
+#include "TranscriptStore.h"
+#include "SpeechMap.h"
+#include "Governor.h"
+#include "SegmentStream.h"
+#include "WatchFolder.h"
+#include "WindowCutter.h"
+#include "Bench.h"
+#include "Refiner.h"
+#include "MultiSource.h"
+#include "ReplaySource.h"
+#include "MockServer.h"
+#include "LoadGen.h"
+#include "Scheduler.h"
+#include "MemoryBudget.h"
 
 #ifdef __APPLE__
 #include "MacTrayApp.h"
@@ -31,237 +53,193 @@ void signal_handler(int s) {
     TerminalUI::stop();
 }
 
-void trim(std::string& s) {
-    if (s.empty()) return;
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch); }));
-    s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) { return !std::isspace(ch); }).base(), s.end());
-    if (s.size() >= 2 && s.front() == '"' && s.back() == '"') s = s.substr(1, s.size() - 2);
+int run_search(int argc, char** argv) {
+    SearchIndex::Query q;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--limit" && i + 1 < argc) q.limit = std::stoul(argv[++i]);
+        else if (arg == "--meeting" && i + 1 < argc) q.meeting = argv[++i];
+        else if (arg == "--speaker" && i + 1 < argc) q.speaker = std::stoi(argv[++i]) - 1; // as labelled in transcripts; stored 0-based
+        else if (arg == "--since" && i + 1 < argc) {
+            std::tm tm{}; std::istringstream ss(argv[++i]); ss >> std::get_time(&tm, "%Y-%m-%d");
+            if (ss.fail()) { std::cerr << "--since expects YYYY-MM-DD\n"; return 1; }
+            q.since_unix = (int64_t)std::mktime(&tm);
+        }
+        else q.text += (q.text.empty() ? "" : " ") + arg;
+    }
+    if (q.text.empty()) { std::cerr << "Usage: " << argv[0] << " search <terms> [--limit n] [--meeting s] [--speaker n] [--since YYYY-MM-DD]\n"; return 1; }
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto hits = SearchIndex().search(q);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+    for (const auto& h : hits) {
+        std::time_t d = (std::time_t)h.date_unix; char ms[8]; snprintf(ms, sizeof(ms), ".%03d", (int)(h.t_ms % 1000));
+        std::cout << "\033[1;32m" << std::fixed << std::setprecision(2) << std::setw(6) << h.score << "\033[0m  " << std::put_time(std::localtime(&d), "%Y-%m-%d")
+                  << "  \033[1m" << h.meeting << "\033[0m  " << format_timestamp(h.t_ms) << ms << " (" << h.t_ms << " ms)";
+        if (h.speaker >= 0) std::cout << "  [Speaker " << h.speaker + 1 << "]";
+        std::cout << "\n        " << h.text << "\n        \033[90m" << h.path << "\033[0m\n";
+    }
+    std::cout << hits.size() << " hit(s) in " << us / 1000.0 << " ms\n";
+    return 0;
 }
 
-float calculate_rms(const std::vector<float>& samples) {
-    if (samples.empty()) return 0.0f;
-    float sum_sq = 0.0f;
-    for (float s : samples) sum_sq += s * s;
-    return std::sqrt(sum_sq / samples.size());
+// The live transcript as search index segments (store times are already milliseconds).
+std::vector<SearchIndex::Segment> index_segments(const TranscriptStore& transcript) {
+    std::vector<SearchIndex::Segment> out;
+    transcript.forEach([&](TranscriptStore::Id, const TranscriptStore::Entry& e) { out.push_back({e.t0_ms, e.speaker, std::string(e.text)}); });
+    return out;
 }
 
-std::string format_timestamp(int64_t t_ms) {
-    int64_t total_sec = t_ms / 1000;
-    int h = (int)(total_sec / 3600);
-    int m = (int)((total_sec % 3600) / 60);
-    int s = (int)(total_sec % 60);
-    char buf[32];
-    snprintf(buf, sizeof(buf), "%02d:%02d:%02d", h, m, s);
-    return std::string(buf);
+// Backfills the index from existing *_transcript.md files, or compacts it.
+int run_index(int argc, char** argv) {
+    if (argc > 2 && std::string(argv[2]) == "--compact") return SearchIndex().compact() ? 0 : 1;
+    if (argc < 3) { std::cerr << "Usage: " << argv[0] << " index <dir> | --compact\n"; return 1; }
+    const std::string suffix = "_transcript.md";
+    size_t n = 0; std::error_code ec;
+    for (const auto& e : fs::recursive_directory_iterator(argv[2], ec)) {
+        std::string fn = e.path().filename().string();
+        if (!e.is_regular_file() || fn.size() <= suffix.size() || fn.compare(fn.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
+        std::ifstream f(e.path()); std::stringstream ss; ss << f.rdbuf();
+        auto mtime = std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(e.last_write_time() - fs::file_time_type::clock::now());
+        if (SearchIndex().addMeeting(fn.substr(0, fn.size() - suffix.size()), e.path().string(), (int64_t)std::chrono::system_clock::to_time_t(mtime), SearchIndex::parseTranscript(ss.str()))) n++;
+    }
+    SearchIndex().compact();
+    std::cout << "Indexed " << n << " transcript(s) into " << SearchIndex::defaultDir() << "\n";
+    return 0;
 }
 
-std::string md_to_html(const std::string& md) {
-    std::stringstream html;
-    std::istringstream iss(md);
-    std::string line;
-    bool in_list = false;
+// Benchmarks the configured model (and its quantized siblings) across thread counts and stores the best setting.
+int run_calibrate(int argc, char** argv) {
+    Config::Data config = Config::load();
+    std::string wavPath; std::vector<std::string> models;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-f" || arg == "--file") && i + 1 < argc) wavPath = argv[++i];
+        else if (arg == "-m" && i + 1 < argc) config.model_path = argv[++i];
+        else if (arg == "--models" && i + 1 < argc) { std::stringstream ss(argv[++i]); std::string m; while (std::getline(ss, m, ',')) if (!m.empty()) models.push_back(m); }
+        else { std::cerr << "Usage: " << argv[0] << " calibrate [-f sample.wav] [-m model] [--models a.bin,b.bin]\n"; return 1; }
+    }
+    if (models.empty()) models = find_model_variants(config.model_path);
 
-    auto process_inline = [](std::string s) {
-        size_t b;
-        while ((b = s.find("**")) != std::string::npos) {
-            size_t e = s.find("**", b + 2);
-            if (e != std::string::npos) {
-                s.replace(e, 2, "</strong>");
-                s.replace(b, 2, "<strong>");
-            } else break;
-        }
-        while ((b = s.find("[[")) != std::string::npos) {
-            size_t e = s.find("]]", b + 2);
-            if (e != std::string::npos) {
-                s.erase(e, 2);
-                s.erase(b, 2);
-            } else break;
+    std::vector<float> audio;
+    if (!wavPath.empty()) {
+        if (!load_audio_file(wavPath, audio)) { std::cerr << "Could not read WAV file: " << wavPath << std::endl; return 1; }
+        if (audio.size() > (size_t)SAMPLE_RATE * 30) audio.resize(SAMPLE_RATE * 30); // one live window
+    } else {
+        // Voiced-sounding stand-in: harmonics on a wandering pitch, gated at syllable rate, plus noise.
+        std::cout << "No -f sample given; using synthetic audio (pass a real recording for representative numbers).\n";
+        audio.resize(SAMPLE_RATE * 30); uint32_t seed = 1; double phase = 0;
+        for (size_t i = 0; i < audio.size(); ++i) {
+            double t = (double)i / SAMPLE_RATE, f0 = 140 + 30 * std::sin(2 * M_PI * 0.7 * t);
+            phase += 2 * M_PI * f0 / SAMPLE_RATE;
+            double v = 0; for (int h = 1; h <= 8; ++h) v += std::sin(h * phase) / h;
+            seed = seed * 1664525 + 1013904223;
+            audio[i] = (float)(0.08 * v * std::max(0.0, std::sin(2 * M_PI * 4 * t)) + 0.005 * ((seed >> 8) / 16777216.0 - 0.5));
         }
-        return s;
-    };
+    }
 
-    while (std::getline(iss, line)) {
-        trim(line);
-        if (line.empty()) continue;
+    HardwareInfo hw = detect_hardware();
+    std::cout << "CPU: " << hw.logical << " logical, " << hw.physical << " physical";
+    if (hw.performance) std::cout << " (" << hw.performance << " performance)";
+    std::cout << " cores; benchmarking " << models.size() << " model(s) on " << audio.size() / SAMPLE_RATE << "s of audio\n";
+    auto results = calibrate(models, audio, hw.logical);
+    const CalibrationResult* best = pick_calibration(results);
+    if (!best) { std::cerr << "Calibration failed: no model could be loaded.\n"; return 1; }
 
-        if (line.rfind("- ", 0) == 0 || line.rfind("* ", 0) == 0) {
-            if (!in_list) { html << "<ul>"; in_list = true; }
-            std::string content = line.substr(2);
-            trim(content);
-            if (content.rfind("[ ]", 0) == 0) content = "<input type='checkbox' disabled> " + content.substr(3);
-            else if (content.rfind("[x]", 0) == 0) content = "<input type='checkbox' checked disabled> " + content.substr(3);
-            html << "<li>" << process_inline(content) << "</li>";
-        } else {
-            if (in_list) { html << "</ul>"; in_list = false; }
-            if (line.rfind("### ", 0) == 0) html << "<h4>" << process_inline(line.substr(4)) << "</h4>";
-            else if (line.rfind("## ", 0) == 0) html << "<h3>" << process_inline(line.substr(3)) << "</h3>";
-            else if (line.rfind("# ", 0) == 0) html << "<h2>" << process_inline(line.substr(2)) << "</h2>";
-            else if (line.rfind("> ", 0) == 0) html << "<blockquote>" << process_inline(line.substr(2)) << "</blockquote>";
-            else html << "<p>" << process_inline(line) << "</p>";
-        }
-    }
-    if (in_list) html << "</ul>";
-    return html.str();
+    config.model_path = best->model; config.n_threads = best->threads; config.calibrated_rtf = (float)best->rtf;
+    Config::save(config);
+    std::cout << "Saved: model " << best->model << ", " << best->threads << " threads (RTF " << std::fixed << std::setprecision(3) << best->rtf << ")";
+    if (best->rtf > LIVE_RTF_TARGET) std::cout << "\n\033[1;33mWarning: no model has live headroom on this machine; consider a smaller one.\033[0m";
+    std::cout << std::endl;
+    return 0;
 }
 
-void sync_action_items(const std::string& acts, const Config::Data& config, const std::string& meeting_title) {
-    auto trackers = IntegrationFactory::createTrackers(config);
-    if (trackers.empty()) return;
-    std::istringstream iss(acts);
-    std::string line;
-    while (std::getline(iss, line)) {
-        trim(line);
-        if (line.empty()) continue;
-        if (line.rfind("- ", 0) == 0) {
-            std::string task = line.substr(2);
-            if (task.rfind("[ ] ", 0) == 0) task = task.substr(4);
-            for (auto& tracker : trackers) {
-                std::cout << "Syncing: " << task << std::endl;
-                tracker->createIssue(task, "Automatically created from meeting: " + meeting_title);
-            }
-        }
-    }
+std::string ready_message(Transcriber& transcriber, std::chrono::steady_clock::time_point t_launch) {
+    auto s = transcriber.loadStats();
+    auto total = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_launch).count();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(0) << "Model ready in " << total << " ms (load " << s.load_ms << " ms, warm-up " << s.warmup_ms << " ms)";
+    return ss.str();
+}
+
+// Share of audio that adaptive decoding sent through the beam-search pass since `since`.
+std::string decode_message(Transcriber& transcriber, const Transcriber::DecodeStats& since = {}) {
+    auto s = transcriber.decodeStats();
+    double audio = s.audio_sec - since.audio_sec, re = s.redecoded_sec - since.redecoded_sec;
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "Re-decoded " << re << " s of " << audio << " s (" << (audio > 0 ? 100.0 * re / audio : 0.0) << "%): "
+       << s.redecoded - since.redecoded << " of " << s.segments - since.segments << " segments, " << s.improved - since.improved << " improved";
+    return ss.str();
 }
 
 void print_usage(const char* prog) {
     std::cout << "Meeting Assistant - Audio Transcription & AI Analysis\n\n";
-    std::cout << "Usage: " << prog << " [-f <input.wav> | -l | --tray] [options]\n\n";
+    std::cout << "Usage: " << prog << " [-f <input.wav> | -l | --serve [addr] | --watch <dir> | --tray] [options]\n";
+    std::cout << "       " << prog << " search <terms> [--limit n] [--meeting s] [--speaker n] [--since YYYY-MM-DD]\n";
+    std::cout << "       " << prog << " index <dir> | --compact\n";
+    std::cout << "       " << prog << " bench <corpus> [--mode file|live|both] [--out f.json] [--baseline f.json] [--tolerance k=v,..]\n";
+    std::cout << "       " << prog << " mock-server [--listen addr] [--latency-ms n] [--chunk-ms n] [--rate-limit f] [--retry-after s]\n";
+    std::cout << "       " << prog << " loadgen [--api ollama|openai|gemini|github|gitlab] [--url root] [-n requests] [-c concurrency]\n\n";
     std::cout << "Options:\n";
-    std::cout << "  -f, --file <path>      Input WAV file.\n";
+    std::cout << "  -f, --file <path>      Input WAV file or .maa archive.\n";
     std::cout << "  -l, --live             Live transcription mode.\n";
+    std::cout << "  --input <src>          Live input: mic (default), - (stdin), fifo:<path> or unix:<path>, raw PCM or WAV;\n";
+    std::cout << "                         raw options: <src>,fmt=s16le|f32le,rate=<hz>,ch=<n>. Implies -l.\n";
+    std::cout << "                         mic:<device> picks another input; join inputs with + to record them together,\n";
+    std::cout << "                         e.g. \"mic+remote=mic:BlackHole\".\n";
+    std::cout << "                         replay:<file>[,speed=<n>|max] runs a recording through the live path.\n";
+    std::cout << "  --mix <mode>           Several inputs: 'mix' (default; one stream, speakers by diarization) or 'channels'\n";
+    std::cout << "                         (label each segment with the input that carried it).\n";
+    std::cout << "  --list-devices         List audio input devices.\n";
+    std::cout << "  --replay-log <path>    With a replay input: write the emitted segments as NDJSON (no timing fields).\n";
     std::cout << "  --ui                   Show TUI dashboard (requires -l).\n";
     std::cout << "  --tray                 Start as macOS Tray Application.\n";
+    std::cout << "  --serve [addr]         Run a local job server (host:port or unix:/path, default 127.0.0.1:8765).\n";
+    std::cout << "  --watch <dir>          Transcribe recordings as they land in <dir> (with or without --serve).\n";
+    std::cout << "  --workers <n>          Concurrent transcription workers in --serve/--watch mode.\n";
+    std::cout << "  --queue-size <n>       Max queued jobs before the server rejects uploads (503).\n";
+    std::cout << "  --memory-budget <MB>   Size workers and audio/upload queues to fit; refuse setups that cannot.\n";
+    std::cout << "  --resume [journal]     Rebuild an interrupted live session from its journal (latest if omitted).\n";
+    std::cout << "                         Alone it regenerates the reports; with -l it keeps recording into it.\n";
+    std::cout << "  --no-journal           Do not journal live segments to disk.\n";
+    std::cout << "  --archive [codec]      Archive live audio to <output>/audio/*.maa ('lpc' lossless or 'pcm16').\n";
+    std::cout << "  --diarize [on|off|auto] Label speakers (auto: only with tinydiarize *tdrz* models).\n";
+    std::cout << "  --threads <n>          Inference threads (default: calibrated, else physical cores).\n";
+    std::cout << "  --stream <target>      NDJSON segment events to '-' (stdout), fifo:<path> or unix:<path>.\n";
+    std::cout << "  --cpu-profile <p>      Live inference scheduling: 'auto' (default), 'background' or 'realtime'.\n";
+    std::cout << "  --cpu-share <f>        Share of cores inference may use in the background profile (default 0.5).\n";
+    std::cout << "  --pin-audio            Linux: pin the audio callback to core 0 and keep inference off it.\n";
+    std::cout << "  --measure-jitter       Report wakeup jitter of a normal-priority probe thread during and between decodes.\n";
+    std::cout << "  --no-elide             Decode silences and breaks in -f files too (default: skip non-speech).\n";
+    std::cout << "  --decoding <mode>      'greedy' (default), 'adaptive' (beam re-decode of low-confidence segments) or 'beam'.\n";
+    std::cout << "  --refine-model <path>  Cascade: re-transcribe live windows in the background with a larger model.\n";
+    std::cout << "  --min-confidence <p>   Segment confidence below which adaptive decoding re-decodes (default 0.4).\n";
+    std::cout << "  --vocab \"<terms>\"      Names and product terms to bias live transcription towards.\n";
+    std::cout << "  --prompt-tokens <n>    Tokens of previous text carried into each live window (default 64).\n";
     std::cout << "  --persona <p>          'general', 'dev', 'pm', 'exec'.\n";
+    std::cout << "  --parallel-report [n]  Generate report sections as concurrent smaller requests (n at a time, default 3).\n";
+    std::cout << "  --export <list>        Report formats to write: md,html,email,json.\n";
     std::cout << "  --research             Enable AI grounding (Gemini only).\n";
     std::cout << "  -p <provider>          LLM Provider: ollama, gemini, openai.\n";
     std::cout << "  -k <key>               API Key or base URL.\n";
     std::cout << "  -L <model>             LLM Model name.\n";
+    std::cout << "  --llm-url <url>        Provider API root (OpenAI-compatible gateway, proxy, mock-server).\n";
     std::cout << "  --obsidian-vault-path  Path to your Obsidian vault root.\n";
     std::cout << "  --save-config          Save provided flags as default.\n";
 }
 
-void save_meeting_reports(const std::string& transcription, const Config::Data& config, const std::string& baseName) {
-    if (transcription.empty()) return;
-    std::string finalOutputDir = (config.mode == "obsidian" && !config.obsidian_vault_path.empty()) ? config.obsidian_vault_path : config.output_dir;
-    fs::create_directories(finalOutputDir);
-    
-    std::string tPath = finalOutputDir + "/" + baseName + "_transcript.md";
-    std::ofstream out_t(tPath); out_t << transcription;
-
-    if (config.provider.empty()) return;
-    auto client = ClientFactory::createClient(config.provider, config.api_key, config.llm_model);
-    if (!client) return;
-
-    std::cout << "Analyzing Meeting Content..." << std::endl;
-    std::string master = client->generateSummary(get_obsidian_prompt(config.persona) + transcription);
-    
-    if (master.empty() || (master.find("Error") != std::string::npos && master.length() < 150)) {
-        std::cerr << "Analysis failed: " << master << std::endl;
-        return;
-    }
-
-    auto ext = [&](const std::string& c, const std::string& s) {
-        size_t st = c.find(s); if (st == std::string::npos) return std::string();
-        st += s.length(); size_t en = c.find("---", st);
-        return c.substr(st, (en == std::string::npos) ? std::string::npos : en - st);
-    };
-    auto tsec = [](std::string& s) {
-        trim(s);
-        if (s.length() >= 3 && s.substr(s.length()-3) == "---") s = s.substr(0, s.length()-3);
-        trim(s);
-    };
-
-    std::string p = ext(master, "---PARTICIPANTS---"); tsec(p);
-    std::string t = ext(master, "---TAGS---"); tsec(t);
-    std::string title = ext(master, "---TITLE---"); tsec(title);
-    std::string topic = ext(master, "---TOPIC---"); tsec(topic);
-    std::string ys = ext(master, "---YAML_SUMMARY---"); tsec(ys);
-    std::string real_os = ext(master, "---OVERVIEW_SUMMARY---"); tsec(real_os);
-    std::string kt = ext(master, "---KEY_TAKEAWAYS---"); tsec(kt);
-    std::string ai = ext(master, "---AGENDA_ITEMS---"); tsec(ai);
-    std::string dp = ext(master, "---DISCUSSION_POINTS---"); tsec(dp);
-    std::string dm = ext(master, "---DECISIONS_MADE---"); tsec(dm);
-    std::string qa = ext(master, "---QUESTIONS_ARISEN---"); tsec(qa);
-    std::string acts = ext(master, "---ACTION_ITEMS---"); tsec(acts);
-    std::string graph = ext(master, "---MERMAID_GRAPH---"); tsec(graph);
-    std::string email = ext(master, "---EMAIL_DRAFT---"); tsec(email);
-
-    if (title.empty() || title.length() < 3) title = "Meeting " + baseName;
-    std::string san = title; for (char& c : san) { if (std::isspace(c)) c = '-'; else if (!std::isalnum(c) && c != '-') c = '_'; }
-    
-    auto now = std::chrono::system_clock::now(); auto t_now = std::chrono::system_clock::to_time_t(now);
-    std::stringstream date_ss; date_ss << std::put_time(std::localtime(&t_now), "%Y-%m-%d");
-    std::string fBase = san + "-" + date_ss.str();
-
-    std::string research;
-    if (config.research && config.provider == "gemini") {
-        std::this_thread::sleep_for(std::chrono::seconds(2));
-        research = client->researchTopics(transcription);
-    }
-
-    // 1. Markdown
-    std::stringstream note;
-    note << "---\ndate: " << date_ss.str() << "\ntype: meeting\ntopic: " << topic << "\nparticipants: [" << p << "]\ntags: [" << t << "]\nsummary: " << ys << "\n---\n\n";
-    note << "Status:: #processed\n\n> [!ABSTRACT] Summary\n> " << real_os << "\n\n> [!IMPORTANT] Takeaways\n" << kt << "\n\n";
-    if (!research.empty()) note << "> [!INFO] Research\n" << research << "\n\n";
-    if (!graph.empty() && graph.length() > 10) note << "## Map\n```mermaid\n" << graph << "\n```\n\n";
-    note << "## Meeting Details\n\n### Agenda\n" << ai << "\n\n### Discussion\n" << dp << "\n\n### Questions\n" << qa << "\n\n## Outcomes\n\n### Decisions\n" << dm << "\n\n### Action Items\n" << acts << "\n\n## Appendix\n<details><summary>Transcript</summary>\n\n```\n" << transcription << "\n```\n</details>\n";
-    std::ofstream(finalOutputDir + "/" + fBase + ".md") << note.str();
-
-    // 2. HTML (Masterclass Design)
-    std::stringstream html;
-    html << "<!DOCTYPE html><html lang='en'><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width, initial-scale=1.0'><title>" << title << "</title>"
-         << "<link rel='preconnect' href='https://fonts.googleapis.com'><link rel='preconnect' href='https://fonts.gstatic.com' crossorigin>"
-         << "<link href='https://fonts.googleapis.com/css2?family=Inter:wght@400;500;600&family=Plus+Jakarta+Sans:wght@700;800&display=swap' rel='stylesheet'><style>"
-         << ":root{--bg:#f8fafc;--sidebar:#ffffff;--primary:#0f172a;--accent:#6366f1;--text:#1e293b;--text-muted:#64748b;--border:#e2e8f0;--card-bg:#ffffff;--indigo-soft:#eef2ff;--emerald-soft:#ecfdf5;--amber-soft:#fffbeb}"
-         << "*{box-sizing:border-box} body{font-family:'Inter',sans-serif;background:var(--bg);color:var(--text);margin:0;display:flex;min-height:100vh;overflow-x:hidden}"
-         << "aside{width:260px;background:var(--sidebar);border-right:1px solid var(--border);padding:40px 24px;position:sticky;top:0;height:100vh;display:flex;flex-direction:column;flex-shrink:0}"
-         << "main{flex:1;padding:60px 80px;max-width:1100px;margin:0 auto} "
-         << ".logo{font-family:'Plus Jakarta Sans',sans-serif;font-weight:800;font-size:0.9rem;letter-spacing:0.1em;color:var(--primary);margin-bottom:48px;text-transform:uppercase}"
-         << ".nav-link{display:block;padding:10px 0;color:var(--text-muted);text-decoration:none;font-size:0.95rem;font-weight:500;transition:0.2s} .nav-link:hover{color:var(--accent)} .nav-link.active{color:var(--primary);font-weight:700}"
-         << ".section-header{font-family:'Plus Jakarta Sans',sans-serif;font-size:0.75rem;font-weight:700;color:var(--text-muted);text-transform:uppercase;letter-spacing:0.05em;margin:32px 0 12px 0}"
-         << "h1{font-family:'Plus Jakarta Sans',sans-serif;font-size:2.75rem;font-weight:800;letter-spacing:-0.03em;margin:0 0 16px 0;color:var(--primary)} "
-         << ".meta-bar{display:flex;flex-wrap:wrap;gap:24px;color:var(--text-muted);font-size:0.9rem;margin-bottom:48px;border-bottom:1px solid var(--border);padding-bottom:24px}"
-         << ".card{background:var(--card-bg);border-radius:12px;border:1px solid var(--border);padding:32px;margin-bottom:32px;transition:box-shadow 0.3s} .card:hover{box-shadow:0 10px 15px -3px rgba(0,0,0,0.05)}"
-         << ".callout{padding:24px;border-radius:8px;margin:24px 0;border-left:4px solid #dee2e6}"
-         << ".abstract{background:var(--indigo-soft);border-left-color:var(--accent)} .important{background:var(--amber-soft);border-left-color:#f59e0b} .info{background:var(--emerald-soft);border-left-color:#10b981}"
-         << "h2{font-family:'Plus Jakarta Sans',sans-serif;font-size:1.5rem;font-weight:700;margin:0 0 20px 0;color:var(--primary);display:flex;align-items:center;gap:12px} h3{font-family:'Plus Jakarta Sans',sans-serif;font-size:1.1rem;font-weight:700;margin:32px 0 12px 0;color:var(--text)}"
-         << "ul{padding-left:20px;margin:0} li{margin-bottom:10px} li::marker{color:var(--text-muted)}"
-         << "pre{background:#0f172a;color:#cbd5e1;padding:24px;border-radius:8px;overflow-x:auto;font-family:'JetBrains Mono','Fira Code',monospace;font-size:0.85rem;line-height:1.7}"
-         << "details{margin-top:24px} summary{cursor:pointer;color:var(--accent);font-weight:600;font-size:0.9rem;user-select:none;outline:none}"
-         << "@media(max-width:900px){body{flex-direction:column} aside{width:100%;height:auto;position:static;padding:24px;border-right:none;border-bottom:1px solid var(--border)} main{padding:40px 24px}}"
-         << "</style></head><body>"
-         << "<aside><div class='logo'>Meeting Assistant</div>"
-         << "<div class='section-header'>Analysis</div>"
-         << "<a href='#summary' class='nav-link active'>Overview</a><a href='#details' class='nav-link'>Key Details</a>"
-         << "<div class='section-header'>Output</div>"
-         << "<a href='#outcomes' class='nav-link'>Outcomes</a><a href='#transcript' class='nav-link'>Transcription</a></aside>"
-         << "<main><section id='summary'><h1>" << title << "</h1>"
-         << "<div class='meta-bar'><span>Date: " << date_ss.str() << "</span><span>Participants: " << p << "</span><span style='margin-left:auto'>Persona: <strong>" << config.persona << "</strong></span></div>"
-         << "<div class='callout abstract'><h2>Summary</h2><p>" << real_os << "</p></div>"
-         << "<div class='callout important'><h2>Key Takeaways</h2>" << md_to_html(kt) << "</div>";
-    
-    if (!research.empty()) html << "<div class='callout info'><h2>AI Research & Context</h2>" << md_to_html(research) << "</div>";
-    
-    html << "</section><section id='details' class='card'><h2>Meeting Details</h2><h3>Agenda</h3>" << md_to_html(ai) << "<h3>Discussion Points</h3>" << md_to_html(dp);
-    if (!qa.empty()) html << "<h3>Questions Arisen</h3>" << md_to_html(qa);
-    
-    html << "</section><section id='outcomes' class='card'><h2>Outcomes & Actions</h2><h3>Decisions</h3>" << md_to_html(dm) << "<h3>Action Items</h3>" << md_to_html(acts) << "</section>";
-    
-    html << "<section id='transcript' class='card'><h2>Raw Transcript</h2><details><summary>Expand full transcription log</summary><pre style='margin-top:20px'>" << transcription << "</pre></details></section></main></body></html>";
-    
-    std::ofstream(finalOutputDir + "/" + fBase + ".html") << html.str();
-    
-    if (!email.empty()) std::ofstream(finalOutputDir + "/" + fBase + "_email.txt") << email;
-    sync_action_items(acts, config, title);
-    std::cout << "[Success] Amazing reports generated: " << fBase << "\n";
-}
-
 int main(int argc, char** argv) {
     std::signal(SIGINT, signal_handler);
     Config::Data config = Config::load();
-    std::string wavPath;
-    bool liveAudio = false, saveConfig = false, showUI = false, useTray = false;
+    if (argc > 1 && std::string(argv[1]) == "search") return run_search(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "index") return run_index(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "calibrate") return run_calibrate(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "bench") return run_bench(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "mock-server") return run_mock_server(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "loadgen") return run_loadgen(argc, argv);
+    std::string wavPath, serveAddr, resumePath, replayLogPath;
+    bool liveAudio = false, saveConfig = false, showUI = false, useTray = false, serve = false, resume = false, measureJitter = false;
+    int workers = std::max(1, (int)std::thread::hardware_concurrency() / 4); size_t queueSize = 64;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -269,10 +247,38 @@ int main(int argc, char** argv) {
         else if (arg == "-l" || arg == "--live") liveAudio = true;
         else if (arg == "--ui") showUI = true;
         else if (arg == "--tray") useTray = true;
+        else if (arg == "--serve") { serve = true; if (i + 1 < argc && argv[i + 1][0] != '-') serveAddr = argv[++i]; }
+        else if (arg == "--input" && i + 1 < argc) { config.audio_input = argv[++i]; liveAudio = true; }
+        else if (arg == "--watch" && i + 1 < argc) config.watch_dir = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc) workers = std::stoi(argv[++i]);
+        else if (arg == "--queue-size" && i + 1 < argc) queueSize = std::stoul(argv[++i]);
+        else if (arg == "--memory-budget" && i + 1 < argc) config.memory_budget_mb = std::stoi(argv[++i]);
+        else if (arg == "--resume") { resume = true; if (i + 1 < argc && argv[i + 1][0] != '-') resumePath = argv[++i]; }
+        else if (arg == "--no-journal") config.journal = false;
+        else if (arg == "--archive") { config.archive_audio = true; if (i + 1 < argc && argv[i + 1][0] != '-') config.archive_codec = argv[++i]; }
+        else if (arg == "--diarize") { config.diarize = "on"; if (i + 1 < argc && argv[i + 1][0] != '-') config.diarize = argv[++i]; }
+        else if (arg == "--threads" && i + 1 < argc) config.n_threads = std::stoi(argv[++i]);
+        else if (arg == "--vocab" && i + 1 < argc) config.vocabulary = argv[++i];
+        else if (arg == "--prompt-tokens" && i + 1 < argc) config.prompt_tokens = std::stoi(argv[++i]);
+        else if (arg == "--parallel-report") { config.report_mode = "parallel"; if (i + 1 < argc && argv[i + 1][0] != '-') config.llm_concurrency = std::stoi(argv[++i]); }
+        else if (arg == "--export" && i + 1 < argc) config.export_formats = argv[++i];
+        else if (arg == "--no-elide") config.elide_silence = false;
+        else if (arg == "--cpu-profile" && i + 1 < argc) config.cpu_profile = argv[++i];
+        else if (arg == "--cpu-share" && i + 1 < argc) config.cpu_share = std::stof(argv[++i]);
+        else if (arg == "--pin-audio") config.pin_audio_core = true;
+        else if (arg == "--measure-jitter") measureJitter = true;
+        else if (arg == "--list-devices") { list_audio_devices(); return 0; }
+        else if (arg == "--replay-log" && i + 1 < argc) replayLogPath = argv[++i];
+        else if (arg == "--mix" && i + 1 < argc) config.audio_mix = argv[++i];
+        else if (arg == "--stream" && i + 1 < argc) config.stream = argv[++i];
+        else if (arg == "--decoding" && i + 1 < argc) config.decoding = argv[++i];
+        else if (arg == "--refine-model" && i + 1 < argc) config.refine_model = argv[++i];
+        else if (arg == "--min-confidence" && i + 1 < argc) config.min_confidence = std::stof(argv[++i]);
         else if (arg == "--research") config.research = true;
         else if (arg == "-m" && i + 1 < argc) config.model_path = argv[++i];
         else if (arg == "-p" && i + 1 < argc) config.provider = argv[++i];
         else if (arg == "-k" && i + 1 < argc) config.api_key = argv[++i];
+        else if (arg == "--llm-url" && i + 1 < argc) config.llm_base_url = argv[++i];
         else if (arg == "-L" && i + 1 < argc) config.llm_model = argv[++i];
         else if (arg == "-o" && i + 1 < argc) config.output_dir = argv[++i];
         else if (arg == "--mode" && i + 1 < argc) config.mode = argv[++i];
@@ -294,107 +300,281 @@ int main(int argc, char** argv) {
     }
 #endif
 
+    auto t_launch = std::chrono::steady_clock::now();
+    if (serve || !config.watch_dir.empty()) {
+        MemoryPlan memPlan;
+        if (!plan_server(config, workers, memPlan)) return 1;
+        if (memPlan.budget) { workers = memPlan.states; std::cout << "Memory plan: " << memPlan.describe() << std::endl; }
+        Transcriber transcriber(config.model_path, workers, true); transcriber.setDecodePolicy(Transcriber::decodePolicyFor(config));
+        MeetingServer server(config, transcriber, workers, queueSize); server.setMemoryPlan(memPlan);
+        std::unique_ptr<WatchFolder> watch;
+        if (!config.watch_dir.empty()) {
+            watch = std::make_unique<WatchFolder>(config, server, config.watch_dir);
+            server.setOnFinished([&watch](const Job& job) { watch->jobFinished(job); });
+        }
+        if (serve && !server.listen(serveAddr.empty() ? "127.0.0.1:8765" : serveAddr)) return 1;
+        server.start();
+        if (watch && !watch->start()) { server.stop(); return 1; }
+        if (!transcriber.isLoaded()) { server.stop(); return 1; }
+        std::cout << ready_message(transcriber, t_launch) << std::endl;
+        while (!shutdown_requested) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        std::cout << "\nShutting down server..." << std::endl;
+        // Jobs already accepted are finished before the workers exit.
+        server.stop();
+        if (watch) { watch->stop(); std::cout << watch->summary() << std::endl; }
+        if (config.decoding == "adaptive") std::cout << decode_message(transcriber) << std::endl;
+        return 0;
+    }
+
+    SegmentStream segStream;
+    if (!config.stream.empty() && (liveAudio || !wavPath.empty())) {
+        if (!segStream.open(config.stream)) return 1;
+        if (segStream.usesStdout()) std::cout.rdbuf(std::cerr.rdbuf()); // stdout carries only NDJSON from here on
+    }
+
+    TranscriptJournal::Session resumed;
+    if (resume) {
+        if (resumePath.empty()) resumePath = TranscriptJournal::findLatestUnfinished();
+        if (resumePath.empty() || !TranscriptJournal::load(resumePath, resumed)) { std::cerr << "No unfinished journal to resume.\n"; return 1; }
+        std::cout << "Resuming " << resumed.baseName << " (" << resumed.segments << " segments, " << format_timestamp(resumed.last_ms) << ")" << std::endl;
+        if (!liveAudio) {
+            save_meeting_reports(resumed.transcript->render(), index_segments(*resumed.transcript), config, resumed.baseName);
+            TranscriptJournal::markCompleted(resumePath);
+            return 0;
+        }
+    }
+
     if (wavPath.empty() && !liveAudio) { print_usage(argv[0]); return 1; }
 
-    Transcriber transcriber(config.model_path);
-    
+    MemoryPlan memPlan;
+    if (!plan_session(config, liveAudio, memPlan)) return 1;
+    if (memPlan.budget) std::cout << "Memory plan: " << memPlan.describe() << std::endl;
+    // The model loads and warms up in the background while the mic opens or the input file is decoded.
+    Transcriber transcriber(config.model_path, 1, true); transcriber.setDecodePolicy(Transcriber::decodePolicyFor(config));
+    // Cascade: the larger second-pass model loads alongside and re-transcribes finalized live windows.
+    std::unique_ptr<Transcriber> refineModel;
+    if (liveAudio && !config.refine_model.empty()) {
+        refineModel = std::make_unique<Transcriber>(config.refine_model, 1, true); refineModel->setDecodePolicy(Transcriber::decodePolicyFor(config));
+    }
+
     if (liveAudio) {
         bool keep_running = true;
+        ResourceGovernor::elevateCurrentThread(); // the capture loop; inference runs on governed threads
+        // Whisper context between windows: vocabulary prefix tokenized once, decoded tokens carried over.
+        Transcriber::PromptState prompt; prompt.budget = config.prompt_tokens; bool vocab_tokenized = false;
         while (keep_running && !shutdown_requested) {
-            std::stringstream trans_text; std::string rolling_context = "";
-            AudioCapture audioCapture; if (!audioCapture.startCapture()) { std::cerr << "Mic failed.\n"; return 1; }
+            auto transcript = std::make_shared<TranscriptStore>(); std::string baseName, journalPath; int64_t resume_ms = 0;
+            prompt.history.clear();
+            if (!resumed.path.empty()) {
+                transcript = resumed.transcript; resume_ms = resumed.last_ms;
+                baseName = resumed.baseName; journalPath = resumed.path; resumed = TranscriptJournal::Session();
+            } else {
+                auto now = std::chrono::system_clock::now(); auto t_now = std::chrono::system_clock::to_time_t(now);
+                std::stringstream ss; ss << std::put_time(std::localtime(&t_now), "%Y%m%d_%H%M%S");
+                baseName = "meeting_" + ss.str(); journalPath = TranscriptJournal::journalDir() + "/" + baseName + ".ndjson";
+            }
+            TranscriptJournal journal; auto decode_start = transcriber.decodeStats();
+            segStream.event({{"type", "start"}, {"session", baseName}, {"source", "live"}, {"offset_ms", resume_ms}});
+            bool diarize = Diarizer::enabledFor(config); Diarizer diarizer(Diarizer::modelSupportsTurns(config.model_path));
+            if (config.journal && !journal.open(journalPath, baseName, config.journal_flush_ms)) std::cerr << "Journal disabled: cannot open " << journalPath << "\n";
+            AudioArchiveWriter archive; std::string archivePath;
+            if (config.archive_audio) {
+                fs::create_directories(fs::path(config.output_dir) / "audio");
+                archivePath = (fs::path(config.output_dir) / "audio" / (baseName + ".maa")).string();
+                // A resumed session gets a new archive part rather than overwriting the first one.
+                for (int part = 2; fs::exists(archivePath); ++part) archivePath = (fs::path(config.output_dir) / "audio" / (baseName + "_part" + std::to_string(part) + ".maa")).string();
+                if (!archive.open(archivePath, config.archive_codec == "pcm16" ? ArchiveCodec::PCM16 : ArchiveCodec::LPC)) std::cerr << "Cannot open audio archive " << archivePath << "\n";
+            }
+            auto copilotClient = Scheduler::shared().submit(Scheduler::Lane::Copilot, [&config]() -> std::unique_ptr<LLMClient> {
+                return config.provider.empty() ? nullptr : ClientFactory::createClient(config.provider, config.api_key, config.llm_model, config.llm_base_url);
+            });
+            std::unique_ptr<LLMClient> copilot; Scheduler::Future<void> copilotAnswer;
+            auto audioSource = create_audio_source(config.audio_input); if (!audioSource) return 1;
+            if (archive.isOpen()) audioSource->setArchive(&archive);
+            audioSource->setMaxPending(memPlan.audio_queue_samples); bool warned_memory = false, attribution_lost = false;
+            // A replay is deterministic only if no audio piles up while the model loads and thread counts stay put.
+            auto* replay = dynamic_cast<ReplaySource*>(audioSource.get());
+            if (replay && !transcriber.isLoaded()) return 1;
+            std::ofstream replayLog; if (!replayLogPath.empty()) replayLog.open(replayLogPath);
+            if (!audioSource->startCapture()) { std::cerr << "Cannot open audio input: " << audioSource->describe() << "\n"; return 1; }
             std::thread ui_thread;
             if (showUI) {
-                TerminalUI::setEnabled(true); TerminalUI::init(); TerminalUI::clearSegments(); TerminalUI::setStatus("Recording");
+                TerminalUI::setEnabled(true); TerminalUI::init(); TerminalUI::setTranscript(transcript.get()); TerminalUI::setStatus(transcriber.isReady() ? "Recording" : "Recording (loading model...)");
                 ui_thread = std::thread([]{ TerminalUI::loop(); });
-            } else { std::cout << "Recording... (Ctrl+C to stop)\n"; }
+            } else { std::cout << "Recording from " << audioSource->describe() << "... (Ctrl+C to stop)\n"; }
+            // With several inputs in "channels" mode, each segment is labelled with the source that carried it.
+            const auto sourceLabels = audioSource->sourceLabels(); const bool bySource = config.audio_mix == "channels" && sourceLabels.size() > 1;
+            if (bySource && !showUI) for (size_t i = 0; i < sourceLabels.size(); ++i) std::cout << "Speaker " << i + 1 << " = " << sourceLabels[i] << "\n";
+            size_t consumed = 0; // samples taken from the source so far
+
+            const int chunk_ms = 100; const int chunk_samples = SAMPLE_RATE * chunk_ms / 1000;
+            WindowCutter window(config); bool announced = transcriber.isReady();
+            ThreadTuner tuner(default_threads(config), detect_hardware().logical, config.calibrated_rtf); bool warned_slow = false;
+            ResourceGovernor governor(config, detect_hardware().logical, measureJitter);
+            std::unique_ptr<Refiner> refiner;
+            if (refineModel) refiner = std::make_unique<Refiner>(*refineModel, config, transcript, governor,
+                [&segStream](int64_t from_ms, int64_t to_ms, const std::vector<TranscriptionSegment>& segs) {
+                    nlohmann::json list = nlohmann::json::array();
+                    for (const auto& s : segs) list.push_back({{"t0_ms", s.t0}, {"t1_ms", s.t1}, {"text", s.text}, {"speaker", s.speaker_id}, {"confidence", s.confidence}});
+                    segStream.event({{"type", "revision"}, {"t0_ms", from_ms}, {"t1_ms", to_ms}, {"segments", list}});
+                });
 
-            float silence_ms = 0; const int chunk_ms = 100; const int chunk_samples = SAMPLE_RATE * chunk_ms / 1000;
-            auto start_time = std::chrono::steady_clock::now();
-            float total_rms = 0; int rms_count = 0; std::vector<float> pcmf32_data;
+            int64_t last_speech_ms = resume_ms; std::string seed_context = transcript->tail(200);
 
-            while (!shutdown_requested && !TerminalUI::isFinishRequested()) {
-                if (showUI && TerminalUI::isCopilotRequested()) {
-                    if (!config.provider.empty()) {
-                        auto client = ClientFactory::createClient(config.provider, config.api_key, config.llm_model);
-                        if (client) {
-                            std::string ans = client->generateSummary("Context: " + rolling_context + "\n\nQ: " + TerminalUI::getCopilotQuestion() + "\n\nAnswer concisely:");
-                            TerminalUI::showCopilotResponse(ans);
-                        }
+            // Transcribes and clears the buffered window, including audio captured before the model was ready.
+            auto process_buffer = [&]() {
+                if (window.hasSpeech()) {
+                    const std::vector<float>& pcmf32_data = window.samples();
+                    if (showUI) TerminalUI::setStatus("Processing...");
+                    // Offsets come from the sample count, so they hold under backlog and replay at any speed.
+                    int64_t off_ms = resume_ms + (int64_t)((consumed - pcmf32_data.size()) * 1000 / SAMPLE_RATE);
+                    if (!vocab_tokenized) { vocab_tokenized = true; if (!config.vocabulary.empty()) prompt.vocabulary = transcriber.tokenize(" " + config.vocabulary); }
+                    if (!seed_context.empty()) { prompt.history = transcriber.tokenize(" " + seed_context); seed_context.clear(); }
+                    // After a long silence the previous words are more likely to mislead than help.
+                    if (off_ms - last_speech_ms > config.prompt_reset_ms) prompt.history.clear();
+                    last_speech_ms = off_ms + (int64_t)(pcmf32_data.size() * 1000 / SAMPLE_RATE);
+                    auto t_proc = std::chrono::steady_clock::now(); std::vector<TranscriptionSegment> segments;
+                    int n_threads = replay ? default_threads(config) : governor.threads(tuner.threads());
+                    governor.run([&]{ segments = transcriber.transcribe(pcmf32_data, n_threads, prompt, [&](int p){ if (showUI) TerminalUI::updateProgress(p); }); }, n_threads);
+                    double audio_sec = pcmf32_data.size() / (double)SAMPLE_RATE, proc_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_proc).count();
+                    double backlog_sec = audioSource->pendingSamples() / (double)SAMPLE_RATE;
+                    if (replay) replay->recordWindow(audio_sec, proc_sec, backlog_sec);
+                    tuner.record(audio_sec, proc_sec, backlog_sec); governor.record(audio_sec, proc_sec, backlog_sec);
+                    // The plan is an estimate; say so once if the process outgrows the budget anyway.
+                    const size_t rss = memPlan.budget && !warned_memory ? current_rss() : 0;
+                    if (rss > memPlan.budget) {
+                        warned_memory = true;
+                        std::string msg = "Memory over budget (RSS " + std::to_string(rss >> 20) + " MB of " + std::to_string(config.memory_budget_mb) + " MB)";
+                        if (showUI) TerminalUI::setStatus(msg); else std::cerr << msg << std::endl;
+                    }
+                    if (tuner.saturated() && !warned_slow) {
+                        warned_slow = true;
+                        std::string msg = "Falling behind real time (RTF " + std::to_string(tuner.rtf()).substr(0, 4) + ") - try a smaller model or run 'calibrate'";
+                        if (showUI) TerminalUI::setStatus(msg); else std::cerr << msg << std::endl;
+                    }
+                    // dominantSource() counts every sample the inputs produced, consumed only those taken; once the
+                    // bounded queue has dropped some they no longer line up, so stop labelling rather than mislabel.
+                    if (bySource && !attribution_lost && audioSource->droppedSamples()) {
+                        attribution_lost = true;
+                        std::string msg = "Capture queue overflowed - speakers are no longer labelled by input";
+                        if (showUI) TerminalUI::setStatus(msg); else std::cerr << msg << std::endl;
                     }
+                    if (bySource && !attribution_lost) {
+                        size_t win_start = consumed - pcmf32_data.size();
+                        for (auto& seg : segments) seg.speaker_id = audioSource->dominantSource(win_start + seg.t0 * SAMPLE_RATE / 100, win_start + seg.t1 * SAMPLE_RATE / 100);
+                    } else if (diarize) diarizer.assign(segments, pcmf32_data);
+                    for (const auto& seg : segments) {
+                        std::string txt = seg.text; trim(txt); if (txt.length() < 2) continue;
+                        transcript->append(seg.t0 * 10 + off_ms, seg.t1 * 10 + off_ms, seg.speaker_id, txt); // IDs may shift under the refiner
+                        if (!showUI) std::cout << format_segment_line(seg.t0 * 10 + off_ms, seg.speaker_id, txt) << std::endl;
+                        if (journal.isOpen()) journal.append(format_timestamp(seg.t0 * 10 + off_ms), txt, seg.t0 * 10 + off_ms, seg.t1 * 10 + off_ms, seg.speaker_id);
+                        segStream.segment(seg.t0 * 10 + off_ms, seg.t1 * 10 + off_ms, txt, seg.speaker_id, seg.confidence, true);
+                        if (replay) replay->recordSegment((seg.t1 * 10 + off_ms - resume_ms) / 1000.0, consumed / (double)SAMPLE_RATE);
+                        if (replayLog.is_open()) replayLog << nlohmann::json{{"t0_ms", seg.t0 * 10 + off_ms}, {"t1_ms", seg.t1 * 10 + off_ms}, {"speaker", seg.speaker_id}, {"text", txt}}.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << "\n";
+                    }
+                    if (refiner) refiner->submit(pcmf32_data, off_ms);
+                }
+                window.clear();
+            };
+
+            while (!shutdown_requested && !TerminalUI::isFinishRequested() && !(audioSource->finished() && audioSource->pendingSamples() == 0)) {
+                // Answered on the Copilot lane, one question at a time, so capture keeps draining the device meanwhile.
+                if (showUI && TerminalUI::isCopilotRequested() && (!copilotAnswer.valid() || copilotAnswer.ready())) {
+                    std::string question = "Transcript: " + transcript->tail(200) + "\n\nQ: " + TerminalUI::getCopilotQuestion();
                     TerminalUI::resetCopilotRequest();
+                    copilotAnswer = Scheduler::shared().submit(Scheduler::Lane::Copilot, [&copilotClient, &copilot, question] {
+                        if (copilotClient.valid()) copilot = copilotClient.get();
+                        if (!copilot) return;
+                        std::string ans = copilot->generate(COPILOT_PROMPT, question);
+                        TerminalUI::showCopilotResponse(ans + "\n\n[" + format_usage(copilot->lastUsage()) + "]");
+                    });
                 }
 
+                if (!announced && transcriber.isReady()) {
+                    announced = true;
+                    if (!transcriber.isLoaded()) { shutdown_requested = 1; break; }
+                    if (showUI) TerminalUI::setStatus("Recording"); else std::cout << ready_message(transcriber, t_launch) << std::endl;
+                }
                 std::vector<float> chunk;
-                if (audioCapture.getAudioChunk(chunk, chunk_samples)) {
-                    pcmf32_data.insert(pcmf32_data.end(), chunk.begin(), chunk.end());
-                    float rms = calculate_rms(chunk); total_rms += rms; rms_count++;
+                if (audioSource->getAudioChunk(chunk, chunk_samples)) {
+                    float rms = window.add(chunk); consumed += chunk.size();
                     if (showUI) TerminalUI::updateLevel(rms, config.vad_threshold);
-                    if (rms < config.vad_threshold) silence_ms += chunk_ms; else silence_ms = 0;
-                    float buffer_sec = pcmf32_data.size() / (float)SAMPLE_RATE;
-                    if ((silence_ms >= config.vad_silence_ms && buffer_sec > 2.0f) || buffer_sec >= 30.0f) {
-                        if (total_rms / rms_count > config.vad_threshold * 0.5f) {
-                            if (showUI) TerminalUI::setStatus("Processing...");
-                            auto now_st = std::chrono::steady_clock::now(); auto el_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now_st - start_time).count();
-                            int64_t off_ms = el_ms - (int64_t)(buffer_sec * 1000.0f);
-                            auto segments = transcriber.transcribe(pcmf32_data, 4, rolling_context, [&](int p){ if (showUI) TerminalUI::updateProgress(p); });
-                            for (const auto& seg : segments) {
-                                std::string txt = seg.text; trim(txt); if (txt.length() < 2) continue;
-                                std::string ts = format_timestamp(seg.t0 * 10 + off_ms);
-                                if (showUI) TerminalUI::addSegment(ts, txt); else std::cout << ts << ": " << txt << std::endl;
-                                trans_text << ts << ": " << txt << "\n"; rolling_context += " " + txt;
-                                if (rolling_context.length() > 200) rolling_context = rolling_context.substr(rolling_context.length() - 200);
-                            }
-                        }
-                        pcmf32_data.clear(); silence_ms = 0; total_rms = 0; rms_count = 0; if (showUI) TerminalUI::setStatus("Recording");
+                    // Until the model is ready, audio keeps accumulating in the buffer and is transcribed in one go.
+                    if (transcriber.isReady() && window.due()) {
+                        process_buffer(); if (showUI) TerminalUI::setStatus("Recording");
                     }
                 } else std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
-            audioCapture.stopCapture();
+            audioSource->stopCapture();
+            audioSource->setArchive(nullptr);
+            if (copilotAnswer.valid()) copilotAnswer.wait();
+            if (!window.samples().empty() && transcriber.isLoaded()) process_buffer();
             bool is_new = TerminalUI::isNewMeetingRequested();
-            if (showUI) { TerminalUI::stop(); if (ui_thread.joinable()) ui_thread.join(); }
-            if (!trans_text.str().empty()) {
-                auto now = std::chrono::system_clock::now(); auto t_now = std::chrono::system_clock::to_time_t(now);
-                std::stringstream ss; ss << std::put_time(std::localtime(&t_now), "%Y%m%d_%H%M%S");
-                save_meeting_reports(trans_text.str(), config, "meeting_" + ss.str());
+            if (showUI) { TerminalUI::stop(); if (ui_thread.joinable()) ui_thread.join(); TerminalUI::setTranscript(nullptr); }
+            if (refiner) {
+                if (int left = refiner->stats().pending) std::cout << "Refining the last " << left << " window(s) with " << fs::path(config.refine_model).filename().string() << "..." << std::endl;
+                refiner->finish(); auto rs = refiner->stats();
+                std::cout << "Cascade: " << rs.windows << " windows (" << std::fixed << std::setprecision(1) << rs.audio_sec << " s) re-transcribed, " << rs.changed
+                          << " changed, RTF " << std::setprecision(2) << (rs.audio_sec > 0 ? rs.proc_sec / rs.audio_sec : 0.0) << "; report waited "
+                          << std::setprecision(1) << rs.drain_sec << " s for the backlog";
+                if (rs.dropped) std::cout << "; " << rs.dropped << " window(s) (" << rs.dropped_sec << " s) left unrefined, the queue was full";
+                std::cout << "\n";
+            }
+            if (archive.isOpen()) {
+                archive.close(); auto as = archive.stats();
+                std::cout << "Audio archive: " << archivePath << " (" << as.samples / SAMPLE_RATE << "s, " << as.bytes / 1024 << " KB, "
+                          << std::fixed << std::setprecision(2) << (as.samples ? as.bytes * 8.0 / as.samples : 0.0) << " bits/sample, " << as.dropped << " dropped)\n";
+            }
+            if (replay) std::cout << replay->summary() << "\n";
+            if (auto* multi = dynamic_cast<MultiSource*>(audioSource.get())) {
+                std::cout << "Sources:";
+                for (const auto& s : multi->stats())
+                    std::cout << " " << s.label << " (drift " << std::showpos << std::fixed << std::setprecision(0) << s.drift_ppm << std::noshowpos << " ppm, "
+                              << std::setprecision(1) << s.active_sec << " s active, " << s.underruns << " underruns, " << s.overruns << " overruns)";
+                std::cout << "\n";
+            }
+            segStream.event({{"type", "end"}, {"session", baseName}, {"segments", transcript->size()}});
+            if (!transcript->empty()) {
+                if (config.decoding == "adaptive") std::cout << decode_message(transcriber, decode_start) << "\n";
+                std::cout << governor.summary() << "\n" << Scheduler::shared().summary() << "\n";
+                if (memPlan.budget) std::cout << memory_report(memPlan) << "; " << audioSource->droppedSamples() / SAMPLE_RATE << " s of audio dropped from the capture queue\n";
+                auto ms = transcript->memory(); double hours = std::max(ms.audio_ms, (int64_t)1) / 3600000.0;
+                std::cout << "Transcript: " << ms.entries << " segments, " << ms.text_bytes / 1024 << " KB text in " << (ms.arena_bytes + ms.index_bytes) / 1024
+                          << " KB (" << std::fixed << std::setprecision(0) << (ms.arena_bytes + ms.index_bytes) / 1024.0 / hours << " KB per audio hour)\n";
+                save_meeting_reports(transcript->render(), index_segments(*transcript), config, baseName);
+            }
+            if (journal.isOpen()) {
+                journal.close(true); auto js = journal.stats();
+                if (transcript->empty()) fs::remove(journalPath);
+                else std::cout << "Journal: " << js.records << " segments, " << js.fsyncs << " fsyncs, append avg " << std::fixed << std::setprecision(1)
+                               << js.append_avg_us << "us (max " << js.append_max_us << "us), fsync avg " << js.fsync_avg_ms << "ms (max " << js.fsync_max_ms << "ms)\n";
             }
             if (!is_new) keep_running = false; else TerminalUI::resetNewMeetingRequest();
         }
     } else {
-        std::ifstream file(wavPath, std::ios::binary); if (!file.is_open()) return 1;
-        char bh[4]; file.read(bh, 4); file.ignore(4); file.read(bh, 4);
-        uint16_t af=0, nc=0, bps=0; uint32_t sr=0, ds=0;
-        while (file.read(bh, 4)) {
-            std::string id(bh, 4); uint32_t chunk_sz; file.read(reinterpret_cast<char*>(&chunk_sz), 4);
-            if (id == "fmt ") { file.read(reinterpret_cast<char*>(&af), 2); file.read(reinterpret_cast<char*>(&nc), 2); file.read(reinterpret_cast<char*>(&sr), 4); file.ignore(6); file.read(reinterpret_cast<char*>(&bps), 2); file.ignore(chunk_sz - 16); }
-            else if (id == "data") { ds = chunk_sz; break; } else file.ignore(chunk_sz);
-        }
-        if (sr == 0) return 1;
-        std::vector<char> raw(ds); file.read(raw.data(), ds); file.close();
-        std::vector<float> p_raw; size_t ns = ds / (std::max((int)nc, 1) * std::max((int)bps / 8, 1));
-        for (size_t i = 0; i < ns; ++i) {
-            float s = 0; for (int c = 0; c < nc; ++c) {
-                size_t o = (i * nc + c) * (bps / 8);
-                if (bps == 16) { int16_t v; std::memcpy(&v, raw.data() + o, 2); s += v / 32768.0f; }
-                else if (bps == 32 && af == 3) { float v; std::memcpy(&v, raw.data() + o, 4); s += v; }
-            }
-            p_raw.push_back(s / std::max((int)nc, 1));
-        }
         std::vector<float> p_data;
-        if (sr != 16000) {
-            double r = 16000.0 / sr; size_t n_new = p_raw.size() * r;
-            for (size_t i = 0; i < n_new; ++i) {
-                double idx = i / r; size_t x1 = (size_t)idx, x2 = x1 + 1;
-                if (x2 >= p_raw.size()) p_data.push_back(p_raw[x1]);
-                else p_data.push_back(p_raw[x1] * (1.0 - (idx - x1)) + p_raw[x2] * (idx - x1));
-            }
-        } else p_data = std::move(p_raw);
+        if (!load_audio_file(wavPath, p_data)) { std::cerr << "Could not read WAV file: " << wavPath << std::endl; return 1; }
+        // Drop silences and breaks before decoding (runs while the model is still loading).
+        std::vector<float> speech; SpeechMap speechMap;
+        if (config.elide_silence) { SpeechMap::Options opt; opt.max_threshold = config.vad_threshold; speechMap = SpeechMap::build(p_data, speech, opt); }
+        memPlan.job_audio = (p_data.size() + speech.size()) * sizeof(float); // the whole recording is decoded up front
         
+        if (!transcriber.isLoaded()) return 1;
+        std::cout << ready_message(transcriber, t_launch) << std::endl;
         std::cout << "\033[1;34mTranscribing WAV file...\033[0m" << std::endl;
         auto start_proc = std::chrono::steady_clock::now();
         const char* spin = "⠋⠙⠹⠸⠼⠴⠦⠧⠇⠏";
         
-        auto segs = transcriber.transcribe(p_data, 4, "", [&](int p){
+        // Segments are streamed as they are decoded; speaker labels need the whole file, so with diarization
+        // these are partial and the labelled list follows as final events.
+        const bool diarize = Diarizer::enabledFor(config);
+        segStream.event({{"type", "start"}, {"session", fs::path(wavPath).stem().string()}, {"source", "file"}});
+        Transcriber::SegmentCallback onSegment = nullptr;
+        if (segStream.isOpen()) onSegment = [&](const TranscriptionSegment& s) {
+            TranscriptionSegment m = s; speechMap.remap(m); trim(m.text);
+            if (m.text.length() >= 2) segStream.segment(m.t0 * 10, m.t1 * 10, m.text, m.speaker_id, m.confidence, !diarize);
+        };
+        auto segs = transcriber.transcribe(speech.empty() ? p_data : speech, default_threads(config), "", [&](int p){
             auto now = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_proc).count();
             int width = 40;
@@ -412,12 +592,37 @@ int main(int argc, char** argv) {
                 std::cout << " | ETA: " << std::max(0, (int)eta) << "s";
             }
             std::cout << std::flush;
-        });
+        }, onSegment);
         std::cout << "\r\033[K\033[1;32m✔ Transcription Complete! [100%]\033[0m" << std::endl;
+        double proc_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_proc).count();
+        if (!speech.empty()) {
+            speechMap.remap(segs); std::vector<float>().swap(speech);
+            double src_sec = speechMap.sourceSamples() / (double)SAMPLE_RATE, kept_sec = speechMap.keptSamples() / (double)SAMPLE_RATE;
+            std::cout << std::fixed << std::setprecision(1) << "Skipped " << 100.0 * speechMap.skippedFraction() << "% of the audio as non-speech ("
+                      << src_sec - kept_sec << " s of " << src_sec << " s, " << speechMap.table().size() << " speech spans): " << kept_sec << " s decoded in "
+                      << proc_sec << " s, ~" << std::setprecision(2) << src_sec / kept_sec << "x less audio (RTF " << proc_sec / src_sec << " on the full file)" << std::endl;
+        }
+        if (config.decoding == "adaptive") std::cout << decode_message(transcriber) << std::endl;
+        if (memPlan.budget) std::cout << memory_report(memPlan) << std::endl;
         
-        std::stringstream ft;
-        for (const auto& s : segs) ft << format_timestamp(s.t0 * 10) << ": " << s.text << "\n";
-        save_meeting_reports(ft.str(), config, fs::path(wavPath).stem().string());
+        if (diarize) {
+            Diarizer diarizer(Diarizer::modelSupportsTurns(config.model_path));
+            diarizer.assign(segs, p_data);
+            std::cout << "Speakers detected: " << diarizer.speakerCount() << std::endl;
+            for (auto s : segs) { trim(s.text); if (s.text.length() >= 2) segStream.segment(s.t0 * 10, s.t1 * 10, s.text, s.speaker_id, s.confidence, true); }
+        }
+        segStream.event({{"type", "end"}, {"session", fs::path(wavPath).stem().string()}, {"segments", segs.size()}});
+        std::stringstream ft; std::vector<SearchIndex::Segment> indexed;
+        for (const auto& s : segs) {
+            ft << format_segment_line(s.t0 * 10, s.speaker_id, s.text) << "\n";
+            std::string txt = s.text; trim(txt); if (!txt.empty()) indexed.push_back({s.t0 * 10, s.speaker_id, txt});
+        }
+        save_meeting_reports(ft.str(), indexed, config, fs::path(wavPath).stem().string());
+    }
+    if (segStream.isOpen()) {
+        segStream.close(); auto ss = segStream.stats();
+        std::cerr << "Stream: " << ss.published << " events, " << ss.written << " delivered, " << ss.dropped << " dropped, max lag "
+                  << std::fixed << std::setprecision(1) << ss.max_lag_ms << " ms" << std::endl;
     }
     return 0;
 }
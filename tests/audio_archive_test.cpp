@@ -0,0 +1,51 @@
+// .maa archives: 16-bit samples come back bit-exact from both codecs, in full and by random access.
+#include "AudioArchive.h"
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+int main() {
+    // A bit more than three 4096-sample blocks of speech-like audio with full-scale peaks and digital silence.
+    std::vector<int16_t> ref(3 * 4096 + 1000);
+    uint32_t rng = 12345;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        double v = 12000 * std::sin(i * 0.031) + 3000 * std::sin(i * 0.47) + (int)(rng >> 22) - 512;
+        ref[i] = i % 4096 < 200 ? 0 : (int16_t)std::max(-32767.0, std::min(32767.0, v));
+    }
+    ref[5000] = 32767; ref[5001] = -32767;
+    // The writer scales by 32767 and the reader by 32768: feed exact values and expect v / 32768 back.
+    std::vector<float> in(ref.size());
+    for (size_t i = 0; i < ref.size(); ++i) in[i] = ref[i] / 32767.0f;
+
+    int failed = 0;
+    for (ArchiveCodec codec : {ArchiveCodec::PCM16, ArchiveCodec::LPC}) {
+        const char* name = codec == ArchiveCodec::LPC ? "lpc" : "pcm16";
+        fs::path path = fs::temp_directory_path() / ("audio_archive_test_" + std::to_string(getpid()) + "_" + name + ".maa");
+        AudioArchiveWriter w;
+        if (!w.open(path.string(), codec)) { std::cerr << name << ": cannot open " << path << "\n"; return 1; }
+        for (size_t pos = 0; pos < in.size(); pos += 333) w.push(in.data() + pos, std::min<size_t>(333, in.size() - pos));
+        w.close();
+        auto st = w.stats();
+
+        AudioArchiveReader r; std::vector<float> all, part;
+        bool ok = r.open(path.string()) && r.readAll(all) && r.read(4000, 300, part); // part crosses a block boundary
+        fs::remove(path);
+        if (!ok || st.dropped || r.totalSamples() != ref.size() || all.size() != ref.size() || part.size() != 300) {
+            std::cerr << name << ": ok=" << ok << " dropped=" << st.dropped << " total=" << r.totalSamples() << " all=" << all.size() << " part=" << part.size() << "\n";
+            failed++; continue;
+        }
+        for (size_t i = 0; i < ref.size(); ++i)
+            if (all[i] != ref[i] / 32768.0f) { std::cerr << name << ": sample " << i << " is " << all[i] * 32768.0f << ", want " << ref[i] << "\n"; failed++; break; }
+        for (size_t i = 0; i < part.size(); ++i)
+            if (part[i] != all[4000 + i]) { std::cerr << name << ": read() differs at " << 4000 + i << "\n"; failed++; break; }
+        if (codec == ArchiveCodec::LPC && st.bytes >= ref.size() * 2) { std::cerr << "lpc: " << st.bytes << " bytes, no smaller than PCM\n"; failed++; }
+    }
+    if (failed) return 1;
+    std::cout << "audio_archive_test: ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,29 @@
+// WER/CER as the regression harness computes them: one substitution, one insertion and one deletion.
+#include "Bench.h"
+#include <iostream>
+
+int main() {
+    int failed = 0;
+    auto expect = [&](const char* what, size_t got, size_t want) {
+        if (got != want) { std::cerr << what << ": got " << got << ", want " << want << "\n"; failed++; }
+    };
+    auto words = normalize_words("Hello, [BLANK_AUDIO] world! (laughs) It's 'fine'.");
+    if (words != std::vector<std::string>{"hello", "world", "it's", "fine"}) {
+        std::cerr << "normalize_words:"; for (const auto& w : words) std::cerr << " '" << w << "'"; std::cerr << "\n"; failed++;
+    }
+    auto ref = normalize_words("the quick brown fox jumps over the dog");
+    expect("identical", word_errors(ref, ref), 0);
+    expect("substitution", word_errors(ref, normalize_words("the quick red fox jumps over the dog")), 1);
+    expect("insertion", word_errors(ref, normalize_words("the quick brown fox jumps right over the dog")), 1);
+    expect("deletion", word_errors(ref, normalize_words("the quick fox jumps over the dog")), 1);
+    expect("all three", word_errors(ref, normalize_words("a quick fox jumps over the lazy dog")), 3);
+    expect("empty hypothesis", word_errors(ref, {}), ref.size());
+    // Code points, not bytes: é and € are one character each.
+    expect("cer substitution", char_errors("caf\xC3\xA9", "cafe"), 1);
+    expect("cer insertion", char_errors("5", "5\xE2\x82\xAC"), 1);
+    expect("cer deletion", char_errors("na\xC3\xAFve", "nave"), 1);
+    expect("code points", code_point_count("caf\xC3\xA9 \xE2\x82\xAC"), 6);
+    if (failed) return 1;
+    std::cout << "bench_metrics_test: ok" << std::endl;
+    return 0;
+}
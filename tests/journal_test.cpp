@@ -0,0 +1,32 @@
+// A segment ending inside a UTF-8 sequence must neither throw in append() nor be lost on --resume.
+#include "Journal.h"
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+int main() {
+    fs::path path = fs::temp_directory_path() / ("journal_test_" + std::to_string(getpid()) + ".ndjson");
+    {
+        TranscriptJournal journal;
+        if (!journal.open(path.string(), "utf8_test", 10)) { std::cerr << "cannot open " << path << "\n"; return 1; }
+        journal.append("[00:00:01]", "caf\xC3", 1000, 2000, 0);   // truncated two-byte sequence (é)
+        journal.append("[00:00:02]", "\xE2\x82 ok", 2000, 3000, 1); // truncated three-byte sequence (€)
+        journal.close(false);
+    }
+    TranscriptJournal::Session s;
+    bool ok = TranscriptJournal::load(path.string(), s);
+    fs::remove(path);
+    if (!ok || s.segments != 2 || s.completed || s.last_ms != 3000) {
+        std::cerr << "reload failed: ok=" << ok << " segments=" << s.segments << " last_ms=" << s.last_ms << "\n";
+        return 1;
+    }
+    std::string text = s.transcript->render();
+    if (text.find("caf\xEF\xBF\xBD") == std::string::npos || text.find(" ok") == std::string::npos) {
+        std::cerr << "unexpected text: " << text << "\n";
+        return 1;
+    }
+    std::cout << "journal_test: ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Search index: meetings added as separate segment files and after compaction return the same hits,
+// with millisecond times and 0-based speakers as stored.
+#include "SearchIndex.h"
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / ("search_index_test_" + std::to_string(getpid()));
+    SearchIndex index(dir.string());
+    int failed = 0;
+    auto check = [&](const char* what, bool ok) { if (!ok) { std::cerr << what << "\n"; failed++; } };
+    auto query = [](const char* text) { SearchIndex::Query q; q.text = text; return q; };
+
+    check("add weekly", index.addMeeting("Weekly Sync", "/notes/weekly.md", 1700000000, {
+        {1234, 0, "We need to review the budget for Q3."},
+        {5678, 1, "The postgres migration is scheduled."},
+        {9012, 0, "Budget approval by Friday, budget owners please."}}));
+    check("add retro", index.addMeeting("Retro", "/notes/retro.md", 1710000000, {
+        {250, 1, "Nothing about money here."},
+        {61005, 1, "The budget slipped."}}));
+    check("no empty meetings", !index.addMeeting("Empty", "/notes/empty.md", 1710000000, {}));
+
+    auto verify = [&](const char* stage) {
+        auto hits = index.search(query("budget"));
+        if (hits.size() != 3) { std::cerr << stage << ": " << hits.size() << " hits for 'budget'\n"; failed++; return; }
+        // Term frequency 2 in a short segment ranks first.
+        check("top hit", hits[0].meeting == "Weekly Sync" && hits[0].t_ms == 9012 && hits[0].speaker == 0 && hits[0].path == "/notes/weekly.md");
+        bool retro = false;
+        for (const auto& h : hits) retro |= h.meeting == "Retro" && h.t_ms == 61005 && h.speaker == 1 && h.date_unix == 1710000000;
+        check("retro hit", retro);
+        auto q = query("budget"); q.speaker = 1;
+        auto bySpeaker = index.search(q);
+        check("speaker filter", bySpeaker.size() == 1 && bySpeaker[0].meeting == "Retro");
+        q = query("budget"); q.meeting = "weekly";
+        check("meeting filter", index.search(q).size() == 2);
+        q = query("budget"); q.since_unix = 1705000000;
+        check("since filter", index.search(q).size() == 1);
+        auto pg = index.search(query("Postgres"));
+        check("case-insensitive", pg.size() == 1 && pg[0].t_ms == 5678 && pg[0].speaker == 1);
+        check("no match", index.search(query("kubernetes")).empty());
+    };
+    verify("segments");
+    size_t files = 0;
+    for (const auto& e : fs::directory_iterator(dir)) files += e.path().extension() == ".idx";
+    check("one file per meeting", files == 2);
+
+    check("compact", index.compact());
+    files = 0;
+    for (const auto& e : fs::directory_iterator(dir)) files += e.path().extension() == ".idx";
+    check("one file after compaction", files == 1);
+    verify("compacted");
+
+    // A truncated segment file is skipped rather than read past its end.
+    for (const auto& e : fs::directory_iterator(dir)) if (e.path().extension() == ".idx") fs::resize_file(e.path(), 64);
+    check("truncated file ignored", index.search(query("budget")).empty());
+
+    fs::remove_all(dir);
+    if (failed) return 1;
+    std::cout << "search_index_test: ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Silence elision: the dropped gap disappears from the speech buffer and segment times map back exactly.
+#include "SpeechMap.h"
+#include "AudioSource.h"
+#include <cmath>
+#include <iostream>
+
+int main() {
+    // 2 s tone, 4 s digital silence, 2 s tone. 20 ms frames with 300 ms padding keep frames [0, 115) and
+    // [285, 400): 2.3 s from the start, then 2.3 s from 5.7 s.
+    std::vector<float> pcm(8 * SAMPLE_RATE, 0.0f);
+    for (size_t i = 0; i < pcm.size(); ++i)
+        if (i < 2 * SAMPLE_RATE || i >= 6 * SAMPLE_RATE) pcm[i] = 0.3f * std::sin(i * 0.05f);
+    std::vector<float> speech;
+    SpeechMap map = SpeechMap::build(pcm, speech, SpeechMap::Options());
+
+    int failed = 0;
+    auto expect = [&](const char* what, int64_t got, int64_t want) {
+        if (got != want) { std::cerr << what << ": got " << got << ", want " << want << "\n"; failed++; }
+    };
+    const auto& t = map.table();
+    expect("spans", t.size(), 2);
+    if (t.size() != 2) return 1;
+    expect("span 0 src", t[0].src, 0);          expect("span 0 len", t[0].len, 36800);
+    expect("span 1 src", t[1].src, 91200);      expect("span 1 dst", t[1].dst, 36800); expect("span 1 len", t[1].len, 36800);
+    expect("speech samples", speech.size(), 73600);
+    expect("kept", map.keptSamples(), 73600);
+    for (size_t i = 0; i < speech.size(); i += 997) {
+        size_t src = i < 36800 ? i : 91200 + (i - 36800);
+        if (speech[i] != pcm[src]) { std::cerr << "speech[" << i << "] is not pcm[" << src << "]\n"; failed++; break; }
+    }
+
+    // Times in 10 ms ticks: the join is at tick 230 of the speech buffer, tick 570 of the recording.
+    expect("inside span 0", map.toSource(100), 100);
+    expect("start at the join", map.toSource(230), 570);
+    expect("end at the join", map.toSource(230, true), 230);
+    expect("inside span 1", map.toSource(240), 580);
+    expect("past the end", map.toSource(10000, true), 800);
+    TranscriptionSegment seg{200, 300, "across the gap"};
+    map.remap(seg);
+    expect("segment t0", seg.t0, 200); expect("segment t1", seg.t1, 640);
+
+    if (failed) return 1;
+    std::cout << "speech_map_test: ok" << std::endl;
+    return 0;
+}